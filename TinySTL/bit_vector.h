@@ -0,0 +1,489 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "allocator.h"
+
+namespace tiny_stl {
+
+namespace impl {
+
+using bit_word = uint64_t;
+constexpr size_t bit_word_bits = sizeof(bit_word) * 8;
+
+inline size_t bit_words_for(size_t bits) { return (bits + bit_word_bits - 1) / bit_word_bits; }
+
+// NOTE: 一次处理两个word（128bit），剩下的一个word走标量
+inline void fill_words(bit_word* dst, size_t n, bit_word value) {
+  size_t i = 0;
+#ifdef __SSE2__
+  __m128i v = _mm_set1_epi64x(static_cast<long long>(value));
+  for (; i + 2 <= n; i += 2)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+#endif
+  for (; i < n; ++i)
+    dst[i] = value;
+}
+
+inline void and_words(bit_word* dst, const bit_word* src, size_t n) {
+  size_t i = 0;
+#ifdef __SSE2__
+  for (; i + 2 <= n; i += 2) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_and_si128(a, b));
+  }
+#endif
+  for (; i < n; ++i)
+    dst[i] &= src[i];
+}
+
+inline void or_words(bit_word* dst, const bit_word* src, size_t n) {
+  size_t i = 0;
+#ifdef __SSE2__
+  for (; i + 2 <= n; i += 2) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(a, b));
+  }
+#endif
+  for (; i < n; ++i)
+    dst[i] |= src[i];
+}
+
+inline void xor_words(bit_word* dst, const bit_word* src, size_t n) {
+  size_t i = 0;
+#ifdef __SSE2__
+  for (; i + 2 <= n; i += 2) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(a, b));
+  }
+#endif
+  for (; i < n; ++i)
+    dst[i] ^= src[i];
+}
+
+}  // namespace impl
+
+// vector<bool>的代理引用，指向某个word中的某一位
+class bit_reference {
+ public:
+  using word_type = impl::bit_word;
+
+  bit_reference(word_type* word, word_type mask) : word_(word), mask_(mask) {}
+
+  operator bool() const { return (*word_ & mask_) != 0; }
+
+  bit_reference& operator=(bool value) {
+    if (value)
+      *word_ |= mask_;
+    else
+      *word_ &= ~mask_;
+    return *this;
+  }
+
+  // NOTE: 必须自定义，否则默认的拷贝赋值会改变引用的位置而不是赋值
+  bit_reference& operator=(const bit_reference& other) { return *this = bool(other); }
+
+  bool operator~() const { return !bool(*this); }
+
+  void flip() { *word_ ^= mask_; }
+
+ private:
+  word_type* word_;
+  word_type mask_;
+};
+
+template <bool IsConst>
+struct bit_iterator_base {
+  using word_type = impl::bit_word;
+  using word_ptr = typename std::conditional<IsConst, const word_type*, word_type*>::type;
+
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = bool;
+  using difference_type = std::ptrdiff_t;
+  using reference = typename std::conditional<IsConst, bool, bit_reference>::type;
+  using pointer = void;
+
+  using self = bit_iterator_base<IsConst>;
+
+  word_ptr word_;
+  unsigned offset_;
+
+  bit_iterator_base() : word_(nullptr), offset_(0) {}
+  bit_iterator_base(word_ptr word, unsigned offset) : word_(word), offset_(offset) {}
+
+  // 非const迭代器可以隐式转换为const迭代器
+  template <bool C = IsConst, typename = typename std::enable_if<C>::type>
+  bit_iterator_base(const bit_iterator_base<false>& other)
+      : word_(other.word_), offset_(other.offset_) {}
+
+  reference operator*() const {
+    if constexpr (IsConst)
+      return (*word_ >> offset_) & 1;
+    else
+      return bit_reference(word_, word_type(1) << offset_);
+  }
+
+  reference operator[](difference_type n) const { return *(*this + n); }
+
+  self& operator++() {
+    if (++offset_ == impl::bit_word_bits) {
+      offset_ = 0;
+      ++word_;
+    }
+    return *this;
+  }
+
+  self operator++(int) {
+    self tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  self& operator--() {
+    if (offset_-- == 0) {
+      offset_ = impl::bit_word_bits - 1;
+      --word_;
+    }
+    return *this;
+  }
+
+  self operator--(int) {
+    self tmp = *this;
+    --(*this);
+    return tmp;
+  }
+
+  self& operator+=(difference_type n) {
+    difference_type pos = static_cast<difference_type>(offset_) + n;
+    difference_type words = pos / difference_type(impl::bit_word_bits);
+    pos %= difference_type(impl::bit_word_bits);
+    if (pos < 0) {
+      pos += impl::bit_word_bits;
+      --words;
+    }
+    word_ += words;
+    offset_ = static_cast<unsigned>(pos);
+    return *this;
+  }
+
+  self& operator-=(difference_type n) { return *this += -n; }
+
+  self operator+(difference_type n) const {
+    self tmp = *this;
+    return tmp += n;
+  }
+
+  self operator-(difference_type n) const {
+    self tmp = *this;
+    return tmp -= n;
+  }
+
+  difference_type operator-(const self& other) const {
+    return (word_ - other.word_) * difference_type(impl::bit_word_bits) +
+           difference_type(offset_) - difference_type(other.offset_);
+  }
+
+  bool operator==(const self& other) const { return word_ == other.word_ && offset_ == other.offset_; }
+  bool operator!=(const self& other) const { return !(*this == other); }
+  bool operator<(const self& other) const { return *this - other < 0; }
+  bool operator>(const self& other) const { return other < *this; }
+  bool operator<=(const self& other) const { return !(other < *this); }
+  bool operator>=(const self& other) const { return !(*this < other); }
+};
+
+using bit_iterator = bit_iterator_base<false>;
+using bit_const_iterator = bit_iterator_base<true>;
+
+// 按位存储的bool数组，每个元素只占1bit
+// NOTE: 不变量：最后一个word中超出size_的位始终为0，这样count/find/比较都可以直接按word处理
+template <typename Alloc = allocator<impl::bit_word>>
+class bit_vector {
+ public:
+  using word_type = impl::bit_word;
+  using value_type = bool;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using reference = bit_reference;
+  using const_reference = bool;
+  using iterator = bit_iterator;
+  using const_iterator = bit_const_iterator;
+  using allocator_type = Alloc;
+
+  static constexpr size_type npos = size_type(-1);
+
+ private:
+  static constexpr size_type word_bits = impl::bit_word_bits;
+
+  word_type* data_ = nullptr;
+  size_type size_ = 0;      // 位数
+  size_type capacity_ = 0;  // word数
+  Alloc allocator_;
+
+ public:
+  bit_vector() = default;
+
+  explicit bit_vector(size_type size, bool value = false) {
+    resize(size, value);
+  }
+
+  bit_vector(std::initializer_list<bool> init) {
+    reserve(init.size());
+    for (bool value : init)
+      push_back(value);
+  }
+
+  bit_vector(const bit_vector& other) : allocator_(other.allocator_) {
+    reserve(other.size_);
+    if (other.size_)
+      std::memcpy(data_, other.data_, impl::bit_words_for(other.size_) * sizeof(word_type));
+    size_ = other.size_;
+  }
+
+  bit_vector(bit_vector&& other) noexcept
+      : data_(other.data_), size_(other.size_), capacity_(other.capacity_),
+        allocator_(other.allocator_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.capacity_ = 0;
+  }
+
+  ~bit_vector() {
+    if (data_)
+      allocator_.deallocate(data_, capacity_);
+  }
+
+  bit_vector& operator=(const bit_vector& other) {
+    if (this != &other) {
+      bit_vector tmp(other);
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  bit_vector& operator=(bit_vector&& other) noexcept {
+    if (this != &other) {
+      bit_vector tmp(std::move(other));
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  void swap(bit_vector& other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(allocator_, other.allocator_);
+  }
+
+  iterator begin() { return iterator(data_, 0); }
+  iterator end() { return begin() + size_; }
+  const_iterator begin() const { return const_iterator(data_, 0); }
+  const_iterator end() const { return begin() + size_; }
+
+  size_type size() const { return size_; }
+  size_type capacity() const { return capacity_ * word_bits; }
+  bool empty() const { return size_ == 0; }
+
+  const word_type* data() const { return data_; }
+  size_type word_count() const { return impl::bit_words_for(size_); }
+
+  reference operator[](size_type index) {
+    assert(index < size_);
+    return reference(data_ + index / word_bits, word_type(1) << (index % word_bits));
+  }
+
+  const_reference operator[](size_type index) const { return test(index); }
+
+  bool test(size_type index) const {
+    assert(index < size_);
+    return (data_[index / word_bits] >> (index % word_bits)) & 1;
+  }
+
+  reference front() { return (*this)[0]; }
+  const_reference front() const { return test(0); }
+  reference back() { return (*this)[size_ - 1]; }
+  const_reference back() const { return test(size_ - 1); }
+
+  void set(size_type index, bool value = true) { (*this)[index] = value; }
+  void reset(size_type index) { (*this)[index] = false; }
+  void flip(size_type index) { (*this)[index].flip(); }
+
+  void flip() {
+    for (size_type i = 0; i < word_count(); ++i)
+      data_[i] = ~data_[i];
+    clear_unused_bits();
+  }
+
+  void reserve(size_type bits) {
+    size_type words = impl::bit_words_for(bits);
+    if (words > capacity_)
+      reallocate(words);
+  }
+
+  void resize(size_type new_size, bool value = false) {
+    if (new_size > size_) {
+      reserve(new_size);
+      // NOTE: 先把新增的部分清零（可能跨过之前未分配的word），再按value填充
+      size_type old_words = word_count();
+      size_type new_words = impl::bit_words_for(new_size);
+      impl::fill_words(data_ + old_words, new_words - old_words, 0);
+      size_type old_size = size_;
+      size_ = new_size;
+      if (value)
+        set_range(old_size, new_size, true);
+    } else {
+      size_ = new_size;
+      clear_unused_bits();
+    }
+  }
+
+  void clear() { size_ = 0; }
+
+  void push_back(bool value) {
+    if (size_ == capacity())
+      reallocate(capacity_ ? capacity_ * 2 : 1);
+    if (size_ % word_bits == 0)
+      data_[size_ / word_bits] = 0;
+    ++size_;
+    set(size_ - 1, value);
+  }
+
+  void pop_back() {
+    assert(size_ > 0);
+    reset(size_ - 1);
+    --size_;
+  }
+
+  // 将[first, last)区间内的位全部置为value，首尾不完整的word用掩码处理，中间整块填充
+  void set_range(size_type first, size_type last, bool value = true) {
+    assert(first <= last && last <= size_);
+    if (first == last)
+      return;
+    size_type first_word = first / word_bits;
+    size_type last_word = (last - 1) / word_bits;
+    word_type head_mask = ~word_type(0) << (first % word_bits);
+    word_type tail_mask = ~word_type(0) >> (word_bits - 1 - (last - 1) % word_bits);
+    if (first_word == last_word) {
+      apply_mask(first_word, head_mask & tail_mask, value);
+      return;
+    }
+    apply_mask(first_word, head_mask, value);
+    impl::fill_words(data_ + first_word + 1, last_word - first_word - 1,
+                     value ? ~word_type(0) : word_type(0));
+    apply_mask(last_word, tail_mask, value);
+  }
+
+  void reset_range(size_type first, size_type last) { set_range(first, last, false); }
+
+  size_type count() const {
+    size_type res = 0;
+    for (size_type i = 0; i < word_count(); ++i)
+      res += __builtin_popcountll(data_[i]);
+    return res;
+  }
+
+  bool any() const { return find_first() != npos; }
+  bool none() const { return !any(); }
+  bool all() const { return count() == size_; }
+
+  size_type find_first() const { return find_from(0); }
+
+  // 返回pos之后（不含pos）第一个为1的位，不存在则返回npos
+  size_type find_next(size_type pos) const {
+    if (pos == npos || pos + 1 >= size_)
+      return npos;
+    return find_from(pos + 1);
+  }
+
+  bit_vector& operator&=(const bit_vector& other) {
+    assert(size_ == other.size_);
+    impl::and_words(data_, other.data_, word_count());
+    return *this;
+  }
+
+  bit_vector& operator|=(const bit_vector& other) {
+    assert(size_ == other.size_);
+    impl::or_words(data_, other.data_, word_count());
+    return *this;
+  }
+
+  bit_vector& operator^=(const bit_vector& other) {
+    assert(size_ == other.size_);
+    impl::xor_words(data_, other.data_, word_count());
+    return *this;
+  }
+
+  bool operator==(const bit_vector& other) const {
+    return size_ == other.size_ &&
+           (size_ == 0 || std::memcmp(data_, other.data_, word_count() * sizeof(word_type)) == 0);
+  }
+
+  bool operator!=(const bit_vector& other) const { return !(*this == other); }
+
+ private:
+  void reallocate(size_type new_capacity) {
+    word_type* new_data = allocator_.allocate(new_capacity);
+    if (data_) {
+      std::memcpy(new_data, data_, word_count() * sizeof(word_type));
+      allocator_.deallocate(data_, capacity_);
+    }
+    data_ = new_data;
+    capacity_ = new_capacity;
+  }
+
+  void apply_mask(size_type word, word_type mask, bool value) {
+    if (value)
+      data_[word] |= mask;
+    else
+      data_[word] &= ~mask;
+  }
+
+  void clear_unused_bits() {
+    if (size_ % word_bits)
+      data_[size_ / word_bits] &= ~word_type(0) >> (word_bits - size_ % word_bits);
+  }
+
+  size_type find_from(size_type pos) const {
+    if (pos >= size_)
+      return npos;
+    size_type word = pos / word_bits;
+    word_type bits = data_[word] & (~word_type(0) << (pos % word_bits));
+    size_type words = word_count();
+    while (true) {
+      if (bits)
+        return word * word_bits + __builtin_ctzll(bits);
+      if (++word == words)
+        return npos;
+      bits = data_[word];
+    }
+  }
+};
+
+template <typename Alloc>
+bit_vector<Alloc> operator&(bit_vector<Alloc> lhs, const bit_vector<Alloc>& rhs) {
+  return lhs &= rhs;
+}
+
+template <typename Alloc>
+bit_vector<Alloc> operator|(bit_vector<Alloc> lhs, const bit_vector<Alloc>& rhs) {
+  return lhs |= rhs;
+}
+
+template <typename Alloc>
+bit_vector<Alloc> operator^(bit_vector<Alloc> lhs, const bit_vector<Alloc>& rhs) {
+  return lhs ^= rhs;
+}
+
+}  // namespace tiny_stl
@@ -0,0 +1,679 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace tiny_stl {
+
+namespace impl {
+
+// 结点的key数组正好占4条cache line，key很大时至少保留8个槽
+template <typename Key>
+constexpr size_t btree_slots() {
+  return sizeof(Key) * 8 > 4 * 64 ? 8 : 4 * 64 / sizeof(Key);
+}
+
+template <typename Key, size_t N>
+struct btree_node_base {
+  alignas(64) unsigned char key_storage[N * sizeof(Key)];  // NOTE: 只有前count个key被构造
+  uint16_t count;
+  bool leaf;
+
+  Key* keys() { return reinterpret_cast<Key*>(key_storage); }
+};
+
+// 叶子之间双向链接，区间遍历不需要回到内部结点
+template <typename Key, typename Value, size_t N>
+struct btree_leaf : btree_node_base<Key, N> {
+  typename std::aligned_storage<sizeof(Value), alignof(Value)>::type value_storage[N];
+  btree_leaf* prev;
+  btree_leaf* next;
+
+  Value* values() { return reinterpret_cast<Value*>(value_storage); }
+};
+
+// children[i]中的key都小于keys[i]，children[i + 1]中的key都不小于keys[i]
+template <typename Key, size_t N>
+struct btree_inner : btree_node_base<Key, N> {
+  btree_node_base<Key, N>* children[N + 1];
+};
+
+// 结点内的lower_bound：无分支二分，循环体编译成cmov
+template <typename Key, typename Compare>
+struct btree_search {
+  static size_t lower_bound(const Key* keys, size_t n, const Key& key, const Compare& comp) {
+    if (n == 0)
+      return 0;
+    const Key* base = keys;
+    while (n > 1) {
+      size_t half = n / 2;
+      base = comp(base[half], key) ? base + half : base;
+      n -= half;
+    }
+    return (base - keys) + comp(*base, key);
+  }
+};
+
+#ifdef __SSE2__
+// int key：key有序，所以lower_bound就是小于key的个数，每次比较4个
+template <>
+struct btree_search<int, std::less<int>> {
+  static size_t lower_bound(const int* keys, size_t n, const int& key, const std::less<int>&) {
+    __m128i k = _mm_set1_epi32(key);
+    size_t i = 0;
+    size_t result = 0;
+    for (; i + 4 <= n; i += 4) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+      int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(v, k)));
+      result += __builtin_popcount(mask);
+      if (mask != 0xF)
+        return result;
+    }
+    for (; i < n && keys[i] < key; ++i)
+      ++result;
+    return result;
+  }
+};
+#endif
+
+// 把[src, src + n)搬到dst，源对象析构；区间可以重叠
+template <typename T>
+void btree_relocate(T* dst, T* src, size_t n) {
+  if (dst < src) {
+    for (size_t i = 0; i < n; ++i) {
+      ::new (static_cast<void*>(dst + i)) T(std::move(src[i]));
+      src[i].~T();
+    }
+  } else if (dst > src) {
+    for (size_t i = n; i > 0; --i) {
+      ::new (static_cast<void*>(dst + i - 1)) T(std::move(src[i - 1]));
+      src[i - 1].~T();
+    }
+  }
+}
+
+}  // namespace impl
+
+template <typename Key, typename Value, size_t N, bool IsConst>
+struct btree_iterator {
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = Value;
+  using reference = typename std::conditional<IsConst, const Value&, Value&>::type;
+  using pointer = typename std::conditional<IsConst, const Value*, Value*>::type;
+  using difference_type = std::ptrdiff_t;
+
+  using self = btree_iterator<Key, Value, N, IsConst>;
+  using leaf_ptr = impl::btree_leaf<Key, Value, N>*;
+
+  leaf_ptr leaf_;
+  size_t index_;
+
+  btree_iterator(leaf_ptr leaf, size_t index) : leaf_(leaf), index_(index) {}
+  template <bool C = IsConst, typename = typename std::enable_if<C>::type>
+  btree_iterator(const btree_iterator<Key, Value, N, false>& other)
+      : leaf_(other.leaf_), index_(other.index_) {}
+
+  reference operator*() const { return leaf_->values()[index_]; }
+  pointer operator->() const { return &(operator*()); }
+
+  self& operator++() {
+    if (++index_ == leaf_->count) {
+      leaf_ = leaf_->next;
+      index_ = 0;
+    }
+    return *this;
+  }
+
+  self operator++(int) {
+    self tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  // NOTE: iterator和const_iterator可以互相比较，比如b.find(k) == cb.end()
+  template <bool C>
+  bool operator==(const btree_iterator<Key, Value, N, C>& other) const {
+    return leaf_ == other.leaf_ && index_ == other.index_;
+  }
+  template <bool C>
+  bool operator!=(const btree_iterator<Key, Value, N, C>& other) const { return !(*this == other); }
+};
+
+// B+树，接口和unordered_map一致，额外提供有序遍历和区间查找
+// 元素只存放在叶子里，内部结点只有分隔key和孩子指针；插入时自顶向下分裂满结点，
+// 删除时自顶向下保证经过的结点多于最少元素数，所以两者都只需要一次下降。
+// NOTE: 叶子里的key数组是查找用的副本，元素的key是const的，不能通过迭代器改，否则两者会不一致
+template <typename Key, typename T, typename Compare = std::less<Key>,
+          typename Alloc = std::allocator<std::pair<const Key, T>>>
+class btree_map {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using key_compare = Compare;
+  using allocator_type = Alloc;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+
+  static constexpr size_type node_slots = impl::btree_slots<Key>();
+
+  using iterator = btree_iterator<Key, value_type, node_slots, false>;
+  using const_iterator = btree_iterator<Key, value_type, node_slots, true>;
+
+ private:
+  using base_node = impl::btree_node_base<Key, node_slots>;
+  using leaf_node = impl::btree_leaf<Key, value_type, node_slots>;
+  using inner_node = impl::btree_inner<Key, node_slots>;
+  using leaf_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<leaf_node>;
+  using inner_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<inner_node>;
+  using search = impl::btree_search<Key, Compare>;
+
+  // 除根以外每个结点至少有min_count个key，两个最小结点（加上分隔key）合并后不会超过node_slots
+  static constexpr size_type min_count = (node_slots - 1) / 2;
+
+  base_node* root_;
+  leaf_node* first_leaf_;
+  size_type size_;
+  Compare comp_;
+  leaf_alloc_type leaf_alloc_;
+  inner_alloc_type inner_alloc_;
+
+ public:
+  explicit btree_map(const Compare& comp = Compare(), const Alloc& alloc = Alloc())
+      : size_(0), comp_(comp), leaf_alloc_(alloc), inner_alloc_(alloc) {
+    first_leaf_ = create_leaf();
+    root_ = first_leaf_;
+  }
+
+  btree_map(std::initializer_list<value_type> values) : btree_map() {
+    for (const auto& value : values)
+      emplace(value);
+  }
+
+  btree_map(const btree_map& other)
+      : btree_map(other.comp_, Alloc(other.leaf_alloc_)) {
+    bulk_load(other.begin(), other.end());
+  }
+
+  btree_map(btree_map&& other) : btree_map(other.comp_, Alloc(other.leaf_alloc_)) { swap(other); }
+
+  btree_map& operator=(const btree_map& other) {
+    if (this != &other) {
+      clear();
+      bulk_load(other.begin(), other.end());
+    }
+    return *this;
+  }
+
+  btree_map& operator=(btree_map&& other) {
+    if (this != &other) {
+      swap(other);
+      other.clear();
+    }
+    return *this;
+  }
+
+  ~btree_map() {
+    destroy_subtree(root_);
+  }
+
+  iterator begin() { return size_ ? iterator(first_leaf_, 0) : end(); }
+  iterator end() { return iterator(nullptr, 0); }
+  const_iterator begin() const { return size_ ? const_iterator(first_leaf_, 0) : end(); }
+  const_iterator end() const { return const_iterator(nullptr, 0); }
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+
+  void clear() {
+    destroy_subtree(root_);
+    size_ = 0;
+    first_leaf_ = create_leaf();
+    root_ = first_leaf_;
+  }
+
+  void swap(btree_map& other) {
+    std::swap(root_, other.root_);
+    std::swap(first_leaf_, other.first_leaf_);
+    std::swap(size_, other.size_);
+    std::swap(comp_, other.comp_);
+    std::swap(leaf_alloc_, other.leaf_alloc_);
+    std::swap(inner_alloc_, other.inner_alloc_);
+  }
+
+  mapped_type& operator[](const key_type& key) { return try_emplace(key).first->second; }
+  mapped_type& operator[](key_type&& key) { return try_emplace(std::move(key)).first->second; }
+
+  mapped_type& at(const key_type& key) {
+    iterator it = find(key);
+    if (it == end())
+      throw std::out_of_range("btree_map::at");
+    return it->second;
+  }
+
+  const mapped_type& at(const key_type& key) const {
+    const_iterator it = find(key);
+    if (it == end())
+      throw std::out_of_range("btree_map::at");
+    return it->second;
+  }
+
+  iterator find(const key_type& key) {
+    leaf_node* leaf = find_leaf(key);
+    size_type pos = search::lower_bound(leaf->keys(), leaf->count, key, comp_);
+    if (pos < leaf->count && !comp_(key, leaf->keys()[pos]))
+      return iterator(leaf, pos);
+    return end();
+  }
+
+  const_iterator find(const key_type& key) const {
+    return const_cast<btree_map*>(this)->find(key);
+  }
+
+  size_type count(const key_type& key) const { return find(key) != end() ? 1 : 0; }
+  bool contains(const key_type& key) const { return find(key) != end(); }
+
+  // 第一个不小于key的元素
+  iterator lower_bound(const key_type& key) {
+    leaf_node* leaf = find_leaf(key);
+    return make_iterator(leaf, search::lower_bound(leaf->keys(), leaf->count, key, comp_));
+  }
+
+  const_iterator lower_bound(const key_type& key) const {
+    return const_cast<btree_map*>(this)->lower_bound(key);
+  }
+
+  // 第一个大于key的元素
+  iterator upper_bound(const key_type& key) {
+    iterator it = lower_bound(key);
+    if (it != end() && !comp_(key, it->first))
+      ++it;
+    return it;
+  }
+
+  const_iterator upper_bound(const key_type& key) const {
+    return const_cast<btree_map*>(this)->upper_bound(key);
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    value_type value(std::forward<Args>(args)...);
+    iterator it = find(value.first);
+    if (it != end())
+      return std::make_pair(it, false);
+    const key_type& key = value.first;
+    return std::make_pair(insert_unique(key, [&](pointer p) {
+      ::new (static_cast<void*>(p)) value_type(std::move(value));
+    }), true);
+  }
+
+  // key已存在时不构造value
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+    iterator it = find(key);
+    if (it != end())
+      return std::make_pair(it, false);
+    return std::make_pair(insert_unique(key, [&](pointer p) {
+      ::new (static_cast<void*>(p)) value_type(std::piecewise_construct,
+                                               std::forward_as_tuple(std::forward<K>(key)),
+                                               std::forward_as_tuple(std::forward<Args>(args)...));
+    }), true);
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) { return emplace(value); }
+  std::pair<iterator, bool> insert(value_type&& value) { return emplace(std::move(value)); }
+
+  void erase(iterator pos) {
+    if (pos == end())
+      return;
+    key_type key = pos->first;
+    erase(key);
+  }
+
+  size_type erase(const key_type& key) {
+    base_node* node = root_;
+    while (!node->leaf) {
+      inner_node* parent = static_cast<inner_node*>(node);
+      size_type idx = child_index(parent, key);
+      if (parent->children[idx]->count <= min_count)
+        idx = fix_child(parent, idx);
+      if (parent == root_ && parent->count == 0) {
+        // 根的两个孩子合并了，树的高度减一
+        root_ = parent->children[0];
+        inner_alloc_.deallocate(parent, 1);
+        node = root_;
+        continue;
+      }
+      node = parent->children[idx];
+    }
+    leaf_node* leaf = static_cast<leaf_node*>(node);
+    size_type pos = search::lower_bound(leaf->keys(), leaf->count, key, comp_);
+    if (pos == leaf->count || comp_(key, leaf->keys()[pos]))
+      return 0;
+    leaf->keys()[pos].~key_type();
+    leaf->values()[pos].~value_type();
+    impl::btree_relocate(leaf->keys() + pos, leaf->keys() + pos + 1, leaf->count - pos - 1);
+    impl::btree_relocate(leaf->values() + pos, leaf->values() + pos + 1, leaf->count - pos - 1);
+    --leaf->count;
+    --size_;
+    return 1;
+  }
+
+  // 从严格递增的有序区间批量构建：先把元素平均铺到叶子上，再自底向上逐层建内部结点
+  // NOTE: map非空时退化为逐个emplace
+  template <typename ForwardIt>
+  void bulk_load(ForwardIt first, ForwardIt last) {
+    if (!empty()) {
+      for (; first != last; ++first)
+        emplace(*first);
+      return;
+    }
+    size_type n = std::distance(first, last);
+    if (n == 0)
+      return;
+    leaf_alloc_.deallocate(first_leaf_, 1);
+
+    std::vector<base_node*> level;
+    std::vector<key_type> mins;  // 每个结点子树中的最小key，作为上一层的分隔key
+    size_type leaves = (n + node_slots - 1) / node_slots;
+    leaf_node* prev = nullptr;
+    for (size_type i = 0; i < leaves; ++i) {
+      leaf_node* leaf = create_leaf();
+      size_type fill = n / leaves + (i < n % leaves ? 1 : 0);
+      for (size_type j = 0; j < fill; ++j, ++first) {
+        assert(j == 0 || comp_(leaf->keys()[j - 1], first->first));
+        ::new (static_cast<void*>(leaf->keys() + j)) key_type(first->first);
+        ::new (static_cast<void*>(leaf->values() + j)) value_type(*first);
+        ++leaf->count;
+      }
+      leaf->prev = prev;
+      if (prev)
+        prev->next = leaf;
+      else
+        first_leaf_ = leaf;
+      prev = leaf;
+      level.push_back(leaf);
+      mins.push_back(leaf->keys()[0]);
+    }
+
+    while (level.size() > 1) {
+      size_type m = level.size();
+      size_type groups = (m + node_slots) / (node_slots + 1);
+      std::vector<base_node*> next_level;
+      std::vector<key_type> next_mins;
+      size_type child = 0;
+      for (size_type g = 0; g < groups; ++g) {
+        size_type fanout = m / groups + (g < m % groups ? 1 : 0);
+        inner_node* inner = create_inner();
+        inner->children[0] = level[child];
+        next_mins.push_back(std::move(mins[child]));
+        for (size_type j = 1; j < fanout; ++j) {
+          ::new (static_cast<void*>(inner->keys() + j - 1)) key_type(std::move(mins[child + j]));
+          inner->children[j] = level[child + j];
+        }
+        inner->count = static_cast<uint16_t>(fanout - 1);
+        child += fanout;
+        next_level.push_back(inner);
+      }
+      level.swap(next_level);
+      mins.swap(next_mins);
+    }
+    root_ = level[0];
+    size_ = n;
+  }
+
+ private:
+  leaf_node* create_leaf() {
+    leaf_node* leaf = leaf_alloc_.allocate(1);
+    ::new (static_cast<void*>(leaf)) leaf_node;
+    leaf->count = 0;
+    leaf->leaf = true;
+    leaf->prev = nullptr;
+    leaf->next = nullptr;
+    return leaf;
+  }
+
+  inner_node* create_inner() {
+    inner_node* inner = inner_alloc_.allocate(1);
+    ::new (static_cast<void*>(inner)) inner_node;
+    inner->count = 0;
+    inner->leaf = false;
+    return inner;
+  }
+
+  void destroy_subtree(base_node* node) {
+    for (size_type i = 0; i < node->count; ++i)
+      node->keys()[i].~key_type();
+    if (node->leaf) {
+      leaf_node* leaf = static_cast<leaf_node*>(node);
+      for (size_type i = 0; i < leaf->count; ++i)
+        leaf->values()[i].~value_type();
+      leaf_alloc_.deallocate(leaf, 1);
+    } else {
+      inner_node* inner = static_cast<inner_node*>(node);
+      for (size_type i = 0; i <= inner->count; ++i)
+        destroy_subtree(inner->children[i]);
+      inner_alloc_.deallocate(inner, 1);
+    }
+  }
+
+  iterator make_iterator(leaf_node* leaf, size_type pos) {
+    if (pos < leaf->count)
+      return iterator(leaf, pos);
+    return leaf->next ? iterator(leaf->next, 0) : end();
+  }
+
+  // 分隔key等于key时走右边
+  size_type child_index(inner_node* inner, const key_type& key) const {
+    size_type idx = search::lower_bound(inner->keys(), inner->count, key, comp_);
+    if (idx < inner->count && !comp_(key, inner->keys()[idx]))
+      ++idx;
+    return idx;
+  }
+
+  leaf_node* find_leaf(const key_type& key) const {
+    base_node* node = root_;
+    while (!node->leaf) {
+      inner_node* inner = static_cast<inner_node*>(node);
+      node = inner->children[child_index(inner, key)];
+    }
+    return static_cast<leaf_node*>(node);
+  }
+
+  // 调用者保证key不存在；construct在叶子的槽里构造value
+  template <typename Construct>
+  iterator insert_unique(const key_type& key, Construct construct) {
+    if (root_->count == node_slots) {
+      inner_node* new_root = create_inner();
+      new_root->children[0] = root_;
+      root_ = new_root;
+      split_child(new_root, 0);
+    }
+    base_node* node = root_;
+    while (!node->leaf) {
+      inner_node* inner = static_cast<inner_node*>(node);
+      size_type idx = child_index(inner, key);
+      if (inner->children[idx]->count == node_slots) {
+        split_child(inner, idx);
+        if (!comp_(key, inner->keys()[idx]))
+          ++idx;
+      }
+      node = inner->children[idx];
+    }
+    leaf_node* leaf = static_cast<leaf_node*>(node);
+    size_type pos = search::lower_bound(leaf->keys(), leaf->count, key, comp_);
+    impl::btree_relocate(leaf->keys() + pos + 1, leaf->keys() + pos, leaf->count - pos);
+    impl::btree_relocate(leaf->values() + pos + 1, leaf->values() + pos, leaf->count - pos);
+    construct(leaf->values() + pos);
+    ::new (static_cast<void*>(leaf->keys() + pos)) key_type(leaf->values()[pos].first);
+    ++leaf->count;
+    ++size_;
+    return iterator(leaf, pos);
+  }
+
+  // 在parent的idx处插入分隔key，右边的孩子为child
+  void insert_separator(inner_node* parent, size_type idx, key_type&& key, base_node* child) {
+    impl::btree_relocate(parent->keys() + idx + 1, parent->keys() + idx, parent->count - idx);
+    ::new (static_cast<void*>(parent->keys() + idx)) key_type(std::move(key));
+    std::memmove(parent->children + idx + 2, parent->children + idx + 1,
+                 (parent->count - idx) * sizeof(base_node*));
+    parent->children[idx + 1] = child;
+    ++parent->count;
+  }
+
+  // 删除parent的第idx个分隔key和它右边的孩子指针
+  void remove_separator(inner_node* parent, size_type idx) {
+    parent->keys()[idx].~key_type();
+    impl::btree_relocate(parent->keys() + idx, parent->keys() + idx + 1, parent->count - idx - 1);
+    std::memmove(parent->children + idx + 1, parent->children + idx + 2,
+                 (parent->count - idx - 1) * sizeof(base_node*));
+    --parent->count;
+  }
+
+  // 把parent的第idx个孩子（已满）分成两半
+  void split_child(inner_node* parent, size_type idx) {
+    base_node* child = parent->children[idx];
+    if (child->leaf) {
+      leaf_node* left = static_cast<leaf_node*>(child);
+      leaf_node* right = create_leaf();
+      size_type mid = left->count / 2;
+      size_type moved = left->count - mid;
+      impl::btree_relocate(right->keys(), left->keys() + mid, moved);
+      impl::btree_relocate(right->values(), left->values() + mid, moved);
+      right->count = static_cast<uint16_t>(moved);
+      left->count = static_cast<uint16_t>(mid);
+      right->next = left->next;
+      if (right->next)
+        right->next->prev = right;
+      right->prev = left;
+      left->next = right;
+      insert_separator(parent, idx, key_type(right->keys()[0]), right);
+    } else {
+      inner_node* left = static_cast<inner_node*>(child);
+      inner_node* right = create_inner();
+      size_type mid = left->count / 2;
+      size_type moved = left->count - mid - 1;
+      key_type separator(std::move(left->keys()[mid]));
+      left->keys()[mid].~key_type();
+      impl::btree_relocate(right->keys(), left->keys() + mid + 1, moved);
+      std::memcpy(right->children, left->children + mid + 1, (moved + 1) * sizeof(base_node*));
+      right->count = static_cast<uint16_t>(moved);
+      left->count = static_cast<uint16_t>(mid);
+      insert_separator(parent, idx, std::move(separator), right);
+    }
+  }
+
+  // parent的第idx个孩子只有min_count个key，从兄弟借一个或者和兄弟合并；返回合并后孩子的下标
+  size_type fix_child(inner_node* parent, size_type idx) {
+    if (idx > 0 && parent->children[idx - 1]->count > min_count) {
+      borrow_from_left(parent, idx);
+      return idx;
+    }
+    if (idx < parent->count && parent->children[idx + 1]->count > min_count) {
+      borrow_from_right(parent, idx);
+      return idx;
+    }
+    if (idx < parent->count) {
+      merge_children(parent, idx);
+      return idx;
+    }
+    merge_children(parent, idx - 1);
+    return idx - 1;
+  }
+
+  void borrow_from_left(inner_node* parent, size_type idx) {
+    base_node* child = parent->children[idx];
+    base_node* sibling = parent->children[idx - 1];
+    size_type last = sibling->count - 1;
+    impl::btree_relocate(child->keys() + 1, child->keys(), child->count);
+    if (child->leaf) {
+      leaf_node* c = static_cast<leaf_node*>(child);
+      leaf_node* s = static_cast<leaf_node*>(sibling);
+      impl::btree_relocate(c->values() + 1, c->values(), c->count);
+      impl::btree_relocate(c->keys(), s->keys() + last, 1);
+      impl::btree_relocate(c->values(), s->values() + last, 1);
+      parent->keys()[idx - 1] = c->keys()[0];
+    } else {
+      inner_node* c = static_cast<inner_node*>(child);
+      inner_node* s = static_cast<inner_node*>(sibling);
+      std::memmove(c->children + 1, c->children, (c->count + 1) * sizeof(base_node*));
+      c->children[0] = s->children[last + 1];
+      impl::btree_relocate(c->keys(), parent->keys() + idx - 1, 1);
+      impl::btree_relocate(parent->keys() + idx - 1, s->keys() + last, 1);
+    }
+    --sibling->count;
+    ++child->count;
+  }
+
+  void borrow_from_right(inner_node* parent, size_type idx) {
+    base_node* child = parent->children[idx];
+    base_node* sibling = parent->children[idx + 1];
+    size_type end = child->count;
+    if (child->leaf) {
+      leaf_node* c = static_cast<leaf_node*>(child);
+      leaf_node* s = static_cast<leaf_node*>(sibling);
+      impl::btree_relocate(c->keys() + end, s->keys(), 1);
+      impl::btree_relocate(c->values() + end, s->values(), 1);
+      impl::btree_relocate(s->keys(), s->keys() + 1, s->count - 1);
+      impl::btree_relocate(s->values(), s->values() + 1, s->count - 1);
+      parent->keys()[idx] = s->keys()[0];
+    } else {
+      inner_node* c = static_cast<inner_node*>(child);
+      inner_node* s = static_cast<inner_node*>(sibling);
+      impl::btree_relocate(c->keys() + end, parent->keys() + idx, 1);
+      c->children[end + 1] = s->children[0];
+      impl::btree_relocate(parent->keys() + idx, s->keys(), 1);
+      impl::btree_relocate(s->keys(), s->keys() + 1, s->count - 1);
+      std::memmove(s->children, s->children + 1, s->count * sizeof(base_node*));
+    }
+    --sibling->count;
+    ++child->count;
+  }
+
+  // 把parent的第idx + 1个孩子并入第idx个孩子
+  void merge_children(inner_node* parent, size_type idx) {
+    base_node* left = parent->children[idx];
+    base_node* right = parent->children[idx + 1];
+    if (left->leaf) {
+      leaf_node* l = static_cast<leaf_node*>(left);
+      leaf_node* r = static_cast<leaf_node*>(right);
+      impl::btree_relocate(l->keys() + l->count, r->keys(), r->count);
+      impl::btree_relocate(l->values() + l->count, r->values(), r->count);
+      l->count += r->count;
+      l->next = r->next;
+      if (l->next)
+        l->next->prev = l;
+      leaf_alloc_.deallocate(r, 1);
+    } else {
+      inner_node* l = static_cast<inner_node*>(left);
+      inner_node* r = static_cast<inner_node*>(right);
+      ::new (static_cast<void*>(l->keys() + l->count)) key_type(parent->keys()[idx]);
+      impl::btree_relocate(l->keys() + l->count + 1, r->keys(), r->count);
+      std::memcpy(l->children + l->count + 1, r->children, (r->count + 1) * sizeof(base_node*));
+      l->count += r->count + 1;
+      inner_alloc_.deallocate(r, 1);
+    }
+    remove_separator(parent, idx);
+  }
+};
+
+}  // namespace tiny_stl
@@ -0,0 +1,189 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+
+#include "unordered_map.h"
+
+namespace tiny_stl {
+
+// 分片加锁的并发哈希表
+// 由N个独立的_hashtable组成，每个分片有自己的读写锁，并且按cache line对齐，互不干扰；
+// 按hash的高位选分片，分片内部用低位选桶。扩容也是分片各自进行，只会阻塞同一分片上的操作。
+// NOTE: 不提供迭代器和返回引用的接口，元素只能在持有锁的回调（visit/update）里访问
+template <typename Key, typename Tp, typename Hash = std::hash<Key>,
+          typename Pred = std::equal_to<Key>,
+          typename Alloc = std::allocator<std::pair<const Key, Tp>>,
+          typename Policy = hashtable_fibonacci_policy>
+class concurrent_unordered_map {
+  using table_type = _hashtable<Key, std::pair<Key, Tp>, Hash, Pred, Alloc, Policy,
+                                hashtable_cache_hash<Key, Hash>::value>;
+
+  static constexpr size_t initial_buckets = 16;
+
+  struct alignas(64) shard {
+    mutable std::shared_mutex mutex;
+    table_type table;
+
+    shard() : table(initial_buckets) {}
+  };
+
+ public:
+  using key_type = typename table_type::key_type;
+  using value_type = typename table_type::value_type;
+  using mapped_type = typename table_type::mapped_type;
+  using hasher = typename table_type::hasher;
+  using key_equal = typename table_type::key_equal;
+  using allocator_type = typename table_type::allocator_type;
+  using size_type = typename table_type::size_type;
+
+ private:
+  std::unique_ptr<shard[]> shards_;
+  size_type shard_count_;  // 2的幂，至少为2
+  int shard_shift_;        // 64 - log2(shard_count_)
+  hasher hash_;
+
+ public:
+  // shard_count会向上取整成2的幂
+  explicit concurrent_unordered_map(size_type shard_count = default_shard_count(),
+                                    const hasher& hash = hasher(), const key_equal& equal = key_equal())
+      : shard_count_(2), shard_shift_(63), hash_(hash) {
+    while (shard_count_ < shard_count) {
+      shard_count_ *= 2;
+      --shard_shift_;
+    }
+    shards_.reset(new shard[shard_count_]);
+    for (size_type i = 0; i < shard_count_; ++i)
+      table_type(initial_buckets, hash, equal).swap(shards_[i].table);
+  }
+
+  concurrent_unordered_map(const concurrent_unordered_map&) = delete;
+  concurrent_unordered_map& operator=(const concurrent_unordered_map&) = delete;
+
+  // 硬件线程数的4倍，线程越多越不容易撞到同一个分片
+  static size_type default_shard_count() {
+    size_type threads = std::thread::hardware_concurrency();
+    return threads ? threads * 4 : 16;
+  }
+
+  size_type shard_count() const { return shard_count_; }
+
+  // key已存在时返回false，不会构造value
+  template <typename K, typename... Args>
+  bool emplace(K&& key, Args&&... args) {
+    shard& s = shard_for(key);
+    std::unique_lock<std::shared_mutex> lock(s.mutex);
+    return s.table.try_emplace_unique(std::forward<K>(key), std::forward<Args>(args)...).second;
+  }
+
+  bool insert(const value_type& value) { return emplace(value.first, value.second); }
+
+  // 返回true表示插入，false表示覆盖了已有的value
+  template <typename K, typename M>
+  bool insert_or_assign(K&& key, M&& obj) {
+    shard& s = shard_for(key);
+    std::unique_lock<std::shared_mutex> lock(s.mutex);
+    auto result = s.table.try_emplace_unique(std::forward<K>(key), std::forward<M>(obj));
+    if (!result.second)
+      result.first->second = std::forward<M>(obj);
+    return result.second;
+  }
+
+  size_type erase(const key_type& key) {
+    shard& s = shard_for(key);
+    std::unique_lock<std::shared_mutex> lock(s.mutex);
+    return s.table.erase(key);
+  }
+
+  bool contains(const key_type& key) const { return count(key) != 0; }
+
+  size_type count(const key_type& key) const {
+    const shard& s = shard_for(key);
+    std::shared_lock<std::shared_mutex> lock(s.mutex);
+    return s.table.count(key);
+  }
+
+  // 在共享锁下调用fn(const value_type&)，key不存在时返回false
+  template <typename Fn>
+  bool visit(const key_type& key, Fn fn) const {
+    shard& s = shard_for(key);
+    std::shared_lock<std::shared_mutex> lock(s.mutex);
+    auto it = s.table.find(key);
+    if (it == s.table.end())
+      return false;
+    fn(static_cast<const value_type&>(*it));
+    return true;
+  }
+
+  // 在互斥锁下调用fn(mapped_type&)，key不存在时返回false
+  template <typename Fn>
+  bool update(const key_type& key, Fn fn) {
+    shard& s = shard_for(key);
+    std::unique_lock<std::shared_mutex> lock(s.mutex);
+    auto it = s.table.find(key);
+    if (it == s.table.end())
+      return false;
+    fn(it->second);
+    return true;
+  }
+
+  // key不存在时用args构造value，否则在互斥锁下调用fn(mapped_type&)；返回true表示插入
+  template <typename K, typename Fn, typename... Args>
+  bool try_emplace_or_update(K&& key, Fn fn, Args&&... args) {
+    shard& s = shard_for(key);
+    std::unique_lock<std::shared_mutex> lock(s.mutex);
+    auto result = s.table.try_emplace_unique(std::forward<K>(key), std::forward<Args>(args)...);
+    if (!result.second)
+      fn(result.first->second);
+    return result.second;
+  }
+
+  // 有并发写者时只是一个近似值
+  size_type size() const {
+    size_type n = 0;
+    for (size_type i = 0; i < shard_count_; ++i) {
+      std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+      n += shards_[i].table.size();
+    }
+    return n;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  void clear() {
+    for (size_type i = 0; i < shard_count_; ++i) {
+      std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+      shards_[i].table.clear();
+    }
+  }
+
+  // 每个分片预留count / shard_count个元素的桶，逐个分片加锁，其他分片照常读写
+  void reserve(size_type count) {
+    for (size_type i = 0; i < shard_count_; ++i) {
+      std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+      shards_[i].table.reserve(count / shard_count_ + 1);
+    }
+  }
+
+  // 分片扩容时只搬迁一部分桶，持锁时间不再和分片大小成正比
+  void set_incremental_rehash(bool on) {
+    for (size_type i = 0; i < shard_count_; ++i) {
+      std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+      shards_[i].table.set_incremental_rehash(on);
+    }
+  }
+
+ private:
+  // 分片内的Policy用hash的低位或者乘法后的高位选桶，这里先用fmix64打散再取高位，两者互不相关
+  template <typename K>
+  shard& shard_for(const K& key) const {
+    return shards_[hashtable_mix64(hash_(key)) >> shard_shift_];
+  }
+};
+
+}  // namespace tiny_stl
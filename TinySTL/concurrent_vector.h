@@ -0,0 +1,224 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "trace.h"
+
+namespace tiny_stl {
+
+template <typename T>
+struct concurrent_vector_slot {
+  using storage_type = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+  std::atomic<bool> ready;  // NOTE: 元素构造完成后才置为true，读者只访问ready的槽
+  storage_type storage;
+
+  T& value() { return *reinterpret_cast<T*>(&storage); }
+  const T& value() const { return *reinterpret_cast<const T*>(&storage); }
+};
+
+template <typename T, typename Alloc = std::allocator<T>>
+class concurrent_vector;
+
+template <typename T, typename Alloc>
+struct concurrent_vector_iterator {
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = T;
+  using reference = const T&;
+  using pointer = const T*;
+  using difference_type = std::ptrdiff_t;
+
+  using self = concurrent_vector_iterator<T, Alloc>;
+  using container_type = concurrent_vector<T, Alloc>;
+
+  const container_type* vec_;
+  size_t index_;
+  size_t end_;  // NOTE: 创建begin()时的size快照，迭代过程中新追加的元素不会被访问
+
+  concurrent_vector_iterator(const container_type* vec, size_t index, size_t end)
+      : vec_(vec), index_(index), end_(end) {
+    skip_unpublished();
+  }
+
+  reference operator*() const { return vec_->slot_at(index_)->value(); }
+  pointer operator->() const { return &(operator*()); }
+
+  self& operator++() {
+    ++index_;
+    skip_unpublished();
+    return *this;
+  }
+
+  self operator++(int) {
+    self tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  // NOTE: begin()和end()各自取size快照，有写者追加时两者可能不同，走到自己快照末尾的迭代器都等于end
+  bool operator==(const self& other) const {
+    return index_ == other.index_ || (exhausted() && other.exhausted());
+  }
+  bool operator!=(const self& other) const { return !(*this == other); }
+
+ private:
+  bool exhausted() const { return index_ >= end_; }
+
+  // 跳过已经预留但还没有构造完成的槽
+  void skip_unpublished() {
+    while (index_ < end_ && !vec_->published(index_))
+      ++index_;
+  }
+};
+
+// 只追加的并发vector
+// 段目录中第k段的容量为 first_segment_size << k，扩容只分配新段，已有元素永远不会被移动。
+// 写者用fetch_add预留下标，构造完成后再发布该槽；读者可以在写者追加的同时遍历。
+template <typename T, typename Alloc>
+class concurrent_vector {
+  friend struct concurrent_vector_iterator<T, Alloc>;
+
+  using slot = concurrent_vector_slot<T>;
+  using slot_ptr = slot*;
+  using slot_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<slot>;
+
+  static constexpr size_t first_segment_bits = 3;
+  static constexpr size_t first_segment_size = size_t(1) << first_segment_bits;
+  static constexpr size_t max_segments = sizeof(size_t) * 8 - first_segment_bits;
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using allocator_type = Alloc;
+  using iterator = concurrent_vector_iterator<T, Alloc>;
+  using const_iterator = iterator;
+
+ private:
+  std::atomic<slot_ptr> segments_[max_segments];
+  alignas(64) std::atomic<size_type> size_;  // NOTE: 单独占一个cache line，避免和目录的读产生false sharing
+  slot_alloc_type allocator_;
+
+ public:
+  concurrent_vector() : size_(0) {
+    for (auto& segment : segments_)
+      segment.store(nullptr, std::memory_order_relaxed);
+  }
+
+  concurrent_vector(const concurrent_vector&) = delete;
+  concurrent_vector& operator=(const concurrent_vector&) = delete;
+
+  ~concurrent_vector() {
+    clear();
+  }
+
+  // 线程安全，返回新元素的下标
+  template <typename... Args>
+  size_type emplace_back(Args&&... args) {
+    size_type index = size_.fetch_add(1, std::memory_order_relaxed);
+    slot_ptr s = slot_for_write(index);
+    ::new (static_cast<void*>(&s->storage)) T(std::forward<Args>(args)...);
+    s->ready.store(true, std::memory_order_release);
+    return index;
+  }
+
+  size_type push_back(const_reference value) { return emplace_back(value); }
+  size_type push_back(value_type&& value) { return emplace_back(std::move(value)); }
+
+  // 已预留的槽数，其中可能有一部分还没有发布
+  size_type size() const { return size_.load(std::memory_order_acquire); }
+  bool empty() const { return size() == 0; }
+
+  bool published(size_type index) const {
+    const slot* s = slot_at(index);
+    return s && s->ready.load(std::memory_order_acquire);
+  }
+
+  // NOTE: 调用者需要保证index已经发布（例如来自本线程push_back的返回值）
+  reference operator[](size_type index) { return slot_at(index)->value(); }
+  const_reference operator[](size_type index) const { return slot_at(index)->value(); }
+
+  const_iterator begin() const {
+    size_type end = size();
+    return const_iterator(this, 0, end);
+  }
+  const_iterator end() const {
+    size_type end = size();
+    return const_iterator(this, end, end);
+  }
+
+  // 非线程安全：调用时不能有其他读者或写者
+  void clear() {
+    size_type size = size_.load(std::memory_order_relaxed);
+    for (size_type k = 0; k < max_segments; ++k) {
+      slot_ptr segment = segments_[k].load(std::memory_order_relaxed);
+      if (!segment)
+        continue;
+      size_type seg_size = segment_size(k);
+      size_type seg_begin = segment_base(k);
+      for (size_type i = 0; i < seg_size && seg_begin + i < size; ++i)
+        if (segment[i].ready.load(std::memory_order_relaxed))
+          segment[i].value().~T();
+      allocator_.deallocate(segment, seg_size);
+      segments_[k].store(nullptr, std::memory_order_relaxed);
+    }
+    size_.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  // 下标i映射到 j = i + first_segment_size，j的最高位决定段号
+  static size_type segment_index(size_type index) {
+    return (sizeof(size_type) * 8 - 1 - __builtin_clzll(index + first_segment_size)) -
+           first_segment_bits;
+  }
+
+  static size_type segment_base(size_type k) {
+    return (first_segment_size << k) - first_segment_size;
+  }
+
+  static size_type segment_size(size_type k) { return first_segment_size << k; }
+
+  const slot* slot_at(size_type index) const {
+    size_type k = segment_index(index);
+    const slot* segment = segments_[k].load(std::memory_order_acquire);
+    return segment ? segment + (index - segment_base(k)) : nullptr;
+  }
+
+  slot_ptr slot_at(size_type index) {
+    return const_cast<slot_ptr>(static_cast<const concurrent_vector*>(this)->slot_at(index));
+  }
+
+  slot_ptr slot_for_write(size_type index) {
+    size_type k = segment_index(index);
+    slot_ptr segment = segments_[k].load(std::memory_order_acquire);
+    if (!segment)
+      segment = allocate_segment(k);
+    return segment + (index - segment_base(k));
+  }
+
+  // NOTE: 多个写者可能同时发现段不存在，CAS失败的一方释放自己分配的段
+  slot_ptr allocate_segment(size_type k) {
+    TINY_STL_TRACE_SCOPE("concurrent_vector::grow", k);
+    size_type seg_size = segment_size(k);
+    slot_ptr segment = allocator_.allocate(seg_size);
+    for (size_type i = 0; i < seg_size; ++i)
+      ::new (static_cast<void*>(&segment[i].ready)) std::atomic<bool>(false);
+    slot_ptr expected = nullptr;
+    if (!segments_[k].compare_exchange_strong(expected, segment, std::memory_order_acq_rel,
+                                              std::memory_order_acquire)) {
+      allocator_.deallocate(segment, seg_size);
+      return expected;
+    }
+    return segment;
+  }
+};
+
+}  // namespace tiny_stl
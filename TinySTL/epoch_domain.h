@@ -0,0 +1,176 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace tiny_stl {
+
+namespace impl {
+
+// 基于epoch的延迟回收
+// 读者进入临界区时把当前全局epoch登记到自己独占的槽里，退出时清空；写者摘下的对象记上摘下时的epoch。
+// 只有所有在临界区里的读者都已经登记了当前epoch，全局epoch才能加一；
+// 全局epoch比对象的epoch大2时，不可能还有读者拿着它的指针，这时才真正释放。
+// NOTE: 全进程共用一个实例，槽按cache line对齐，读者只写自己的槽
+class epoch_domain {
+ public:
+  static constexpr size_t max_threads = 128;
+  static constexpr size_t reclaim_threshold = 64;  // 攒够这么多待回收对象才尝试回收一次
+
+  static epoch_domain& instance() {
+    static epoch_domain domain;
+    return domain;
+  }
+
+  // 读者临界区，可以嵌套，只有最外层登记和清空epoch
+  class guard {
+   public:
+    guard() { instance().enter(); }
+    ~guard() { instance().exit(); }
+    guard(const guard&) = delete;
+    guard& operator=(const guard&) = delete;
+  };
+
+  ~epoch_domain() {
+    for (retired& r : retired_)
+      r.release();
+  }
+
+  // ptr已经从所有读者能到达的地方摘下，等宽限期过后调用deleter(ptr)
+  void retire(void* ptr, void (*deleter)(void*)) { push_retired({ptr, deleter, nullptr, nullptr, 0}); }
+
+  // 同上，回收时调用deleter(ptr, context)；对象回收时容器可能已经析构，需要的状态（比如分配器）放在context里
+  void retire(void* ptr, void (*deleter)(void*, void*), void* context) {
+    push_retired({ptr, nullptr, deleter, context, 0});
+  }
+
+  // 没有读者在临界区里时，调用一次就能释放之前retire的所有对象
+  void reclaim() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    try_advance();
+    reclaim_locked();
+  }
+
+  size_t pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return retired_.size();
+  }
+
+ private:
+  static constexpr uint64_t idle = 0;
+
+  struct alignas(64) slot {
+    std::atomic<uint64_t> epoch{idle};
+    std::atomic<bool> used{false};
+  };
+
+  struct retired {
+    void* ptr;
+    void (*deleter)(void*);
+    void (*context_deleter)(void*, void*);
+    void* context;
+    uint64_t epoch;
+
+    void release() {
+      if (context_deleter)
+        context_deleter(ptr, context);
+      else
+        deleter(ptr);
+    }
+  };
+
+  // 线程第一次进入临界区时占一个槽，线程退出时归还
+  struct thread_record {
+    slot* s = nullptr;
+    size_t depth = 0;
+
+    ~thread_record() {
+      if (s) {
+        s->epoch.store(idle, std::memory_order_release);
+        s->used.store(false, std::memory_order_release);
+      }
+    }
+  };
+
+  alignas(64) std::atomic<uint64_t> epoch_{1};
+  slot slots_[max_threads];
+  mutable std::mutex mutex_;     // 保护retired_，只有写者会拿
+  std::vector<retired> retired_;  // 按epoch非递减排列
+  size_t next_reclaim_ = reclaim_threshold;
+
+  epoch_domain() = default;
+
+  static thread_record& local() {
+    thread_local thread_record record;
+    return record;
+  }
+
+  slot* acquire_slot() {
+    for (slot& s : slots_) {
+      bool expected = false;
+      if (!s.used.load(std::memory_order_relaxed) &&
+          s.used.compare_exchange_strong(expected, true, std::memory_order_acquire))
+        return &s;
+    }
+    throw std::runtime_error("epoch_domain: too many threads");
+  }
+
+  void enter() {
+    thread_record& record = local();
+    if (record.depth++ != 0)
+      return;
+    if (!record.s)
+      record.s = acquire_slot();
+    record.s->epoch.store(epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    // NOTE: 登记必须先于之后对共享指针的读取被写者看到
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  void exit() {
+    thread_record& record = local();
+    if (--record.depth == 0)
+      record.s->epoch.store(idle, std::memory_order_release);
+  }
+
+  // 所有在临界区里的读者都登记了当前epoch时，全局epoch加一
+  void try_advance() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint64_t current = epoch_.load(std::memory_order_seq_cst);
+    for (const slot& s : slots_) {
+      uint64_t e = s.epoch.load(std::memory_order_seq_cst);
+      if (e != idle && e != current)
+        return;
+    }
+    epoch_.compare_exchange_strong(current, current + 1, std::memory_order_seq_cst);
+  }
+
+  void push_retired(retired r) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    r.epoch = epoch_.load(std::memory_order_seq_cst);
+    retired_.push_back(r);
+    if (retired_.size() >= next_reclaim_)
+      reclaim_locked();
+  }
+
+  void reclaim_locked() {
+    try_advance();
+    uint64_t current = epoch_.load(std::memory_order_seq_cst);
+    size_t freed = 0;
+    while (freed < retired_.size() && retired_[freed].epoch + 2 <= current) {
+      retired_[freed].release();
+      ++freed;
+    }
+    retired_.erase(retired_.begin(), retired_.begin() + freed);
+    // NOTE: 有读者一直不退出时剩下的对象回收不掉，下次阈值翻倍，避免每次retire都扫一遍
+    next_reclaim_ = std::max(reclaim_threshold, retired_.size() * 2);
+  }
+};
+
+}  // namespace impl
+
+}  // namespace tiny_stl
@@ -0,0 +1,492 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace tiny_stl {
+
+namespace impl {
+
+// 控制字节：最高位为0表示槽被占用，低7位是key的hash片段；最高位为1表示空槽或墓碑
+enum : int8_t { ctrl_empty = -128, ctrl_deleted = -2 };
+
+// 一组16个控制字节，各种match返回位掩码，第i位对应组内第i个槽
+struct ctrl_group {
+  static constexpr size_t width = 16;
+
+#ifdef __SSE2__
+  __m128i ctrl;
+
+  explicit ctrl_group(const int8_t* p) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+
+  uint32_t match(int8_t h2) const {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+  }
+  uint32_t match_empty() const { return match(ctrl_empty); }
+  // 空槽和墓碑的最高位都是1，movemask正好取出最高位
+  uint32_t match_empty_or_deleted() const { return _mm_movemask_epi8(ctrl); }
+#else
+  const int8_t* ctrl;
+
+  explicit ctrl_group(const int8_t* p) : ctrl(p) {}
+
+  uint32_t match(int8_t h2) const {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < width; ++i)
+      mask |= uint32_t(ctrl[i] == h2) << i;
+    return mask;
+  }
+  uint32_t match_empty() const { return match(ctrl_empty); }
+  uint32_t match_empty_or_deleted() const {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < width; ++i)
+      mask |= uint32_t(ctrl[i] < 0) << i;
+    return mask;
+  }
+#endif
+};
+
+// std::hash<int>是恒等函数，不混合的话连续的key会挤进同一组，低7位也几乎没有区分度
+inline size_t flat_hash_mix(size_t h) {
+  h ^= h >> 32;
+  h *= 0x9E3779B97F4A7C15ull;
+  h ^= h >> 29;
+  return h;
+}
+
+}  // namespace impl
+
+template <typename Value, bool IsConst>
+struct flat_hash_iterator {
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = Value;
+  using reference = typename std::conditional<IsConst, const Value&, Value&>::type;
+  using pointer = typename std::conditional<IsConst, const Value*, Value*>::type;
+  using difference_type = std::ptrdiff_t;
+
+  using self = flat_hash_iterator<Value, IsConst>;
+
+  const int8_t* ctrl_;
+  const int8_t* end_;
+  Value* slot_;
+
+  flat_hash_iterator(const int8_t* ctrl, const int8_t* end, Value* slot)
+      : ctrl_(ctrl), end_(end), slot_(slot) {
+    skip_free();
+  }
+  template <bool C = IsConst, typename = typename std::enable_if<C>::type>
+  flat_hash_iterator(const flat_hash_iterator<Value, false>& other)
+      : ctrl_(other.ctrl_), end_(other.end_), slot_(other.slot_) {}
+
+  reference operator*() const { return *slot_; }
+  pointer operator->() const { return slot_; }
+
+  self& operator++() {
+    ++ctrl_;
+    ++slot_;
+    skip_free();
+    return *this;
+  }
+
+  self operator++(int) {
+    self tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  bool operator==(const self& other) const { return ctrl_ == other.ctrl_; }
+  bool operator!=(const self& other) const { return ctrl_ != other.ctrl_; }
+
+ private:
+  void skip_free() {
+    while (ctrl_ != end_ && *ctrl_ < 0) {
+      ++ctrl_;
+      ++slot_;
+    }
+  }
+};
+
+// 开放寻址哈希表（Swiss table），接口和unordered_map一致
+// 元素直接存放在槽数组里，另有一个控制字节数组，每个字节保存对应槽的状态和7位hash片段。
+// 查找时按16个槽一组，用SSE2一次比较整组控制字节，只有片段相同的槽才比较key；
+// 组内有空槽就说明key不存在。组之间按三角数序列探测，容量是16的2的幂倍，能遍历所有组。
+// 删除时如果所在组里还有空槽就直接置空，否则留下墓碑；占用的槽（含墓碑）超过7/8时rehash。
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename Pred = std::equal_to<Key>,
+          typename Alloc = std::allocator<std::pair<const Key, T>>>
+class flat_hash_map {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<Key, T>;
+  using hasher = Hash;
+  using key_equal = Pred;
+  using allocator_type = Alloc;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using iterator = flat_hash_iterator<value_type, false>;
+  using const_iterator = flat_hash_iterator<value_type, true>;
+
+ private:
+  using group = impl::ctrl_group;
+  using slot_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<value_type>;
+  using ctrl_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<int8_t>;
+
+  static constexpr size_type npos = size_type(-1);
+  static constexpr size_type batch_width = 16;  // 批量查找时同时在途的key数
+
+  int8_t* ctrl_;
+  value_type* slots_;
+  size_type capacity_;     // 0或者16的2的幂倍
+  size_type size_;
+  size_type growth_left_;  // 还能占用多少个空槽，墓碑也算占用
+  hasher hash_;
+  key_equal equal_;
+  slot_alloc_type slot_alloc_;
+  ctrl_alloc_type ctrl_alloc_;
+
+ public:
+  explicit flat_hash_map(const hasher& hash = hasher(), const key_equal& equal = key_equal(),
+                         const Alloc& alloc = Alloc())
+      : ctrl_(nullptr),
+        slots_(nullptr),
+        capacity_(0),
+        size_(0),
+        growth_left_(0),
+        hash_(hash),
+        equal_(equal),
+        slot_alloc_(alloc),
+        ctrl_alloc_(alloc) {}
+
+  flat_hash_map(std::initializer_list<value_type> values) : flat_hash_map() {
+    reserve(values.size());
+    for (const auto& value : values)
+      emplace(value);
+  }
+
+  flat_hash_map(const flat_hash_map& other)
+      : flat_hash_map(other.hash_, other.equal_, Alloc(other.slot_alloc_)) {
+    reserve(other.size_);
+    for (const auto& value : other)
+      emplace(value);
+  }
+
+  flat_hash_map(flat_hash_map&& other) : flat_hash_map(other.hash_, other.equal_, Alloc(other.slot_alloc_)) {
+    swap(other);
+  }
+
+  flat_hash_map& operator=(const flat_hash_map& other) {
+    if (this != &other) {
+      flat_hash_map tmp(other);
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  flat_hash_map& operator=(flat_hash_map&& other) {
+    if (this != &other) {
+      swap(other);
+      other.clear();
+    }
+    return *this;
+  }
+
+  ~flat_hash_map() {
+    destroy_slots();
+    deallocate(ctrl_, slots_, capacity_);
+  }
+
+  iterator begin() { return iterator(ctrl_, ctrl_ + capacity_, slots_); }
+  iterator end() { return iterator(ctrl_ + capacity_, ctrl_ + capacity_, slots_ + capacity_); }
+  const_iterator begin() const { return const_cast<flat_hash_map*>(this)->begin(); }
+  const_iterator end() const { return const_cast<flat_hash_map*>(this)->end(); }
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+
+  size_type bucket_count() const { return capacity_; }
+  float load_factor() const { return capacity_ ? (float)size_ / capacity_ : 0.0f; }
+  float max_load_factor() const { return 7.0f / 8; }
+
+  // NOTE: 保留已分配的槽数组
+  void clear() {
+    destroy_slots();
+    if (capacity_)
+      std::memset(ctrl_, impl::ctrl_empty, capacity_);
+    size_ = 0;
+    growth_left_ = max_load(capacity_);
+  }
+
+  void swap(flat_hash_map& other) {
+    std::swap(ctrl_, other.ctrl_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(growth_left_, other.growth_left_);
+    std::swap(hash_, other.hash_);
+    std::swap(equal_, other.equal_);
+    std::swap(slot_alloc_, other.slot_alloc_);
+    std::swap(ctrl_alloc_, other.ctrl_alloc_);
+  }
+
+  // 槽数至少为count，并且能容纳当前元素；同时清除所有墓碑
+  void rehash(size_type count) {
+    size_type capacity = group::width;
+    while (capacity < count || max_load(capacity) < size_)
+      capacity *= 2;
+    resize(capacity);
+  }
+
+  // 保证再插入到count个元素之前不会rehash
+  void reserve(size_type count) {
+    if (count <= size_ + growth_left_)
+      return;
+    size_type capacity = group::width;
+    while (max_load(capacity) < count)
+      capacity *= 2;
+    resize(capacity);
+  }
+
+  mapped_type& operator[](const key_type& key) { return try_emplace(key).first->second; }
+  mapped_type& operator[](key_type&& key) { return try_emplace(std::move(key)).first->second; }
+
+  mapped_type& at(const key_type& key) {
+    iterator it = find(key);
+    if (it == end())
+      throw std::out_of_range("flat_hash_map::at");
+    return it->second;
+  }
+
+  const mapped_type& at(const key_type& key) const {
+    const_iterator it = find(key);
+    if (it == end())
+      throw std::out_of_range("flat_hash_map::at");
+    return it->second;
+  }
+
+  iterator find(const key_type& key) {
+    size_type index = find_index(key, hash_key(key));
+    return index == npos ? end() : iterator_at(index);
+  }
+
+  const_iterator find(const key_type& key) const {
+    return const_cast<flat_hash_map*>(this)->find(key);
+  }
+
+  size_type count(const key_type& key) const { return find(key) != end() ? 1 : 0; }
+  bool contains(const key_type& key) const { return find(key) != end(); }
+
+  // 按keys的顺序把每个key的查找结果写到out，不存在的key写end()
+  template <typename Keys, typename OutputIt>
+  OutputIt find_many(const Keys& keys, OutputIt out) {
+    probe_many(keys, [&](size_type index) { *out++ = index == npos ? end() : iterator_at(index); });
+    return out;
+  }
+
+  template <typename Keys, typename OutputIt>
+  OutputIt contains_many(const Keys& keys, OutputIt out) const {
+    probe_many(keys, [&](size_type index) { *out++ = index != npos; });
+    return out;
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    value_type value(std::forward<Args>(args)...);
+    const key_type& key = value.first;
+    return insert_unique(key, [&](pointer p) {
+      ::new (static_cast<void*>(p)) value_type(std::move(value));
+    });
+  }
+
+  // key已存在时不构造value
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+    return insert_unique(key, [&](pointer p) {
+      ::new (static_cast<void*>(p)) value_type(std::piecewise_construct,
+                                               std::forward_as_tuple(std::forward<K>(key)),
+                                               std::forward_as_tuple(std::forward<Args>(args)...));
+    });
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) { return emplace(value); }
+  std::pair<iterator, bool> insert(value_type&& value) { return emplace(std::move(value)); }
+
+  void erase(iterator pos) {
+    if (pos == end())
+      return;
+    erase_at(pos.ctrl_ - ctrl_);
+  }
+
+  size_type erase(const key_type& key) {
+    if (empty())
+      return 0;
+    size_type index = find_index(key, hash_key(key));
+    if (index == npos)
+      return 0;
+    erase_at(index);
+    return 1;
+  }
+
+  allocator_type get_allocator() const { return allocator_type(slot_alloc_); }
+
+ private:
+  static size_type max_load(size_type capacity) { return capacity - capacity / 8; }
+
+  size_t hash_key(const key_type& key) const { return impl::flat_hash_mix(hash_(key)); }
+  static int8_t h2(size_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+
+  iterator iterator_at(size_type index) {
+    return iterator(ctrl_ + index, ctrl_ + capacity_, slots_ + index);
+  }
+
+  // 每batch_width个key一组：先算hash并预取第一组控制字节，再用h2在组内找出第一个候选槽并预取，
+  // 最后才正式探测；一组key的cache miss可以同时在途
+  template <typename Keys, typename Fn>
+  void probe_many(const Keys& keys, Fn fn) const {
+    const key_type* batch[batch_width];
+    size_t hashes[batch_width];
+    size_type mask = capacity_ / group::width - 1;
+    auto it = std::begin(keys);
+    auto last = std::end(keys);
+    while (it != last) {
+      size_type n = 0;
+      for (; n < batch_width && it != last; ++n, ++it) {
+        batch[n] = std::addressof(*it);
+        hashes[n] = hash_key(*batch[n]);
+        if (capacity_)
+          __builtin_prefetch(ctrl_ + ((hashes[n] >> 7) & mask) * group::width);
+      }
+      if (capacity_) {
+        for (size_type i = 0; i < n; ++i) {
+          size_type base = ((hashes[i] >> 7) & mask) * group::width;
+          uint32_t m = group(ctrl_ + base).match(h2(hashes[i]));
+          if (m)
+            __builtin_prefetch(slots_ + base + __builtin_ctz(m));
+        }
+      }
+      for (size_type i = 0; i < n; ++i)
+        fn(find_index(*batch[i], hashes[i]));
+    }
+  }
+
+  size_type find_index(const key_type& key, size_t hash) const {
+    if (capacity_ == 0)
+      return npos;
+    size_type mask = capacity_ / group::width - 1;
+    size_type g = (hash >> 7) & mask;
+    for (size_type step = 1;; ++step) {
+      size_type base = g * group::width;
+      group grp(ctrl_ + base);
+      for (uint32_t m = grp.match(h2(hash)); m; m &= m - 1) {
+        size_type index = base + __builtin_ctz(m);
+        if (equal_(slots_[index].first, key))
+          return index;
+      }
+      if (grp.match_empty())
+        return npos;
+      g = (g + step) & mask;
+    }
+  }
+
+  // 探测序列上第一个空槽或墓碑；负载不超过7/8，一定能找到
+  size_type find_free(size_t hash) const {
+    size_type mask = capacity_ / group::width - 1;
+    size_type g = (hash >> 7) & mask;
+    for (size_type step = 1;; ++step) {
+      size_type base = g * group::width;
+      uint32_t m = group(ctrl_ + base).match_empty_or_deleted();
+      if (m)
+        return base + __builtin_ctz(m);
+      g = (g + step) & mask;
+    }
+  }
+
+  template <typename F>
+  std::pair<iterator, bool> insert_unique(const key_type& key, F construct) {
+    size_t hash = hash_key(key);
+    size_type index = find_index(key, hash);
+    if (index != npos)
+      return std::make_pair(iterator_at(index), false);
+    if (capacity_ == 0)
+      resize(group::width);
+    index = find_free(hash);
+    if (growth_left_ == 0 && ctrl_[index] == impl::ctrl_empty) {
+      // 墓碑超过一半时原地重建就够了，否则容量翻倍
+      resize(size_ * 2 > max_load(capacity_) ? capacity_ * 2 : capacity_);
+      index = find_free(hash);
+    }
+    construct(slots_ + index);
+    if (ctrl_[index] == impl::ctrl_empty)
+      --growth_left_;
+    ctrl_[index] = h2(hash);
+    ++size_;
+    return std::make_pair(iterator_at(index), true);
+  }
+
+  void erase_at(size_type index) {
+    slots_[index].~value_type();
+    --size_;
+    // 组内已经有空槽，说明没有任何探测越过这一组，可以直接置空
+    if (group(ctrl_ + (index & ~(group::width - 1))).match_empty()) {
+      ctrl_[index] = impl::ctrl_empty;
+      ++growth_left_;
+    } else {
+      ctrl_[index] = impl::ctrl_deleted;
+    }
+  }
+
+  void resize(size_type capacity) {
+    int8_t* old_ctrl = ctrl_;
+    value_type* old_slots = slots_;
+    size_type old_capacity = capacity_;
+
+    ctrl_ = ctrl_alloc_.allocate(capacity);
+    slots_ = slot_alloc_.allocate(capacity);
+    std::memset(ctrl_, impl::ctrl_empty, capacity);
+    capacity_ = capacity;
+    growth_left_ = max_load(capacity) - size_;
+
+    for (size_type i = 0; i < old_capacity; ++i) {
+      if (old_ctrl[i] < 0)
+        continue;
+      size_t hash = hash_key(old_slots[i].first);
+      size_type index = find_free(hash);
+      ::new (static_cast<void*>(slots_ + index)) value_type(std::move(old_slots[i]));
+      old_slots[i].~value_type();
+      ctrl_[index] = h2(hash);
+    }
+    deallocate(old_ctrl, old_slots, old_capacity);
+  }
+
+  void destroy_slots() {
+    for (size_type i = 0; i < capacity_; ++i)
+      if (ctrl_[i] >= 0)
+        slots_[i].~value_type();
+  }
+
+  void deallocate(int8_t* ctrl, value_type* slots, size_type capacity) {
+    if (capacity == 0)
+      return;
+    ctrl_alloc_.deallocate(ctrl, capacity);
+    slot_alloc_.deallocate(slots, capacity);
+  }
+};
+
+}  // namespace tiny_stl
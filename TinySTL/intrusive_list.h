@@ -0,0 +1,286 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "list.h"
+
+namespace tiny_stl {
+
+// 嵌在元素里的链表钩子
+// 元素析构时钩子自动从所在的链表上摘下来，所以intrusive_list不保存size，size()是O(n)的
+struct intrusive_list_hook {
+  intrusive_list_hook* prev = nullptr;
+  intrusive_list_hook* next = nullptr;
+
+  intrusive_list_hook() = default;
+  // NOTE: 拷贝元素时不拷贝链接状态，新对象不在任何链表上
+  intrusive_list_hook(const intrusive_list_hook&) {}
+  intrusive_list_hook& operator=(const intrusive_list_hook&) { return *this; }
+
+  ~intrusive_list_hook() { unlink(); }
+
+  bool is_linked() const { return next != nullptr; }
+
+  // 从所在的链表上摘下来，没有链接时什么也不做
+  void unlink() {
+    if (!is_linked())
+      return;
+    impl::unlink_range(this, next);
+    prev = nullptr;
+    next = nullptr;
+  }
+};
+
+namespace impl {
+
+// 通过成员指针在hook和元素之间换算
+template <typename T, intrusive_list_hook T::*Hook>
+struct intrusive_hook_traits {
+  static intrusive_list_hook* to_hook(T& value) { return &(value.*Hook); }
+
+  static T* to_value(intrusive_list_hook* hook) {
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(hook) - offset());
+  }
+
+  static std::ptrdiff_t offset() {
+    // NOTE: 用一个对齐的假地址求成员偏移，不会真正访问这块内存
+    constexpr std::uintptr_t base = alignof(T) > 4096 ? alignof(T) : 4096;
+    T* fake = reinterpret_cast<T*>(base);
+    return reinterpret_cast<char*>(&(fake->*Hook)) - reinterpret_cast<char*>(fake);
+  }
+};
+
+}  // namespace impl
+
+template <typename T, intrusive_list_hook T::*Hook, bool IsConst>
+struct intrusive_list_iterator {
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = T;
+  using reference = typename std::conditional<IsConst, const T&, T&>::type;
+  using pointer = typename std::conditional<IsConst, const T*, T*>::type;
+  using difference_type = std::ptrdiff_t;
+
+  using self = intrusive_list_iterator<T, Hook, IsConst>;
+  using traits = impl::intrusive_hook_traits<T, Hook>;
+  intrusive_list_hook* node_;
+
+  intrusive_list_iterator() = delete;
+  intrusive_list_iterator(intrusive_list_hook* node) : node_(node) {}
+  // 普通迭代器可以隐式转换成const迭代器
+  template <bool C = IsConst, typename = typename std::enable_if<C>::type>
+  intrusive_list_iterator(const intrusive_list_iterator<T, Hook, false>& other) : node_(other.node_) {}
+
+  self& operator++() {
+    node_ = node_->next;
+    return *this;
+  }
+
+  self operator++(int) {
+    self tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  self& operator--() {
+    node_ = node_->prev;
+    return *this;
+  }
+
+  self operator--(int) {
+    self tmp = *this;
+    --(*this);
+    return tmp;
+  }
+
+  reference operator*() const { return *traits::to_value(node_); }
+  pointer operator->() const { return traits::to_value(node_); }
+
+  bool operator==(const self& other) const { return node_ == other.node_; }
+  bool operator!=(const self& other) const { return node_ != other.node_; }
+};
+
+// 侵入式双向链表，不拥有元素，也不分配内存
+// 和list一样是带哨兵的环形链表，哨兵就是链表对象里的一个钩子。
+// 调试模式下检查重复插入、删除不在链表上的元素等误用。
+template <typename T, intrusive_list_hook T::*Hook>
+class intrusive_list {
+  using traits = impl::intrusive_hook_traits<T, Hook>;
+  using hook_ptr = intrusive_list_hook*;
+
+ public:
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using iterator = intrusive_list_iterator<T, Hook, false>;
+  using const_iterator = intrusive_list_iterator<T, Hook, true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+ private:
+  intrusive_list_hook head_;
+
+ public:
+  intrusive_list() { impl::init_ring(&head_); }
+
+  intrusive_list(const intrusive_list&) = delete;
+  intrusive_list& operator=(const intrusive_list&) = delete;
+
+  intrusive_list(intrusive_list&& other) noexcept {
+    impl::init_ring(&head_);
+    splice(end(), other);
+  }
+
+  intrusive_list& operator=(intrusive_list&& other) noexcept {
+    if (this != &other) {
+      clear();
+      splice(end(), other);
+    }
+    return *this;
+  }
+
+  // NOTE: 只摘除元素，不销毁元素
+  ~intrusive_list() { clear(); }
+
+  iterator begin() { return iterator(head_.next); }
+  iterator end() { return iterator(&head_); }
+  const_iterator begin() const { return const_iterator(head_.next); }
+  const_iterator end() const { return const_iterator(const_cast<hook_ptr>(&head_)); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+  const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+  bool empty() const { return head_.next == &head_; }
+
+  size_type size() const {
+    size_type n = 0;
+    for (hook_ptr cur = head_.next; cur != &head_; cur = cur->next)
+      ++n;
+    return n;
+  }
+
+  reference front() {
+    assert(!empty());
+    return *begin();
+  }
+  reference back() {
+    assert(!empty());
+    return *iterator(head_.prev);
+  }
+  const_reference front() const {
+    assert(!empty());
+    return *begin();
+  }
+  const_reference back() const {
+    assert(!empty());
+    return *const_iterator(head_.prev);
+  }
+
+  void push_front(reference value) { insert(begin(), value); }
+  void push_back(reference value) { insert(end(), value); }
+
+  void pop_front() {
+    assert(!empty());
+    erase(begin());
+  }
+  void pop_back() {
+    assert(!empty());
+    erase(iterator(head_.prev));
+  }
+
+  iterator insert(iterator pos, reference value) {
+    hook_ptr hook = traits::to_hook(value);
+    assert(!hook->is_linked() && "element is already in a list");
+    impl::link_range_before(pos.node_, hook, hook);
+    return iterator(hook);
+  }
+
+  iterator erase(iterator pos) {
+    assert(pos.node_ != &head_ && "erase(end())");
+    iterator next(pos.node_->next);
+    pos.node_->unlink();
+    return next;
+  }
+
+  iterator erase(iterator first, iterator last) {
+    while (first != last)
+      first = erase(first);
+    return last;
+  }
+
+  // O(1)：直接通过元素自身的钩子摘除，不需要查找
+  void remove(reference value) {
+    assert(traits::to_hook(value)->is_linked() && "element is not in a list");
+    traits::to_hook(value)->unlink();
+  }
+
+  // 由元素得到指向它的迭代器
+  iterator iterator_to(reference value) {
+    assert(traits::to_hook(value)->is_linked());
+    return iterator(traits::to_hook(value));
+  }
+  const_iterator iterator_to(const_reference value) const {
+    hook_ptr hook = traits::to_hook(const_cast<reference>(value));
+    assert(hook->is_linked());
+    return const_iterator(hook);
+  }
+
+  void clear() {
+    hook_ptr cur = head_.next;
+    while (cur != &head_) {
+      hook_ptr next = cur->next;
+      cur->prev = nullptr;
+      cur->next = nullptr;
+      cur = next;
+    }
+    impl::init_ring(&head_);
+  }
+
+  // 把value移到pos之前，value可以在任意一个链表上（包括本链表）
+  void move_before(iterator pos, reference value) {
+    hook_ptr hook = traits::to_hook(value);
+    if (hook == pos.node_)
+      return;
+    hook->unlink();
+    impl::link_range_before(pos.node_, hook, hook);
+  }
+
+  void move_to_front(reference value) { move_before(begin(), value); }
+  void move_to_back(reference value) { move_before(end(), value); }
+
+  void splice(iterator pos, intrusive_list& other) {
+    if (other.empty())
+      return;
+    hook_ptr first = other.head_.next;
+    hook_ptr last = other.head_.prev;
+    impl::unlink_range(first, &other.head_);
+    impl::link_range_before(pos.node_, first, last);
+  }
+
+  void splice(iterator pos, intrusive_list& other, iterator first, iterator last) {
+    if (first == last)
+      return;
+    (void)other;
+    hook_ptr last_node = last.node_->prev;
+    impl::unlink_range(first.node_, last.node_);
+    impl::link_range_before(pos.node_, first.node_, last_node);
+  }
+
+  void swap(intrusive_list& other) {
+    intrusive_list tmp(std::move(other));
+    other.splice(other.end(), *this);
+    splice(end(), tmp);
+  }
+};
+
+}  // namespace tiny_stl
@@ -1,11 +1,93 @@
 #pragma once
 #include <iostream>
 #include "allocator.h"
+#include "trace.h"
 #include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
 
 namespace tiny_stl {
 
-  
+namespace impl {
+
+// 带哨兵的双向环形链表的链接操作，list和intrusive_list共用，Node只需要有prev/next
+// 把[first, last]这一段链到pos之前
+template <typename NodePtr>
+inline void link_range_before(NodePtr pos, NodePtr first, NodePtr last) {
+  NodePtr pos_prev = pos->prev;
+  pos_prev->next = first;
+  first->prev = pos_prev;
+  last->next = pos;
+  pos->prev = last;
+}
+
+// 把[begin, end)从环上摘下来，摘下的结点的指针不做修改
+template <typename NodePtr>
+inline void unlink_range(NodePtr begin, NodePtr end) {
+  NodePtr begin_prev = begin->prev;
+  begin_prev->next = end;
+  end->prev = begin_prev;
+}
+
+template <typename NodePtr>
+inline void init_ring(NodePtr sentinel) {
+  sentinel->next = sentinel;
+  sentinel->prev = sentinel;
+}
+
+// 给size()的缓存用：const的size()会写缓存，多个线程同时读同一个list时不能是普通变量
+// 修改list本来就要求独占，所以++、+=等用relaxed的load/store拼出来，不用带锁的原子读改写
+// NOTE: relaxed的load/store在x86和ARM上就是普通的读写指令，代价是编译器不能再把多次更新合并
+template <typename T>
+class relaxed_atomic {
+public:
+  relaxed_atomic(T value = T()) : value_(value) {}
+  relaxed_atomic(const relaxed_atomic& other) : value_(other.load()) {}
+  relaxed_atomic& operator=(const relaxed_atomic& other) { return *this = other.load(); }
+  relaxed_atomic& operator=(T value) {
+    store(value);
+    return *this;
+  }
+
+  T load(std::memory_order order = std::memory_order_relaxed) const { return value_.load(order); }
+  void store(T value, std::memory_order order = std::memory_order_relaxed) {
+    value_.store(value, order);
+  }
+  operator T() const { return load(); }
+
+  relaxed_atomic& operator+=(T delta) { return *this = load() + delta; }
+  relaxed_atomic& operator-=(T delta) { return *this = load() - delta; }
+  relaxed_atomic& operator++() { return *this += 1; }
+  relaxed_atomic& operator--() { return *this -= 1; }
+  T operator--(int) {
+    T old = load();
+    store(old - 1);
+    return old;
+  }
+
+private:
+  std::atomic<T> value_;
+};
+
+// 批量构造时一次分配的一段连续结点；结点不记录自己属于哪一块，释放时由list按地址查找
+// refs是持有这一块的list个数，不按结点计数：结点被splice/merge到别的list时，对方一起持有源list的所有块
+template <typename Node>
+struct list_node_block {
+  Node* nodes;
+  size_t count;
+  std::atomic<size_t> refs;
+
+  list_node_block(Node* first, size_t n) : nodes(first), count(n), refs(1) {}
+};
+
+}  // namespace impl
+
 template <typename T>
 struct list_node {
   T data;
@@ -131,6 +213,8 @@ private:
   using node = list_node<T>;
   using node_ptr = node*;
   using node_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+  using block_type = impl::list_node_block<node>;
+  using block_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<block_type>;
 
 public:
   using value_type = T;
@@ -147,9 +231,22 @@ public:
   using allocator_type = Alloc;  
   
   node_ptr node_;
-  size_type size_;
+  // NOTE: 区间splice之后两边的size都标记为未知，下次调用size()时再重新数一遍
+  // 重新数的结果写回缓存，const的size()可以被多个线程同时调用，所以用relaxed_atomic
+  mutable impl::relaxed_atomic<size_type> size_;
+  mutable impl::relaxed_atomic<bool> size_known_ = true;
   node_alloc_type allocator_;
 
+  // NOTE: 被释放的结点用next串成单链表缓存起来，create_node优先复用；free_limit_为0时不缓存
+  node_ptr free_nodes_ = nullptr;
+  size_type free_count_ = 0;
+  size_type free_limit_ = 0;
+
+  // NOTE: 批量构造时整块分配的结点不能单独归还，空闲后串到block_free_上，只由本list复用
+  // blocks_按首地址排序，释放结点时二分查找判断它在不在块里；块在list为空时shrink()或析构时才归还
+  std::vector<block_type*> blocks_;
+  node_ptr block_free_ = nullptr;
+
 public:
   list() {
     init_sentinel(); 
@@ -159,16 +256,13 @@ public:
   list(std::initializer_list<value_type> value_list) {
     init_sentinel();
     size_ = 0; // NOTE: 这里得初始化一下，不然是随机值
-    for (auto value : value_list)
-      push_back(std::move(value));
+    insert(end(), value_list.begin(), value_list.end());
   }
 
   list(const list& other) {
     init_sentinel();
     size_ = 0;
-    for (auto value : other) {
-      push_back(value);
-    }
+    insert(end(), other.begin(), other.end());
   }
 
   list(list&& other) {
@@ -180,22 +274,19 @@ public:
   list(size_type size, const_reference value) {
     init_sentinel();
     size_ = 0;
-    for (size_type i = 0; i < size; ++i) {
-      push_back(value);
-    }
+    append_block(size, [&](pointer p) { allocator_.construct(p, value); });
   }
 
   list(size_type size, value_type&& value) {
     init_sentinel();
     size_ = 0;
     auto value_copy = std::move(value);
-    for (size_type i = 0; i < size; ++i) {
-      push_back(value_copy);
-    }
+    append_block(size, [&](pointer p) { allocator_.construct(p, value_copy); });
   }
 
   ~list() {
     clear();
+    shrink();
     deinit_sentinel(); // NOTE: 必须用deinit_sentinel，因为node_->data没有被构造
   }
 
@@ -203,9 +294,7 @@ public:
     if (this == &other)
       return *this;
     clear();
-    for (auto value : other) {
-      push_back(value);
-    }
+    insert(end(), other.begin(), other.end());
     return *this;
   }
 
@@ -219,8 +308,7 @@ public:
 
   list& operator=(std::initializer_list<value_type> value_list) {
     clear();
-    for (auto value : value_list)
-      push_back(value);
+    insert(end(), value_list.begin(), value_list.end());
     return *this;
   }
 
@@ -236,15 +324,54 @@ public:
   const_iterator rbegin() const { return const_iterator(node_->prev); }
   const_iterator rend() const { return const_iterator(node_); }
 
+  // NOTE: 一次遍历销毁所有结点，不再逐个unlink，最后统一重置哨兵
   void clear() {
-    while (!empty()) {
-      pop_front();
+    node_ptr cur = node_->next;
+    while (cur != node_) {
+      node_ptr next = cur->next;
+      allocator_.destroy(&(cur->data));
+      recycle_node(cur);
+      cur = next;
     }
+    impl::init_ring(node_);
+    size_ = 0;
+    size_known_ = true;
   }
 
+  // 队列式使用（push_back + pop_front）时开启，稳定状态下不再访问分配器
+  void set_node_cache_limit(size_type limit) {
+    free_limit_ = limit;
+    while (free_count_ > free_limit_)
+      allocator_.deallocate(take_cached_node(), 1);
+  }
+
+  size_type node_cache_limit() const { return free_limit_; }
+
+  size_type cached_nodes() const { return free_count_; }
+
+  // 释放所有缓存的结点，不改变缓存上限；list为空时同时放弃所有整块分配的结点
+  void shrink() {
+    while (free_count_ > 0)
+      allocator_.deallocate(take_cached_node(), 1);
+    if (empty())
+      release_blocks();
+  }
+
+  size_type block_count() const { return blocks_.size(); }
+
   bool empty() const { return node_->next == node_; }
 
-  size_type size() const { return size_; }
+  size_type size() const {
+    // NOTE: size_known_用release/acquire，看到true时一定能看到数好的size_
+    if (!size_known_.load(std::memory_order_acquire)) {
+      size_type n = 0;
+      for (node_ptr cur = node_->next; cur != node_; cur = cur->next)
+        ++n;
+      size_.store(n);
+      size_known_.store(true, std::memory_order_release);
+    }
+    return size_;
+  }
 
   reference front() { return *begin(); }
 
@@ -327,6 +454,43 @@ public:
     return iterator(new_node);
   }
 
+  // 先在链表外构造好一整条链，再一次性链到pos之前；区间长度已知时结点整块分配
+  template <typename InputIt,
+            typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+  iterator insert(iterator pos, InputIt first, InputIt last) {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value) {
+      size_type n = std::distance(first, last);
+      if (n == 0) return pos;
+      auto chain = create_chain(n, [&](pointer p) {
+        allocator_.construct(p, *first);
+        ++first;
+      });
+      insert_nodes_before(pos.node_, chain.first, chain.second);
+      size_ += n;
+      return iterator(chain.first);
+    } else {
+      if (first == last) return pos;
+      node_ptr head = create_node(*first);
+      node_ptr tail = head;
+      size_type n = 1;
+      try {
+        for (++first; first != last; ++first, ++n) {
+          node_ptr new_node = create_node(*first);
+          tail->next = new_node;
+          new_node->prev = tail;
+          tail = new_node;
+        }
+      } catch (...) {
+        destroy_chain(head);
+        throw;
+      }
+      insert_nodes_before(pos.node_, head, tail);
+      size_ += n;
+      return iterator(head);
+    }
+  }
+
   iterator erase(iterator it) {
     if (it == end())
       return it;
@@ -340,17 +504,34 @@ public:
     if (this == &other) return;
     std::swap(node_, other.node_);
     std::swap(size_, other.size_);
+    std::swap(size_known_, other.size_known_);
     std::swap(allocator_, other.allocator_);
+    std::swap(free_nodes_, other.free_nodes_);
+    std::swap(free_count_, other.free_count_);
+    std::swap(free_limit_, other.free_limit_);
+    std::swap(blocks_, other.blocks_);
+    std::swap(block_free_, other.block_free_);
   }
 
-  void merge(list& other) {
+  void merge(list& other) { merge(other, std::less<value_type>()); }
+
+  void merge(list&& other) { 
+    // NOTE: 在函数体内other是具名变量（左值），可以直接转发给左值版本
+    merge(other);
+  }
+
+  // NOTE: 只有other中的元素严格小于当前元素时才插入到它前面，相等时保留this在前，保证稳定
+  template <typename Compare>
+  void merge(list& other, Compare comp) {
     if (this == &other) return;
     if (other.empty()) return;
+    // NOTE: 当前list为空时整条接过来；不能用swap，否则两边的结点缓存和上限也会被交换
     if (empty()) {
-      swap(other);
+      splice(end(), other);
       return;
     }
 
+    share_blocks(other);
     auto insert_other_node = [&](node_ptr pos, node_ptr& other_node) {
       node_ptr other_node_next = other_node->next;
       insert_node_before(pos, other_node);
@@ -361,10 +542,10 @@ public:
     node_ptr this_node = node_->next;
     node_ptr other_node = other.node_->next;
     while (this_node != node_ && other_node != other.node_) 
-      if (this_node->data < other_node->data)
-        this_node = this_node->next;
+      if (comp(other_node->data, this_node->data))
+        insert_other_node(this_node, other_node);
       else
-       insert_other_node(this_node, other_node);
+        this_node = this_node->next;
         
     while (other_node != other.node_) 
       insert_other_node(node_, other_node);
@@ -373,43 +554,170 @@ public:
     other.node_->next = other.node_; 
     other.node_->prev = other.node_;
     other.size_ = 0;
-    size_ = new_size; 
+    size_ = new_size;
+    size_known_ = size_known_ && other.size_known_;
+    other.size_known_ = true;
   }
 
-  void merge(list&& other) { 
-    // NOTE: 无法直接调用merge(list& other)
-    // 因为other是右值引用，不能传递给merge(list& other)
-    // 这是因为右值引用除了传递给&&，就只能传递给const&了
-    if (this == &other) return;
-    if (other.empty()) return;
-    if (empty()) {
-      swap(other);
-      return;
+  template <typename Compare>
+  void merge(list&& other, Compare comp) { merge(other, comp); }
+
+  // 遍历辅助函数：直接沿next指针走，不经过迭代器
+  // NOTE: 曾经预取后面第几个结点，但要先读出前面结点的next才知道地址，预取追不上遍历，没有收益；
+  // 结点分散时先调用linearize()让遍历按地址递增访存
+  template <typename Fn>
+  Fn for_each(Fn fn) {
+    walk([&](node_ptr cur) {
+      fn(cur->data);
+      return false;
+    });
+    return fn;
+  }
+
+  template <typename Fn>
+  Fn for_each(Fn fn) const {
+    walk([&](node_ptr cur) {
+      fn(static_cast<const_reference>(cur->data));
+      return false;
+    });
+    return fn;
+  }
+
+  template <typename Pred>
+  iterator find_if(Pred pred) {
+    return iterator(walk([&](node_ptr cur) { return bool(pred(cur->data)); }));
+  }
+
+  template <typename Pred>
+  const_iterator find_if(Pred pred) const {
+    return const_iterator(walk(
+        [&](node_ptr cur) { return bool(pred(static_cast<const_reference>(cur->data))); }));
+  }
+
+  template <typename U, typename BinaryOp>
+  U accumulate(U init, BinaryOp op) const {
+    walk([&](node_ptr cur) {
+      init = op(std::move(init), static_cast<const_reference>(cur->data));
+      return false;
+    });
+    return init;
+  }
+
+  template <typename U>
+  U accumulate(U init) const { return accumulate(std::move(init), std::plus<>()); }
+
+  // 把现有结点按地址从小到大重新链接，再把元素按原来的链表顺序搬进去，之后的遍历按地址递增访存
+  // 不分配也不释放结点，迭代器不会悬空，但元素被移动到了别的结点上：
+  // 迭代器、指针和引用指向的是linearize之后落在同一个结点上的元素
+  // NOTE: 元素的移动赋值抛异常时只保证基本的异常安全
+  void linearize() {
+    if (node_->next == node_->prev) return;  // 空或者只有一个元素
+    std::vector<node_ptr> order;
+    for (node_ptr cur = node_->next; cur != node_; cur = cur->next)
+      order.push_back(cur);
+    size_type n = order.size();
+
+    // slot[i]：地址第i小的结点在链表中的位置；第i个元素要搬到这个结点上
+    std::vector<size_type> slot(n);
+    for (size_type i = 0; i < n; ++i)
+      slot[i] = i;
+    std::sort(slot.begin(), slot.end(), [&](size_type a, size_type b) {
+      return std::less<node_ptr>()(order[a], order[b]);
+    });
+    // from[j]：链表第j个位置上的结点最后要放的元素原来在哪个位置；按置换的环依次搬
+    std::vector<size_type> from(n);
+    for (size_type i = 0; i < n; ++i)
+      from[slot[i]] = i;
+    for (size_type start = 0; start < n; ++start) {
+      if (from[start] == start) continue;
+      value_type tmp = std::move(order[start]->data);
+      size_type j = start;
+      while (from[j] != start) {
+        order[j]->data = std::move(order[from[j]]->data);
+        size_type next = from[j];
+        from[j] = j;
+        j = next;
+      }
+      order[j]->data = std::move(tmp);
+      from[j] = j;
     }
 
-    auto insert_other_node = [&](node_ptr pos, node_ptr& other_node) {
-      node_ptr other_node_next = other_node->next;
-      insert_node_before(pos, other_node);
-      other_node = other_node_next;
-    };
+    node_ptr prev = node_;
+    for (size_type i = 0; i < n; ++i) {
+      node_ptr cur = order[slot[i]];
+      prev->next = cur;
+      cur->prev = prev;
+      prev = cur;
+    }
+    prev->next = node_;
+    node_->prev = prev;
+  }
 
-    size_type new_size = size_ + other.size_;
-    node_ptr this_node = node_->next;
-    node_ptr other_node = other.node_->next;
-    while (this_node != node_ && other_node != other.node_) 
-      if (this_node->data < other_node->data)
-        this_node = this_node->next;
-      else
-       insert_other_node(this_node, other_node);
-        
-    while (other_node != other.node_) 
-      insert_other_node(node_, other_node);
+  template <typename ListIt>
+  void merge_all(ListIt first, ListIt last) { merge_all(first, last, std::less<value_type>()); }
+
+  // k路归并：把[first, last)中所有list的元素归并到当前list，所有list都需要按comp有序
+  // 用败者树每次只需要log(k)次比较；相等的元素按 *this、*first、*(first+1)... 的顺序排列，保证稳定
+  // NOTE: 只重新链接结点，不分配内存；超过max_merge_ways路时分多轮，每轮当前list作为第0路
+  template <typename ListIt, typename Compare>
+  void merge_all(ListIt first, ListIt last, Compare comp) {
+    node_ptr heads[max_merge_ways];
+    while (first != last) {
+      size_type total = size_;
+      bool known = size_known_;
+      size_type ways = 0;
+      heads[ways++] = detach_chain(*this);
+      for (; first != last && ways < max_merge_ways; ++first) {
+        list& other = *first;
+        if (&other == this || other.empty()) continue;
+        share_blocks(other);
+        total += other.size_;
+        known = known && other.size_known_;
+        heads[ways++] = detach_chain(other);
+      }
+      merge_chains_into_ring(heads, ways, comp);
+      size_ = total;
+      size_known_ = known;
+    }
+  }
 
-    // NOTE: 确保当前list的内存安全，同时确保other仍然可以使用
-    other.node_->next = other.node_; 
-    other.node_->prev = other.node_;
-    other.size_ = 0;
-    size_ = new_size; 
+  void sort() { sort(std::less<value_type>()); }
+
+  // 自底向上的归并排序，只重新链接结点，不分配内存
+  // buckets[i]要么为空，要么是一条长度为2^i的有序单链表（只用next，以nullptr结尾）
+  template <typename Compare>
+  void sort(Compare comp) {
+    if (node_->next == node_->prev) return;  // 空或者只有一个元素
+
+    node_ptr buckets[sizeof(size_type) * 8] = {};
+    node_ptr cur = node_->next;
+    node_->prev->next = nullptr;
+    while (cur) {
+      node_ptr run = cur;
+      cur = cur->next;
+      run->next = nullptr;
+      size_type i = 0;
+      for (; buckets[i]; ++i) {
+        run = merge_chains(buckets[i], run, comp); // NOTE: buckets[i]中的元素在前，保证稳定
+        buckets[i] = nullptr;
+      }
+      buckets[i] = run;
+    }
+
+    node_ptr sorted = nullptr;
+    for (node_ptr bucket : buckets)
+      if (bucket)
+        sorted = sorted ? merge_chains(bucket, sorted, comp) : bucket;
+
+    // 最后统一恢复prev指针和哨兵
+    node_->next = sorted;
+    node_ptr prev = node_;
+    for (node_ptr n = sorted; n; n = n->next) {
+      n->prev = prev;
+      prev = n;
+    }
+    prev->next = node_;
+    node_->prev = prev;
   }
 
   void reverse() {
@@ -439,19 +747,23 @@ public:
 
   void unique() { unique(std::equal_to<value_type>()); }
 
+  // O(1)：不再用std::distance数区间长度，两个list的size都变为未知
   void splice(iterator pos, list &other, iterator begin, iterator end) {
     if (other.empty() || begin == end) return;
     node_ptr pos_node = pos.node_;
     node_ptr first_node = begin.node_;
     node_ptr end_node = end.node_;
     node_ptr last_node = end_node->prev;
-    size_type dis = std::distance(begin, end);
     assert((first_node != other.node_) && (last_node != other.node_));
 
+    if (&other != this)
+      share_blocks(other);
     unlink_nodes(first_node, end_node);
     insert_nodes_before(pos_node, first_node, last_node);
-    size_ += dis;
-    other.size_ -= dis;
+    if (&other != this) {
+      size_known_ = false;
+      other.size_known_ = false;
+    }
   }
 
   void splice(iterator pos, list &other, iterator it) {
@@ -460,28 +772,52 @@ public:
     // 而且这样导致begin和end都被++被改变了
     // splice(pos, other, it, ++it); 
     // 正确做法： （std::next的参数按值传递）
-    splice(pos, other, it, std::next(it));
+    node_ptr node = it.node_;
+    if (node == pos.node_ || node->next == pos.node_) return;
+    if (&other != this)
+      share_blocks(other);
+    unlink_node(node);
+    insert_node_before(pos.node_, node);
+    // NOTE: 单个结点的长度已知，size保持精确
+    ++size_;
+    --other.size_;
   }
 
+  // 整个list接过来，长度已知，size保持O(1)
   void splice(iterator pos, list &other) {
-    splice(pos, other, other.begin(), other.end());
+    if (&other == this || other.empty()) return;
+    share_blocks(other);
+    node_ptr first_node = other.node_->next;
+    node_ptr last_node = other.node_->prev;
+    unlink_nodes(first_node, other.node_);
+    insert_nodes_before(pos.node_, first_node, last_node);
+    size_ += other.size_;
+    size_known_ = size_known_ && other.size_known_;
+    other.size_ = 0;
+    other.size_known_ = true;
   }
 
 private:
 
 template<typename ...Args>
 node_ptr create_node(Args&&... args) {
-  node_ptr new_node = allocator_.allocate(1);
-  allocator_.construct(&(new_node->data), std::forward<Args>(args)...);
+  TINY_STL_TRACE_SCOPE("list::node_allocate", size_);
+  node_ptr new_node = block_free_ ? take_block_node()
+                     : free_count_ ? take_cached_node()
+                                   : allocator_.allocate(1);
+  try {
+    allocator_.construct(&(new_node->data), std::forward<Args>(args)...);
+  } catch (...) {
+    recycle_node(new_node);
+    throw;
+  }
   new_node->next = nullptr;
   new_node->prev = nullptr;
   return new_node;
 }
 
 void unlink_nodes(node_ptr begin, node_ptr end) {
-  node_ptr begin_prev = begin->prev; // NOTE: end是要操作的结点的最后一个结点的下一个结点
-  begin_prev->next = end;
-  end->prev = begin_prev;
+  impl::unlink_range(begin, end); // NOTE: end是要操作的结点的最后一个结点的下一个结点
 }
 
 void unlink_node(node_ptr node) {
@@ -489,25 +825,264 @@ void unlink_node(node_ptr node) {
 }
 
 void delete_node(node_ptr node) {
+  TINY_STL_TRACE_SCOPE("list::node_free", size_);
   unlink_node(node);
   allocator_.destroy(&(node->data));
-  allocator_.deallocate(node, 1);
+  recycle_node(node);
+}
+
+void recycle_node(node_ptr node) {
+  if (in_block(node)) {
+    node->next = block_free_;
+    block_free_ = node;
+  } else if (free_count_ < free_limit_) {
+    node->next = free_nodes_;
+    free_nodes_ = node;
+    ++free_count_;
+  } else {
+    allocator_.deallocate(node, 1);
+  }
+}
+
+node_ptr take_cached_node() {
+  node_ptr node = free_nodes_;
+  free_nodes_ = node->next;
+  --free_count_;
+  return node;
+}
+
+node_ptr take_block_node() {
+  node_ptr node = block_free_;
+  block_free_ = node->next;
+  return node;
+}
+
+// 第一个首地址大于first的块的位置
+typename std::vector<block_type*>::iterator block_position(node_ptr first) {
+  return std::upper_bound(blocks_.begin(), blocks_.end(), first,
+                          [](node_ptr n, const block_type* b) { return std::less<node_ptr>()(n, b->nodes); });
+}
+
+bool in_block(node_ptr node) {
+  if (blocks_.empty()) return false;
+  auto it = block_position(node);
+  if (it == blocks_.begin()) return false;
+  const block_type* block = *(it - 1);
+  return std::less<node_ptr>()(node, block->nodes + block->count);
+}
+
+// 分配n个连续结点和块头，按地址登记到blocks_
+block_type* create_block(size_type n) {
+  block_alloc_type block_alloc(allocator_);
+  node_ptr nodes = allocator_.allocate(n);
+  block_type* block = nullptr;
+  try {
+    block = block_alloc.allocate(1);
+    std::allocator_traits<block_alloc_type>::construct(block_alloc, block, nodes, n);
+    blocks_.insert(block_position(nodes), block);
+  } catch (...) {
+    if (block) block_alloc.deallocate(block, 1);
+    allocator_.deallocate(nodes, n);
+    throw;
+  }
+  return block;
+}
+
+void destroy_block(block_type* block) {
+  block_alloc_type block_alloc(allocator_);
+  allocator_.deallocate(block->nodes, block->count);
+  std::allocator_traits<block_alloc_type>::destroy(block_alloc, block);
+  block_alloc.deallocate(block, 1);
+}
+
+// other的结点要移到本list：一起持有other的所有块，这些结点在本list释放时才认得出来
+void share_blocks(const list& other) {
+  for (block_type* block : other.blocks_) {
+    auto it = block_position(block->nodes);
+    if (it != blocks_.begin() && *(it - 1) == block) continue;
+    block->refs.fetch_add(1, std::memory_order_relaxed);
+    blocks_.insert(it, block);
+  }
+}
+
+// 放弃对所有块的引用，最后一个持有者归还内存；调用时本list必须为空
+void release_blocks() {
+  for (block_type* block : blocks_)
+    if (block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      destroy_block(block);
+  blocks_.clear();
+  block_free_ = nullptr;
+}
+
+// 整块分配n个结点并依次构造，串成一条以nullptr结尾的链，返回首尾结点
+template <typename Construct>
+std::pair<node_ptr, node_ptr> create_block_chain(size_type n, Construct construct) {
+  TINY_STL_TRACE_SCOPE("list::block_allocate", n);
+  block_type* block = create_block(n);
+  node_ptr nodes = block->nodes;
+  size_type i = 0;
+  try {
+    for (; i < n; ++i) {
+      construct(&(nodes[i].data));
+      nodes[i].prev = i > 0 ? &nodes[i - 1] : nullptr;
+      nodes[i].next = i + 1 < n ? &nodes[i + 1] : nullptr;
+    }
+  } catch (...) {
+    while (i > 0)
+      allocator_.destroy(&(nodes[--i].data));
+    blocks_.erase(block_position(nodes) - 1);
+    destroy_block(block);
+    throw;
+  }
+  return {nodes, nodes + n - 1};
+}
+
+// 先用本list块里的空闲结点，不够的部分再整块分配
+template <typename Construct>
+std::pair<node_ptr, node_ptr> create_chain(size_type n, Construct construct) {
+  node_ptr head = nullptr;
+  node_ptr tail = nullptr;
+  auto append = [&](node_ptr first, node_ptr last) {
+    if (tail) {
+      tail->next = first;
+      first->prev = tail;
+    } else {
+      head = first;
+    }
+    tail = last;
+  };
+  try {
+    for (; n > 0 && block_free_; --n) {
+      node_ptr node = take_block_node();
+      try {
+        construct(&(node->data));
+      } catch (...) {
+        recycle_node(node);
+        throw;
+      }
+      node->next = nullptr;
+      node->prev = nullptr;
+      append(node, node);
+    }
+    if (n > 0) {
+      auto chain = create_block_chain(n, construct);
+      append(chain.first, chain.second);
+    }
+  } catch (...) {
+    destroy_chain(head);
+    throw;
+  }
+  return {head, tail};
+}
+
+template <typename Construct>
+void append_block(size_type n, Construct construct) {
+  if (n == 0) return;
+  auto chain = create_chain(n, construct);
+  insert_nodes_before(node_, chain.first, chain.second);
+  size_ += n;
+}
+
+// 销毁一条还没有链入list、以nullptr结尾的链
+void destroy_chain(node_ptr head) {
+  while (head) {
+    node_ptr next = head->next;
+    allocator_.destroy(&(head->data));
+    recycle_node(head);
+    head = next;
+  }
+}
+
+static constexpr size_type max_merge_ways = 256;
+
+// 从第一个结点开始遍历，visit返回true时停下并返回该结点，遍历完返回哨兵
+template <typename Visit>
+node_ptr walk(Visit visit) const {
+  for (node_ptr cur = node_->next; cur != node_; cur = cur->next)
+    if (visit(cur))
+      return cur;
+  return node_;
+}
+
+// 把list的结点摘成一条以nullptr结尾的链，list变为空
+static node_ptr detach_chain(list& l) {
+  if (l.empty()) return nullptr;
+  node_ptr head = l.node_->next;
+  l.node_->prev->next = nullptr;
+  impl::init_ring(l.node_);
+  l.size_ = 0;
+  l.size_known_ = true;
+  return head;
+}
+
+// 用败者树归并heads中的ways条有序链，结果链到当前list（当前list必须为空）
+// losers[1..ways-1]保存每场比赛的败者，losers[0]是总的胜者；链耗尽的一路视为无穷大
+template <typename Compare>
+void merge_chains_into_ring(node_ptr* heads, size_type ways, Compare& comp) {
+  // a在比较中胜出：a没有耗尽，且b耗尽或a更小，或相等时a的下标更小
+  auto beats = [&](size_type a, size_type b) {
+    if (!heads[a]) return false;
+    if (!heads[b]) return true;
+    if (comp(heads[a]->data, heads[b]->data)) return true;
+    if (comp(heads[b]->data, heads[a]->data)) return false;
+    return a < b;
+  };
+
+  size_type losers[max_merge_ways];
+  size_type winners[2 * max_merge_ways];
+  for (size_type i = 0; i < ways; ++i)
+    winners[ways + i] = i;
+  for (size_type p = ways - 1; p >= 1; --p) {
+    size_type l = winners[2 * p], r = winners[2 * p + 1];
+    bool left_wins = beats(l, r);
+    winners[p] = left_wins ? l : r;
+    losers[p] = left_wins ? r : l;
+  }
+  losers[0] = ways > 1 ? winners[1] : 0;
+
+  node_ptr tail = node_;
+  while (heads[losers[0]]) {
+    size_type w = losers[0];
+    node_ptr n = heads[w];
+    heads[w] = n->next;
+    tail->next = n;
+    n->prev = tail;
+    tail = n;
+    // 从胜者的叶子重新比赛到根
+    for (size_type p = (ways + w) / 2; p >= 1; p /= 2)
+      if (beats(losers[p], w))
+        std::swap(losers[p], w);
+    losers[0] = w;
+  }
+  tail->next = node_;
+  node_->prev = tail;
+}
+
+// 合并两条以nullptr结尾的有序单链表，相等时first中的结点在前
+template <typename Compare>
+static node_ptr merge_chains(node_ptr first, node_ptr second, Compare& comp) {
+  node_ptr head = nullptr;
+  node_ptr* tail = &head;
+  while (first && second) {
+    if (comp(second->data, first->data)) {
+      *tail = second;
+      second = second->next;
+    } else {
+      *tail = first;
+      first = first->next;
+    }
+    tail = &((*tail)->next);
+  }
+  *tail = first ? first : second;
+  return head;
 }
 
 void insert_nodes_before(node_ptr pos, node_ptr first, node_ptr last) {
-  node_ptr pos_prev = pos->prev;
-  pos_prev->next = first;
-  first->prev = pos_prev;
-  last->next = pos;
-  pos->prev = last;
+  impl::link_range_before(pos, first, last);
 }
 
 void insert_nodes_after(node_ptr pos, node_ptr first, node_ptr last) {
-  node_ptr pos_next = pos->next;
-  pos->next = first;
-  first->prev = pos;
-  last->next = pos_next;
-  pos_next->prev = last;
+  impl::link_range_before(pos->next, first, last);
 }
 
 void insert_node_before(node_ptr pos, node_ptr new_node) {
@@ -520,8 +1095,7 @@ void insert_node_after(node_ptr pos, node_ptr new_node) {
 
 void init_sentinel() {
   node_ = allocator_.allocate(1);
-  node_->next = node_;
-  node_->prev = node_;
+  impl::init_ring(node_);
 }
 
 void deinit_sentinel() {
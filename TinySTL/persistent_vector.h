@@ -0,0 +1,453 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace tiny_stl {
+
+template <typename T>
+class transient_vector;
+
+namespace impl {
+
+constexpr size_t pvector_bits = 5;
+constexpr size_t pvector_width = size_t(1) << pvector_bits;
+constexpr size_t pvector_mask = pvector_width - 1;
+
+// NOTE: 内部结点和叶子结点共用一个结构，叶子结点用storage存元素，内部结点用children存子树
+template <typename T>
+struct pvector_node {
+  using storage_type = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+  std::atomic<size_t> refs;
+  size_t count;  // 叶子结点中已构造的元素个数，内部结点不使用
+  bool leaf;
+  union {
+    pvector_node* children[pvector_width];
+    storage_type storage[pvector_width];
+  };
+
+  T& value(size_t i) { return *reinterpret_cast<T*>(&storage[i]); }
+  const T& value(size_t i) const { return *reinterpret_cast<const T*>(&storage[i]); }
+};
+
+}  // namespace impl
+
+// 32路trie + tail优化的持久化vector
+// 拷贝是O(1)的（只增加root和tail的引用计数），修改只会复制从root到目标叶子路径上的结点。
+// 引用计数是原子的，所以快照可以安全地交给其他线程读取。
+template <typename T>
+class persistent_vector {
+  friend class transient_vector<T>;
+
+  using node = impl::pvector_node<T>;
+  using node_ptr = node*;
+  using node_alloc_type = std::allocator<node>;
+
+  static constexpr size_t bits = impl::pvector_bits;
+  static constexpr size_t width = impl::pvector_width;
+  static constexpr size_t mask = impl::pvector_mask;
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using reference = const T&;
+  using const_reference = const T&;
+
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using reference = const T&;
+    using pointer = const T*;
+    using difference_type = std::ptrdiff_t;
+
+    const_iterator() = default;
+    const_iterator(const persistent_vector* vec, size_type index)
+        : vec_(vec), index_(index) {}
+
+    // NOTE: 缓存当前叶子，同一个叶子内的32个元素只需要一次树上的查找
+    reference operator*() const {
+      if (!leaf_ || (index_ & ~mask) != base_) {
+        leaf_ = vec_->leaf_for(index_);
+        base_ = index_ & ~mask;
+      }
+      return leaf_->value(index_ & mask);
+    }
+
+    pointer operator->() const { return &(operator*()); }
+
+    const_iterator& operator++() {
+      ++index_;
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+
+    bool operator==(const const_iterator& other) const { return index_ == other.index_; }
+    bool operator!=(const const_iterator& other) const { return index_ != other.index_; }
+
+   private:
+    const persistent_vector* vec_ = nullptr;
+    size_type index_ = 0;
+    mutable const node* leaf_ = nullptr;
+    mutable size_type base_ = 0;
+  };
+
+  using iterator = const_iterator;
+
+ private:
+  size_type size_ = 0;
+  size_type shift_ = bits;
+  node_ptr root_ = nullptr;
+  node_ptr tail_ = nullptr;
+
+ public:
+  persistent_vector() = default;
+
+  persistent_vector(std::initializer_list<value_type> init);
+
+  template <typename InputIterator,
+            typename = typename std::iterator_traits<InputIterator>::iterator_category>
+  persistent_vector(InputIterator first, InputIterator last);
+
+  persistent_vector(const persistent_vector& other)
+      : size_(other.size_),
+        shift_(other.shift_),
+        root_(acquire(other.root_)),
+        tail_(acquire(other.tail_)) {}
+
+  persistent_vector(persistent_vector&& other) noexcept
+      : size_(other.size_), shift_(other.shift_), root_(other.root_), tail_(other.tail_) {
+    other.size_ = 0;
+    other.shift_ = bits;
+    other.root_ = nullptr;
+    other.tail_ = nullptr;
+  }
+
+  ~persistent_vector() {
+    release(root_);
+    release(tail_);
+  }
+
+  persistent_vector& operator=(const persistent_vector& other) {
+    persistent_vector tmp(other);
+    swap(tmp);
+    return *this;
+  }
+
+  persistent_vector& operator=(persistent_vector&& other) noexcept {
+    persistent_vector tmp(std::move(other));
+    swap(tmp);
+    return *this;
+  }
+
+  void swap(persistent_vector& other) noexcept {
+    std::swap(size_, other.size_);
+    std::swap(shift_, other.shift_);
+    std::swap(root_, other.root_);
+    std::swap(tail_, other.tail_);
+  }
+
+  size_type size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, size_); }
+
+  const_reference operator[](size_type index) const {
+    return leaf_for(index)->value(index & mask);
+  }
+
+  const_reference at(size_type index) const {
+    if (index >= size_)
+      throw std::out_of_range("persistent_vector::at");
+    return (*this)[index];
+  }
+
+  const_reference front() const { return (*this)[0]; }
+  const_reference back() const { return (*this)[size_ - 1]; }
+
+  // 以下接口不修改自身，返回一个新版本，新旧版本共享未被修改的结点
+  persistent_vector push_back(const_reference value) const {
+    persistent_vector res(*this);
+    res.push_back_inplace(value);
+    return res;
+  }
+
+  persistent_vector push_back(value_type&& value) const {
+    persistent_vector res(*this);
+    res.push_back_inplace(std::move(value));
+    return res;
+  }
+
+  persistent_vector set(size_type index, const_reference value) const {
+    persistent_vector res(*this);
+    res.set_inplace(index, value);
+    return res;
+  }
+
+  persistent_vector set(size_type index, value_type&& value) const {
+    persistent_vector res(*this);
+    res.set_inplace(index, std::move(value));
+    return res;
+  }
+
+  persistent_vector pop_back() const {
+    persistent_vector res(*this);
+    res.pop_back_inplace();
+    return res;
+  }
+
+  // 批量构造时使用，transient在独占的结点上原地修改
+  transient_vector<T> transient() const { return transient_vector<T>(*this); }
+
+ private:
+  static node_ptr acquire(node_ptr n) {
+    if (n)
+      n->refs.fetch_add(1, std::memory_order_relaxed);
+    return n;
+  }
+
+  static void release(node_ptr n) {
+    if (!n || n->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+      return;
+    if (n->leaf) {
+      for (size_type i = 0; i < n->count; ++i)
+        n->value(i).~T();
+    } else {
+      for (size_type i = 0; i < width; ++i)
+        release(n->children[i]);
+    }
+    node_alloc_type().deallocate(n, 1);
+  }
+
+  static node_ptr new_node(bool leaf) {
+    node_ptr n = ::new (static_cast<void*>(node_alloc_type().allocate(1))) node;
+    n->refs.store(1, std::memory_order_relaxed);
+    n->count = 0;
+    n->leaf = leaf;
+    if (!leaf)
+      for (size_type i = 0; i < width; ++i)
+        n->children[i] = nullptr;
+    return n;
+  }
+
+  static node_ptr clone(const node* src) {
+    node_ptr n = new_node(src->leaf);
+    if (src->leaf) {
+      try {
+        for (; n->count < src->count; ++n->count)
+          new (&n->storage[n->count]) T(src->value(n->count));
+      } catch (...) {
+        release(n);
+        throw;
+      }
+    } else {
+      for (size_type i = 0; i < width; ++i)
+        n->children[i] = acquire(src->children[i]);
+    }
+    return n;
+  }
+
+  // NOTE: 引用计数为1说明只有当前版本能访问到这个结点，可以原地修改；否则先复制一份
+  static node_ptr editable(node_ptr& ref) {
+    if (ref->refs.load(std::memory_order_acquire) == 1)
+      return ref;
+    node_ptr copy = clone(ref);
+    release(ref);
+    ref = copy;
+    return copy;
+  }
+
+  size_type tail_offset() const {
+    return size_ < width ? 0 : ((size_ - 1) >> bits) << bits;
+  }
+
+  const node* leaf_for(size_type index) const {
+    assert(index < size_);
+    if (index >= tail_offset())
+      return tail_;
+    const node* n = root_;
+    for (size_type level = shift_; level > 0; level -= bits)
+      n = n->children[(index >> level) & mask];
+    return n;
+  }
+
+  node_ptr new_path(size_type level, node_ptr leaf) {
+    if (level == 0)
+      return leaf;
+    node_ptr n = new_node(false);
+    n->children[0] = new_path(level - bits, leaf);
+    return n;
+  }
+
+  // parent必须是可编辑的；size_还是插入tail之前的值
+  void push_tail(size_type level, node_ptr parent, node_ptr leaf) {
+    size_type subidx = ((size_ - 1) >> level) & mask;
+    if (level == bits) {
+      parent->children[subidx] = leaf;
+    } else if (parent->children[subidx]) {
+      push_tail(level - bits, editable(parent->children[subidx]), leaf);
+    } else {
+      parent->children[subidx] = new_path(level - bits, leaf);
+    }
+  }
+
+  template <typename U>
+  void push_back_inplace(U&& value) {
+    if (!tail_)
+      tail_ = new_node(true);
+    if (tail_->count < width) {
+      node_ptr tail = editable(tail_);
+      new (&tail->storage[tail->count]) T(std::forward<U>(value));
+      ++tail->count;
+      ++size_;
+      return;
+    }
+
+    // tail满了，把它挂到树上，再开一个新的tail
+    node_ptr leaf = new_node(true);
+    new (&leaf->storage[0]) T(std::forward<U>(value));
+    leaf->count = 1;
+    node_ptr full_tail = tail_;
+    tail_ = leaf;
+    if (!root_) {
+      root_ = new_node(false);
+      root_->children[0] = full_tail;
+    } else if ((size_ >> bits) > (size_type(1) << shift_)) {
+      // root溢出，树长高一层
+      node_ptr new_root = new_node(false);
+      new_root->children[0] = root_;
+      new_root->children[1] = new_path(shift_, full_tail);
+      root_ = new_root;
+      shift_ += bits;
+    } else {
+      push_tail(shift_, editable(root_), full_tail);
+    }
+    ++size_;
+  }
+
+  template <typename U>
+  void set_inplace(size_type index, U&& value) {
+    if (index >= size_)
+      throw std::out_of_range("persistent_vector::set");
+    if (index >= tail_offset()) {
+      editable(tail_)->value(index & mask) = std::forward<U>(value);
+      return;
+    }
+    node_ptr* ref = &root_;
+    for (size_type level = shift_; level > 0; level -= bits)
+      ref = &editable(*ref)->children[(index >> level) & mask];
+    editable(*ref)->value(index & mask) = std::forward<U>(value);
+  }
+
+  // 返回true表示这棵子树已经空了，ref已被释放并置空
+  bool pop_tail(size_type level, node_ptr& ref) {
+    size_type subidx = ((size_ - 2) >> level) & mask;
+    node_ptr n = editable(ref);
+    if (level > bits) {
+      if (!pop_tail(level - bits, n->children[subidx]) || subidx != 0)
+        return false;
+    } else if (subidx != 0) {
+      release(n->children[subidx]);
+      n->children[subidx] = nullptr;
+      return false;
+    }
+    release(ref);
+    ref = nullptr;
+    return true;
+  }
+
+  void pop_back_inplace() {
+    if (size_ == 0)
+      throw std::out_of_range("persistent_vector::pop_back");
+    if (size_ == 1) {
+      release(tail_);
+      tail_ = nullptr;
+      size_ = 0;
+      return;
+    }
+    if (size_ - tail_offset() > 1) {
+      node_ptr tail = editable(tail_);
+      tail->value(tail->count - 1).~T();
+      --tail->count;
+      --size_;
+      return;
+    }
+
+    // tail只剩一个元素，把树上最后一个叶子提上来当tail
+    node_ptr new_tail = acquire(const_cast<node_ptr>(leaf_for(size_ - 2)));
+    pop_tail(shift_, root_);
+    if (shift_ > bits && root_ && !root_->children[1]) {
+      node_ptr child = acquire(root_->children[0]);
+      release(root_);
+      root_ = child;
+      shift_ -= bits;
+    }
+    release(tail_);
+    tail_ = new_tail;
+    --size_;
+  }
+};
+
+// 批量可变的视图：修改只在独占的结点上原地进行，用persistent()冻结成持久化版本
+template <typename T>
+class transient_vector {
+  friend class persistent_vector<T>;
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using const_reference = const T&;
+
+  transient_vector() = default;
+
+  size_type size() const { return vec_.size(); }
+  bool empty() const { return vec_.empty(); }
+
+  const_reference operator[](size_type index) const { return vec_[index]; }
+
+  void push_back(const_reference value) { vec_.push_back_inplace(value); }
+  void push_back(value_type&& value) { vec_.push_back_inplace(std::move(value)); }
+
+  void set(size_type index, const_reference value) { vec_.set_inplace(index, value); }
+  void set(size_type index, value_type&& value) { vec_.set_inplace(index, std::move(value)); }
+
+  void pop_back() { vec_.pop_back_inplace(); }
+
+  // NOTE: 调用后transient变为空，避免冻结后的版本再被原地修改
+  persistent_vector<T> persistent() { return std::move(vec_); }
+
+ private:
+  explicit transient_vector(const persistent_vector<T>& vec) : vec_(vec) {}
+
+  persistent_vector<T> vec_;
+};
+
+template <typename T>
+persistent_vector<T>::persistent_vector(std::initializer_list<value_type> init) {
+  for (const auto& value : init)
+    push_back_inplace(value);
+}
+
+template <typename T>
+template <typename InputIterator, typename>
+persistent_vector<T>::persistent_vector(InputIterator first, InputIterator last) {
+  for (; first != last; ++first)
+    push_back_inplace(*first);
+}
+
+}  // namespace tiny_stl
@@ -0,0 +1,299 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "epoch_domain.h"
+#include "unordered_map.h"
+
+namespace tiny_stl {
+
+// 读多写少的哈希表：读者不加锁，也不写任何共享的内存（只写自己的epoch槽）
+// 桶头是原子指针，链表上的结点发布之后就不再修改：插入在桶头挂新结点；
+// 删除和修改复制目标之前的结点，拼出一条新链后一次性替换桶头，摘下的结点交给epoch_domain延迟释放。
+// 写者之间用一把互斥锁串行化；扩容时复制所有结点建一张新表，再原子地替换表指针。
+// NOTE: 结点沿用hashtable_node的布局，next在结点发布前写好，所以不需要是原子的；value_type必须可拷贝
+template <typename Key, typename Tp, typename Hash = std::hash<Key>,
+          typename Pred = std::equal_to<Key>,
+          typename Alloc = std::allocator<std::pair<const Key, Tp>>,
+          typename Policy = hashtable_fibonacci_policy>
+class rcu_unordered_map {
+ public:
+  using key_type = Key;
+  using value_type = std::pair<Key, Tp>;
+  using mapped_type = Tp;
+  using hasher = Hash;
+  using key_equal = Pred;
+  using allocator_type = Alloc;
+  using size_type = size_t;
+
+ private:
+  using node_type = hashtable_node<value_type>;
+  using node_ptr = node_type*;
+  using node_allocator = typename Alloc::template rebind<node_type>::other;
+  using data_allocator = typename Alloc::template rebind<value_type>::other;
+
+  struct bucket_array {
+    size_type count;
+    std::atomic<node_ptr>* heads;
+
+    explicit bucket_array(size_type n) : count(n), heads(new std::atomic<node_ptr>[n]) {
+      for (size_type i = 0; i < n; ++i)
+        heads[i].store(nullptr, std::memory_order_relaxed);
+    }
+    ~bucket_array() { delete[] heads; }
+
+    std::atomic<node_ptr>& head(size_t code) { return heads[Policy::index(code, count)]; }
+  };
+
+  std::atomic<bucket_array*> table_;
+  std::atomic<size_type> size_;
+  std::mutex write_mutex_;
+  hasher hash_;
+  key_equal equal_;
+
+ public:
+  explicit rcu_unordered_map(size_type bucket_count = 16, const hasher& hash = hasher(),
+                             const key_equal& equal = key_equal())
+      : table_(new bucket_array(Policy::bucket_count(bucket_count))),
+        size_(0),
+        hash_(hash),
+        equal_(equal) {}
+
+  rcu_unordered_map(const rcu_unordered_map&) = delete;
+  rcu_unordered_map& operator=(const rcu_unordered_map&) = delete;
+
+  // NOTE: 析构时不能再有读者；已经retire的结点由epoch_domain释放
+  ~rcu_unordered_map() {
+    bucket_array* table = table_.load(std::memory_order_relaxed);
+    for (size_type i = 0; i < table->count; ++i)
+      destroy_chain(table->heads[i].load(std::memory_order_relaxed));
+    delete table;
+  }
+
+  size_type size() const { return size_.load(std::memory_order_relaxed); }
+  bool empty() const { return size() == 0; }
+  size_type bucket_count() const {
+    impl::epoch_domain::guard guard;
+    return table_.load(std::memory_order_acquire)->count;
+  }
+
+  //======================================================//
+  // 读者：不加锁
+  //======================================================//
+
+  // 在读者临界区里调用fn(const value_type&)，key不存在时返回false
+  template <typename Fn>
+  bool visit(const key_type& key, Fn fn) const {
+    impl::epoch_domain::guard guard;
+    node_ptr node = find_node(key);
+    if (!node)
+      return false;
+    fn(static_cast<const value_type&>(node->val));
+    return true;
+  }
+
+  size_type count(const key_type& key) const {
+    impl::epoch_domain::guard guard;
+    return find_node(key) ? 1 : 0;
+  }
+
+  bool contains(const key_type& key) const { return count(key) != 0; }
+
+  //======================================================//
+  // 写者：互斥锁串行化，读者随时能看到一条完整的链
+  //======================================================//
+
+  // key已存在时返回false，不会构造value
+  template <typename K, typename... Args>
+  bool emplace(K&& key, Args&&... args) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    size_t code = hash_(key);
+    if (find_in_chain(current_table()->head(code), key))
+      return false;
+    link_new_node(code, create_node(std::piecewise_construct,
+                                    std::forward_as_tuple(std::forward<K>(key)),
+                                    std::forward_as_tuple(std::forward<Args>(args)...)));
+    return true;
+  }
+
+  bool insert(const value_type& value) { return emplace(value.first, value.second); }
+
+  // 返回true表示插入，false表示替换了已有的结点
+  template <typename K, typename M>
+  bool insert_or_assign(K&& key, M&& obj) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    size_t code = hash_(key);
+    std::atomic<node_ptr>& head = current_table()->head(code);
+    node_ptr found = find_in_chain(head, key);
+    node_ptr node = create_node(std::forward<K>(key), std::forward<M>(obj));
+    if (found) {
+      replace_in_chain(head, found, node);
+      return false;
+    }
+    link_new_node(code, node);
+    return true;
+  }
+
+  // 复制出一个新结点，在副本上调用fn(mapped_type&)后替换旧结点，key不存在时返回false
+  template <typename Fn>
+  bool update(const key_type& key, Fn fn) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    std::atomic<node_ptr>& head = current_table()->head(hash_(key));
+    node_ptr found = find_in_chain(head, key);
+    if (!found)
+      return false;
+    node_ptr node = create_node(found->val);
+    fn(node->val.second);
+    replace_in_chain(head, found, node);
+    return true;
+  }
+
+  size_type erase(const key_type& key) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    std::atomic<node_ptr>& head = current_table()->head(hash_(key));
+    node_ptr found = find_in_chain(head, key);
+    if (!found)
+      return 0;
+    replace_in_chain(head, found, nullptr);
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    return 1;
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    bucket_array* table = current_table();
+    for (size_type i = 0; i < table->count; ++i) {
+      node_ptr cur = table->heads[i].exchange(nullptr, std::memory_order_acq_rel);
+      for (; cur; cur = cur->next)
+        retire_node(cur);
+    }
+    size_.store(0, std::memory_order_relaxed);
+  }
+
+  void reserve(size_type count) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    size_type buckets = Policy::bucket_count(count);
+    if (buckets > current_table()->count)
+      rebuild(buckets);
+  }
+
+ private:
+  // 只有写者调用，已经持有write_mutex_
+  bucket_array* current_table() const { return table_.load(std::memory_order_relaxed); }
+
+  node_ptr find_node(const key_type& key) const {
+    size_t code = hash_(key);
+    bucket_array* table = table_.load(std::memory_order_acquire);
+    return find_in_chain(table->head(code), key);
+  }
+
+  template <typename K>
+  node_ptr find_in_chain(const std::atomic<node_ptr>& head, const K& key) const {
+    for (node_ptr cur = head.load(std::memory_order_acquire); cur; cur = cur->next)
+      if (equal_(cur->val.first, key))
+        return cur;
+    return nullptr;
+  }
+
+  // 新结点的next先指向旧的桶头，再发布到桶头，旧链一个结点都不用动
+  void link_new_node(size_t code, node_ptr node) {
+    if (size() + 1 > current_table()->count)
+      rebuild(Policy::bucket_count(current_table()->count * 2));
+    std::atomic<node_ptr>& head = current_table()->head(code);
+    node->next = head.load(std::memory_order_relaxed);
+    head.store(node, std::memory_order_release);
+    size_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // 复制target之前的结点拼成新链，target换成replacement（为nullptr时直接跳过），
+  // 新链的尾部接回target之后的原结点；替换桶头后退休旧的前缀和target
+  void replace_in_chain(std::atomic<node_ptr>& head, node_ptr target, node_ptr replacement) {
+    node_ptr old_head = head.load(std::memory_order_relaxed);
+    node_ptr new_head = nullptr;
+    node_ptr* link = &new_head;
+    for (node_ptr cur = old_head; cur != target; cur = cur->next) {
+      node_ptr copy = create_node(cur->val);
+      *link = copy;
+      link = &copy->next;
+    }
+    if (replacement) {
+      *link = replacement;
+      link = &replacement->next;
+    }
+    *link = target->next;
+    head.store(new_head, std::memory_order_release);
+    for (node_ptr cur = old_head; cur != target->next;) {
+      node_ptr next = cur->next;
+      retire_node(cur);
+      cur = next;
+    }
+  }
+
+  // 把所有结点复制到一张count个桶的新表，发布新表后退休旧表和旧结点
+  void rebuild(size_type count) {
+    TINY_STL_TRACE_SCOPE("rcu_unordered_map::rebuild", count);
+    bucket_array* old_table = current_table();
+    bucket_array* new_table = new bucket_array(count);
+    for (size_type i = 0; i < old_table->count; ++i) {
+      for (node_ptr cur = old_table->heads[i].load(std::memory_order_relaxed); cur; cur = cur->next) {
+        node_ptr copy = create_node(cur->val);
+        std::atomic<node_ptr>& head = new_table->head(hash_(copy->val.first));
+        copy->next = head.load(std::memory_order_relaxed);
+        head.store(copy, std::memory_order_relaxed);
+      }
+    }
+    table_.store(new_table, std::memory_order_release);
+    for (size_type i = 0; i < old_table->count; ++i) {
+      node_ptr cur = old_table->heads[i].load(std::memory_order_relaxed);
+      while (cur) {
+        node_ptr next = cur->next;
+        retire_node(cur);
+        cur = next;
+      }
+    }
+    impl::epoch_domain::instance().retire(old_table, &delete_table);
+  }
+
+  template <typename... Args>
+  static node_ptr create_node(Args&&... args) {
+    node_allocator node_alloc;
+    data_allocator data_alloc;
+    node_ptr node = node_alloc.allocate(1);
+    data_alloc.construct(std::addressof(node->val), std::forward<Args>(args)...);
+    node->next = nullptr;
+    return node;
+  }
+
+  // NOTE: 回收时map可能已经析构，所以deleter不能引用map，分配器都是临时构造的
+  static void destroy_node(void* ptr) {
+    node_ptr node = static_cast<node_ptr>(ptr);
+    node_allocator node_alloc;
+    data_allocator data_alloc;
+    data_alloc.destroy(std::addressof(node->val));
+    node_alloc.deallocate(node, 1);
+  }
+
+  static void delete_table(void* ptr) { delete static_cast<bucket_array*>(ptr); }
+
+  static void retire_node(node_ptr node) {
+    impl::epoch_domain::instance().retire(node, &destroy_node);
+  }
+
+  static void destroy_chain(node_ptr cur) {
+    while (cur) {
+      node_ptr next = cur->next;
+      destroy_node(cur);
+      cur = next;
+    }
+  }
+};
+
+}  // namespace tiny_stl
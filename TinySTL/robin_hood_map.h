@@ -0,0 +1,433 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "flat_hash_map.h"
+
+namespace tiny_stl {
+
+template <typename Value, bool IsConst>
+struct robin_hood_iterator {
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = Value;
+  using reference = typename std::conditional<IsConst, const Value&, Value&>::type;
+  using pointer = typename std::conditional<IsConst, const Value*, Value*>::type;
+  using difference_type = std::ptrdiff_t;
+
+  using self = robin_hood_iterator<Value, IsConst>;
+
+  const uint16_t* dist_;
+  const uint16_t* end_;
+  Value* slot_;
+
+  robin_hood_iterator(const uint16_t* dist, const uint16_t* end, Value* slot)
+      : dist_(dist), end_(end), slot_(slot) {
+    skip_empty();
+  }
+  template <bool C = IsConst, typename = typename std::enable_if<C>::type>
+  robin_hood_iterator(const robin_hood_iterator<Value, false>& other)
+      : dist_(other.dist_), end_(other.end_), slot_(other.slot_) {}
+
+  reference operator*() const { return *slot_; }
+  pointer operator->() const { return slot_; }
+
+  self& operator++() {
+    ++dist_;
+    ++slot_;
+    skip_empty();
+    return *this;
+  }
+
+  self operator++(int) {
+    self tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  bool operator==(const self& other) const { return dist_ == other.dist_; }
+  bool operator!=(const self& other) const { return dist_ != other.dist_; }
+
+ private:
+  void skip_empty() {
+    while (dist_ != end_ && *dist_ == 0) {
+      ++dist_;
+      ++slot_;
+    }
+  }
+};
+
+// Robin Hood开放寻址哈希表，接口和unordered_map一致
+// 每个槽记录元素离自己本来位置（home）的距离，插入时距离短的元素给距离长的让位，
+// 所以探测序列长度的方差很小。查找时一旦当前槽里元素的距离比我们已经走过的距离还短，
+// 说明key不可能在更后面，可以提前结束，未命中的查找因此也很短。
+// 删除时把后面的元素整体前移一格（backward shift），不需要墓碑。
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename Pred = std::equal_to<Key>,
+          typename Alloc = std::allocator<std::pair<const Key, T>>>
+class robin_hood_map {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<Key, T>;
+  using hasher = Hash;
+  using key_equal = Pred;
+  using allocator_type = Alloc;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using iterator = robin_hood_iterator<value_type, false>;
+  using const_iterator = robin_hood_iterator<value_type, true>;
+
+ private:
+  using slot_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<value_type>;
+  using dist_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<uint16_t>;
+
+  static constexpr size_type npos = size_type(-1);
+  static constexpr size_type min_capacity = 16;
+  static constexpr size_type batch_width = 16;  // 批量查找时同时在途的key数
+  // 某个元素离home超过这个距离时，下一次插入先扩容（负载太低时不扩，避免坏hash把表撑爆）
+  static constexpr uint16_t grow_distance = 128;
+
+  uint16_t* dist_;  // 0表示空槽，否则是离home的距离加1
+  value_type* slots_;
+  size_type capacity_;  // 0或者2的幂
+  size_type size_;
+  bool grow_next_;
+  hasher hash_;
+  key_equal equal_;
+  slot_alloc_type slot_alloc_;
+  dist_alloc_type dist_alloc_;
+
+ public:
+  explicit robin_hood_map(const hasher& hash = hasher(), const key_equal& equal = key_equal(),
+                          const Alloc& alloc = Alloc())
+      : dist_(nullptr),
+        slots_(nullptr),
+        capacity_(0),
+        size_(0),
+        grow_next_(false),
+        hash_(hash),
+        equal_(equal),
+        slot_alloc_(alloc),
+        dist_alloc_(alloc) {}
+
+  robin_hood_map(std::initializer_list<value_type> values) : robin_hood_map() {
+    reserve(values.size());
+    for (const auto& value : values)
+      emplace(value);
+  }
+
+  robin_hood_map(const robin_hood_map& other)
+      : robin_hood_map(other.hash_, other.equal_, Alloc(other.slot_alloc_)) {
+    reserve(other.size_);
+    for (const auto& value : other)
+      emplace(value);
+  }
+
+  robin_hood_map(robin_hood_map&& other)
+      : robin_hood_map(other.hash_, other.equal_, Alloc(other.slot_alloc_)) {
+    swap(other);
+  }
+
+  robin_hood_map& operator=(const robin_hood_map& other) {
+    if (this != &other) {
+      robin_hood_map tmp(other);
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  robin_hood_map& operator=(robin_hood_map&& other) {
+    if (this != &other) {
+      swap(other);
+      other.clear();
+    }
+    return *this;
+  }
+
+  ~robin_hood_map() {
+    destroy_slots();
+    deallocate(dist_, slots_, capacity_);
+  }
+
+  iterator begin() { return iterator(dist_, dist_ + capacity_, slots_); }
+  iterator end() { return iterator(dist_ + capacity_, dist_ + capacity_, slots_ + capacity_); }
+  const_iterator begin() const { return const_cast<robin_hood_map*>(this)->begin(); }
+  const_iterator end() const { return const_cast<robin_hood_map*>(this)->end(); }
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+
+  size_type bucket_count() const { return capacity_; }
+  float load_factor() const { return capacity_ ? (float)size_ / capacity_ : 0.0f; }
+  float max_load_factor() const { return 0.9f; }
+
+  // NOTE: 保留已分配的槽数组
+  void clear() {
+    destroy_slots();
+    if (capacity_)
+      std::memset(dist_, 0, capacity_ * sizeof(uint16_t));
+    size_ = 0;
+    grow_next_ = false;
+  }
+
+  void swap(robin_hood_map& other) {
+    std::swap(dist_, other.dist_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(grow_next_, other.grow_next_);
+    std::swap(hash_, other.hash_);
+    std::swap(equal_, other.equal_);
+    std::swap(slot_alloc_, other.slot_alloc_);
+    std::swap(dist_alloc_, other.dist_alloc_);
+  }
+
+  // 槽数至少为count，并且能容纳当前元素
+  void rehash(size_type count) {
+    size_type capacity = min_capacity;
+    while (capacity < count || max_load(capacity) < size_)
+      capacity *= 2;
+    resize(capacity);
+  }
+
+  // 保证再插入到count个元素之前不会因为负载因子rehash
+  void reserve(size_type count) {
+    if (count <= max_load(capacity_))
+      return;
+    size_type capacity = min_capacity;
+    while (max_load(capacity) < count)
+      capacity *= 2;
+    resize(capacity);
+  }
+
+  mapped_type& operator[](const key_type& key) { return try_emplace(key).first->second; }
+  mapped_type& operator[](key_type&& key) { return try_emplace(std::move(key)).first->second; }
+
+  mapped_type& at(const key_type& key) {
+    iterator it = find(key);
+    if (it == end())
+      throw std::out_of_range("robin_hood_map::at");
+    return it->second;
+  }
+
+  const mapped_type& at(const key_type& key) const {
+    const_iterator it = find(key);
+    if (it == end())
+      throw std::out_of_range("robin_hood_map::at");
+    return it->second;
+  }
+
+  iterator find(const key_type& key) {
+    size_type index = find_index(key);
+    return index == npos ? end() : iterator_at(index);
+  }
+
+  const_iterator find(const key_type& key) const {
+    return const_cast<robin_hood_map*>(this)->find(key);
+  }
+
+  size_type count(const key_type& key) const { return find_index(key) != npos ? 1 : 0; }
+  bool contains(const key_type& key) const { return find_index(key) != npos; }
+
+  // 按keys的顺序把每个key的查找结果写到out，不存在的key写end()
+  template <typename Keys, typename OutputIt>
+  OutputIt find_many(const Keys& keys, OutputIt out) {
+    probe_many(keys, [&](size_type index) { *out++ = index == npos ? end() : iterator_at(index); });
+    return out;
+  }
+
+  template <typename Keys, typename OutputIt>
+  OutputIt contains_many(const Keys& keys, OutputIt out) const {
+    probe_many(keys, [&](size_type index) { *out++ = index != npos; });
+    return out;
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    value_type value(std::forward<Args>(args)...);
+    size_type index = find_index(value.first);
+    if (index != npos)
+      return std::make_pair(iterator_at(index), false);
+    return std::make_pair(iterator_at(insert_new(std::move(value))), true);
+  }
+
+  // key已存在时不构造value
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+    size_type index = find_index(key);
+    if (index != npos)
+      return std::make_pair(iterator_at(index), false);
+    value_type value(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                     std::forward_as_tuple(std::forward<Args>(args)...));
+    return std::make_pair(iterator_at(insert_new(std::move(value))), true);
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) { return emplace(value); }
+  std::pair<iterator, bool> insert(value_type&& value) { return emplace(std::move(value)); }
+
+  // NOTE: 后面的元素会前移，pos之后的迭代器失效
+  void erase(iterator pos) {
+    if (pos == end())
+      return;
+    erase_at(pos.dist_ - dist_);
+  }
+
+  size_type erase(const key_type& key) {
+    size_type index = find_index(key);
+    if (index == npos)
+      return 0;
+    erase_at(index);
+    return 1;
+  }
+
+  allocator_type get_allocator() const { return allocator_type(slot_alloc_); }
+
+ private:
+  static size_type max_load(size_type capacity) { return capacity * 9 / 10; }
+
+  size_type home(const key_type& key) const {
+    return impl::flat_hash_mix(hash_(key)) & (capacity_ - 1);
+  }
+
+  iterator iterator_at(size_type index) {
+    return iterator(dist_ + index, dist_ + capacity_, slots_ + index);
+  }
+
+  size_type find_index(const key_type& key) const {
+    if (size_ == 0)
+      return npos;
+    return find_index_from(key, home(key));
+  }
+
+  // 每batch_width个key一组：先算出所有home并预取距离数组和槽，再逐个探测
+  template <typename Keys, typename Fn>
+  void probe_many(const Keys& keys, Fn fn) const {
+    const key_type* batch[batch_width];
+    size_type homes[batch_width];
+    auto it = std::begin(keys);
+    auto last = std::end(keys);
+    while (it != last) {
+      size_type n = 0;
+      for (; n < batch_width && it != last; ++n, ++it) {
+        batch[n] = std::addressof(*it);
+        if (size_ == 0)
+          continue;
+        homes[n] = home(*batch[n]);
+        __builtin_prefetch(dist_ + homes[n]);
+        __builtin_prefetch(slots_ + homes[n]);
+      }
+      for (size_type i = 0; i < n; ++i)
+        fn(size_ == 0 ? npos : find_index_from(*batch[i], homes[i]));
+    }
+  }
+
+  // 从home开始沿探测序列查找key
+  size_type find_index_from(const key_type& key, size_type index) const {
+    size_type mask = capacity_ - 1;
+    for (uint16_t d = 1;; ++d, index = (index + 1) & mask) {
+      // 当前槽的元素离home更近（或者是空槽），key如果存在早就应该遇到了
+      if (dist_[index] < d)
+        return npos;
+      if (dist_[index] == d && equal_(slots_[index].first, key))
+        return index;
+    }
+  }
+
+  // key一定不存在；返回新元素最终所在的槽
+  size_type insert_new(value_type&& value) {
+    if (capacity_ == 0 || size_ + 1 > max_load(capacity_) ||
+        (grow_next_ && size_ >= capacity_ / 2))
+      resize(capacity_ ? capacity_ * 2 : min_capacity);
+    grow_next_ = false;
+
+    size_type mask = capacity_ - 1;
+    size_type index = home(value.first);
+    size_type result = npos;
+    uint16_t d = 1;
+    // 新元素先落在第一个比它“富”的槽上，被挤出来的元素带着自己的距离继续往后找
+    for (;; ++d, index = (index + 1) & mask) {
+      if (dist_[index] == 0) {
+        ::new (static_cast<void*>(slots_ + index)) value_type(std::move(value));
+        dist_[index] = d;
+        break;
+      }
+      if (dist_[index] < d) {
+        std::swap(slots_[index], value);
+        std::swap(dist_[index], d);
+        if (result == npos)
+          result = index;
+      }
+      assert(d < UINT16_MAX && "probe distance overflow, the hash function is degenerate");
+      if (d >= grow_distance)
+        grow_next_ = true;
+    }
+    ++size_;
+    return result == npos ? index : result;
+  }
+
+  // 后面离home不为0的元素依次前移一格，直到遇到空槽或者正好在home上的元素
+  void erase_at(size_type index) {
+    size_type mask = capacity_ - 1;
+    size_type next = (index + 1) & mask;
+    while (dist_[next] > 1) {
+      slots_[index] = std::move(slots_[next]);
+      dist_[index] = dist_[next] - 1;
+      index = next;
+      next = (next + 1) & mask;
+    }
+    slots_[index].~value_type();
+    dist_[index] = 0;
+    --size_;
+  }
+
+  void resize(size_type capacity) {
+    uint16_t* old_dist = dist_;
+    value_type* old_slots = slots_;
+    size_type old_capacity = capacity_;
+
+    dist_ = dist_alloc_.allocate(capacity);
+    slots_ = slot_alloc_.allocate(capacity);
+    std::memset(dist_, 0, capacity * sizeof(uint16_t));
+    capacity_ = capacity;
+    size_ = 0;
+    grow_next_ = false;
+
+    for (size_type i = 0; i < old_capacity; ++i) {
+      if (old_dist[i] == 0)
+        continue;
+      insert_new(std::move(old_slots[i]));
+      old_slots[i].~value_type();
+    }
+    deallocate(old_dist, old_slots, old_capacity);
+  }
+
+  void destroy_slots() {
+    for (size_type i = 0; i < capacity_; ++i)
+      if (dist_[i])
+        slots_[i].~value_type();
+  }
+
+  void deallocate(uint16_t* dist, value_type* slots, size_type capacity) {
+    if (capacity == 0)
+      return;
+    dist_alloc_.deallocate(dist, capacity);
+    slot_alloc_.deallocate(slots, capacity);
+  }
+};
+
+}  // namespace tiny_stl
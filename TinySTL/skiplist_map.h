@@ -0,0 +1,440 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "epoch_domain.h"
+
+namespace tiny_stl {
+
+template <typename K, typename V>
+struct skiplist_node {
+  using value_type = std::pair<const K, V>;
+  using storage_type = typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type;
+
+  storage_type storage;         // NOTE: 头结点不构造这里的值
+  std::atomic<int> owners;      // 插入者和删除者，两者都做完时结点才能回收
+  int level;
+
+  value_type& value() { return *reinterpret_cast<value_type*>(&storage); }
+  const K& key() { return value().first; }
+
+  // 后继指针的最低位是删除标记：某一层的next被标记后，这一层不会再往结点后面插入
+  // 第0层的next被标记就表示结点已被删除
+  static bool is_marked(skiplist_node* p) { return reinterpret_cast<std::uintptr_t>(p) & 1; }
+  static skiplist_node* marked(skiplist_node* p) {
+    return reinterpret_cast<skiplist_node*>(reinterpret_cast<std::uintptr_t>(p) | 1);
+  }
+  static skiplist_node* unmarked(skiplist_node* p) {
+    return reinterpret_cast<skiplist_node*>(reinterpret_cast<std::uintptr_t>(p) & ~std::uintptr_t(1));
+  }
+  bool deleted() { return is_marked(next(0).load(std::memory_order_acquire)); }
+
+  // 每层的后继指针紧跟在结点后面，和结点一起分配
+  std::atomic<skiplist_node*>* tower() {
+    return reinterpret_cast<std::atomic<skiplist_node*>*>(this + 1);
+  }
+  std::atomic<skiplist_node*>& next(int l) { return tower()[l]; }
+};
+
+// NOTE: 迭代器持有一个epoch临界区，它指向的结点在迭代器销毁前不会被回收；
+// 所以迭代器只能在创建它的线程里使用，长期持有会推迟所有epoch_domain使用者的回收
+template <typename K, typename V, typename Compare>
+struct skiplist_iterator {
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = std::pair<const K, V>;
+  using reference = const value_type&;
+  using pointer = const value_type*;
+  using difference_type = std::ptrdiff_t;
+
+  using self = skiplist_iterator<K, V, Compare>;
+  using node_type = skiplist_node<K, V>;
+  using node_ptr = node_type*;
+
+  node_ptr node_;
+  std::optional<K> upper_;  // 区间迭代的上界（不包含），按值保存，调用range时可以传临时对象
+  const Compare* comp_;
+  impl::epoch_domain::guard guard_;
+
+  skiplist_iterator(node_ptr node, std::optional<K> upper, const Compare* comp)
+      : node_(node), upper_(std::move(upper)), comp_(comp) {
+    skip_invisible();
+  }
+  skiplist_iterator(const self& other) : node_(other.node_), upper_(other.upper_), comp_(other.comp_) {}
+  self& operator=(const self& other) {
+    node_ = other.node_;
+    upper_ = other.upper_;
+    comp_ = other.comp_;
+    return *this;
+  }
+
+  reference operator*() const { return node_->value(); }
+  pointer operator->() const { return &node_->value(); }
+
+  self& operator++() {
+    node_ = node_type::unmarked(node_->next(0).load(std::memory_order_acquire));
+    skip_invisible();
+    return *this;
+  }
+
+  self operator++(int) {
+    self tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  bool operator==(const self& other) const { return node_ == other.node_; }
+  bool operator!=(const self& other) const { return node_ != other.node_; }
+
+ private:
+  // 跳过已删除还没摘掉的结点；超过上界时变成end
+  void skip_invisible() {
+    while (node_) {
+      if (upper_ && !(*comp_)(node_->key(), *upper_)) {
+        node_ = nullptr;
+        return;
+      }
+      node_ptr next = node_->next(0).load(std::memory_order_acquire);
+      if (!node_type::is_marked(next))
+        return;
+      node_ = node_type::unmarked(next);
+    }
+  }
+};
+
+// 并发有序map（跳表）
+// 插入、删除和查找都不加锁：新结点先在第0层用CAS链入，再逐层链入上层。
+// 删除先从上到下标记结点每一层的后继指针（第0层标记成功即删除完成），再由查找路径上的CAS把它从各层摘掉；
+// 插入和删除时经过已标记的结点都会顺手摘掉，读者只跳过它们，不写共享内存。
+// 摘下的结点交给epoch_domain，等所有可能拿着它的读者退出临界区后才释放。
+template <typename K, typename V, typename Compare = std::less<K>,
+          typename Alloc = std::allocator<std::pair<const K, V>>>
+class skiplist_map {
+  using node = skiplist_node<K, V>;
+  using node_ptr = node*;
+  using node_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+
+  static constexpr int max_level = 24;
+
+  // 结点回收时map可能已经析构，分配器放在单独的对象里，由map和等待回收的结点共同引用
+  struct reclaimer {
+    node_alloc_type allocator;
+    std::atomic<size_t> refs;
+
+    explicit reclaimer(const node_alloc_type& alloc) : allocator(alloc), refs(1) {}
+
+    void release() {
+      if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+    }
+  };
+
+ public:
+  using key_type = K;
+  using mapped_type = V;
+  using value_type = std::pair<const K, V>;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using allocator_type = Alloc;
+  using iterator = skiplist_iterator<K, V, Compare>;
+  using const_iterator = iterator;
+
+  // 区间[lower, upper)，可以直接用于范围for
+  struct range_type {
+    iterator first;
+    iterator last;
+    iterator begin() const { return first; }
+    iterator end() const { return last; }
+  };
+
+ private:
+  node_ptr head_;
+  std::atomic<int> level_;  // 当前最高层数，只增不减
+  alignas(64) std::atomic<size_type> size_;
+  Compare comp_;
+  reclaimer* reclaimer_;
+
+ public:
+  explicit skiplist_map(const Compare& comp = Compare(), const Alloc& alloc = Alloc())
+      : level_(1), size_(0), comp_(comp), reclaimer_(new reclaimer(node_alloc_type(alloc))) {
+    head_ = allocate_node(max_level);
+  }
+
+  skiplist_map(const skiplist_map&) = delete;
+  skiplist_map& operator=(const skiplist_map&) = delete;
+
+  // NOTE: 析构时不能再有其他线程访问；已经摘下的结点由epoch_domain释放
+  ~skiplist_map() {
+    node_ptr cur = node::unmarked(head_->next(0).load(std::memory_order_relaxed));
+    while (cur) {
+      node_ptr next = node::unmarked(cur->next(0).load(std::memory_order_relaxed));
+      cur->value().~value_type();
+      deallocate_node(cur);
+      cur = next;
+    }
+    deallocate_node(head_);
+    reclaimer_->release();
+  }
+
+  // 线程安全；key已存在时返回false，不会构造value
+  template <typename... Args>
+  bool emplace(const key_type& key, Args&&... args) {
+    impl::epoch_domain::guard guard;
+    node_ptr preds[max_level];
+    node_ptr succs[max_level];
+    node_ptr new_node = nullptr;
+    for (;;) {
+      find_position(key, preds, succs);
+      node_ptr found = succs[0];
+      if (found && !comp_(key, found->key())) {
+        if (new_node) {
+          new_node->value().~value_type();
+          deallocate_node(new_node);
+        }
+        return false;
+      }
+      if (!new_node) {
+        new_node = allocate_node(random_level());
+        ::new (static_cast<void*>(&new_node->storage))
+            value_type(std::piecewise_construct, std::forward_as_tuple(key),
+                       std::forward_as_tuple(std::forward<Args>(args)...));
+      }
+      // 还没发布，直接写好每一层的后继
+      for (int l = 0; l < new_node->level; ++l)
+        new_node->next(l).store(succs[l], std::memory_order_relaxed);
+      // 第0层链入成功即插入完成（线性化点）
+      if (preds[0]->next(0).compare_exchange_strong(succs[0], new_node, std::memory_order_release,
+                                                    std::memory_order_relaxed))
+        break;
+    }
+    size_.fetch_add(1, std::memory_order_relaxed);
+    link_upper_levels(new_node, preds, succs);
+    return true;
+  }
+
+  bool insert(const value_type& value) { return emplace(value.first, value.second); }
+
+  // 线程安全；key不存在时返回false
+  bool erase(const key_type& key) {
+    impl::epoch_domain::guard guard;
+    node_ptr preds[max_level];
+    node_ptr succs[max_level];
+    find_position(key, preds, succs);
+    node_ptr victim = succs[0];
+    if (!victim || comp_(key, victim->key()))
+      return false;
+    // 上层只是索引，先标记上层，防止删除后还有结点插到它后面
+    for (int l = victim->level - 1; l >= 1; --l) {
+      node_ptr succ = victim->next(l).load(std::memory_order_acquire);
+      while (!node::is_marked(succ) &&
+             !victim->next(l).compare_exchange_weak(succ, node::marked(succ), std::memory_order_acq_rel,
+                                                     std::memory_order_acquire))
+        ;
+    }
+    node_ptr succ = victim->next(0).load(std::memory_order_acquire);
+    for (;;) {
+      if (node::is_marked(succ))
+        return false;  // 别的线程先删除了
+      if (victim->next(0).compare_exchange_weak(succ, node::marked(succ), std::memory_order_acq_rel,
+                                                std::memory_order_acquire))
+        break;
+    }
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    find_position(key, preds, succs);  // 把结点从各层摘掉
+    release_node(victim);
+    return true;
+  }
+
+  const_iterator find(const key_type& key) const {
+    impl::epoch_domain::guard guard;
+    node_ptr found = find_node(key);
+    return found ? const_iterator(found, std::nullopt, &comp_) : end();
+  }
+
+  bool contains(const key_type& key) const {
+    impl::epoch_domain::guard guard;
+    return find_node(key) != nullptr;
+  }
+
+  size_type count(const key_type& key) const { return contains(key) ? 1 : 0; }
+
+  // 有并发写者时只是一个近似值
+  size_type size() const { return size_.load(std::memory_order_relaxed); }
+  bool empty() const { return size() == 0; }
+
+  const_iterator begin() const {
+    impl::epoch_domain::guard guard;
+    return const_iterator(node::unmarked(head_->next(0).load(std::memory_order_acquire)), std::nullopt,
+                          &comp_);
+  }
+  const_iterator end() const { return const_iterator(nullptr, std::nullopt, &comp_); }
+
+  // 第一个不小于key的元素
+  const_iterator lower_bound(const key_type& key) const {
+    impl::epoch_domain::guard guard;
+    return const_iterator(find_lower(key), std::nullopt, &comp_);
+  }
+
+  range_type range(const key_type& lower, const key_type& upper) const {
+    impl::epoch_domain::guard guard;
+    return range_type{const_iterator(find_lower(lower), upper, &comp_), end()};
+  }
+
+  allocator_type get_allocator() const { return allocator_type(reclaimer_->allocator); }
+
+ private:
+  // 每一层找到最后一个小于key的结点preds[l]和它的后继succs[l]，路上遇到已标记的结点就摘掉
+  // 返回时succs[0]要么为空，要么是第一个不小于key且没有被删除的结点；调用者必须在epoch临界区里
+  void find_position(const key_type& key, node_ptr* preds, node_ptr* succs) {
+    while (!try_find_position(key, preds, succs))
+      ;
+  }
+
+  // 摘除结点的CAS失败（前驱变了或者前驱也被删除）时返回false，从头重新找
+  bool try_find_position(const key_type& key, node_ptr* preds, node_ptr* succs) {
+    node_ptr pred = head_;
+    for (int l = max_level - 1; l >= 0; --l) {
+      node_ptr cur = node::unmarked(pred->next(l).load(std::memory_order_acquire));
+      while (cur) {
+        node_ptr succ = cur->next(l).load(std::memory_order_acquire);
+        if (node::is_marked(succ)) {
+          node_ptr expected = cur;
+          if (!pred->next(l).compare_exchange_strong(expected, node::unmarked(succ),
+                                                     std::memory_order_acq_rel,
+                                                     std::memory_order_relaxed))
+            return false;
+          cur = node::unmarked(succ);
+          continue;
+        }
+        if (!comp_(cur->key(), key))
+          break;
+        pred = cur;
+        cur = succ;
+      }
+      preds[l] = pred;
+      succs[l] = cur;
+    }
+    return true;
+  }
+
+  // 只读的查找：跳过已标记的结点，不摘除；返回第一个不小于key且没有被删除的结点
+  node_ptr find_lower(const key_type& key) const {
+    node_ptr pred = head_;
+    node_ptr cur = nullptr;
+    for (int l = level_.load(std::memory_order_acquire) - 1; l >= 0; --l) {
+      cur = node::unmarked(pred->next(l).load(std::memory_order_acquire));
+      while (cur) {
+        node_ptr succ = cur->next(l).load(std::memory_order_acquire);
+        if (node::is_marked(succ)) {
+          cur = node::unmarked(succ);
+        } else if (comp_(cur->key(), key)) {
+          pred = cur;
+          cur = succ;
+        } else {
+          break;
+        }
+      }
+    }
+    return cur;
+  }
+
+  node_ptr find_node(const key_type& key) const {
+    node_ptr cur = find_lower(key);
+    return cur && !comp_(key, cur->key()) ? cur : nullptr;
+  }
+
+  // 上层只是索引，链入失败时重新定位后重试；结点在此期间被删除时停止往上链
+  void link_upper_levels(node_ptr new_node, node_ptr* preds, node_ptr* succs) {
+    const key_type& key = new_node->key();
+    int level = new_node->level;
+    int top = level_.load(std::memory_order_relaxed);
+    while (top < level && !level_.compare_exchange_weak(top, level, std::memory_order_acq_rel))
+      ;
+    for (int l = 1; l < level; ++l) {
+      bool linked = false;
+      while (!linked) {
+        node_ptr next = new_node->next(l).load(std::memory_order_acquire);
+        if (node::is_marked(next))
+          break;
+        // 重新定位后后继可能变了；标记了就说明删除者已经开始，CAS失败后上面会看到标记
+        if (next != succs[l] &&
+            !new_node->next(l).compare_exchange_strong(next, succs[l], std::memory_order_acq_rel,
+                                                       std::memory_order_acquire))
+          continue;
+        node_ptr expected = succs[l];
+        if (preds[l]->next(l).compare_exchange_strong(expected, new_node, std::memory_order_release,
+                                                      std::memory_order_relaxed)) {
+          linked = true;
+        } else {
+          find_position(key, preds, succs);
+          if (succs[0] != new_node)
+            break;  // 已经被删除并从第0层摘掉了
+        }
+      }
+      if (!linked)
+        break;
+    }
+    // 删除者摘除时结点可能还没链入某些上层，链完之后再摘一遍
+    if (new_node->deleted())
+      find_position(key, preds, succs);
+    release_node(new_node);
+  }
+
+  // 插入者链完上层、删除者摘完之后各调用一次，最后一个把结点交给epoch_domain
+  void release_node(node_ptr n) {
+    if (n->owners.fetch_sub(1, std::memory_order_acq_rel) != 1)
+      return;
+    reclaimer_->refs.fetch_add(1, std::memory_order_relaxed);
+    impl::epoch_domain::instance().retire(n, &reclaim_node, reclaimer_);
+  }
+
+  static void reclaim_node(void* ptr, void* context) {
+    node_ptr n = static_cast<node_ptr>(ptr);
+    reclaimer* r = static_cast<reclaimer*>(context);
+    n->value().~value_type();
+    r->allocator.deallocate(n, node_units(n->level));
+    r->release();
+  }
+
+  static int random_level() {
+    // 每升一层的概率为1/4
+    thread_local uint64_t state =
+        0x9E3779B97F4A7C15ull ^ reinterpret_cast<std::uintptr_t>(&state);
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    uint64_t bits = state;
+    int level = 1;
+    while (level < max_level && (bits & 3) == 0) {
+      ++level;
+      bits >>= 2;
+    }
+    return level;
+  }
+
+  // 结点后面紧跟level个后继指针，按node的大小向上取整分配
+  static size_type node_units(int level) {
+    return 1 + (level * sizeof(std::atomic<node_ptr>) + sizeof(node) - 1) / sizeof(node);
+  }
+
+  node_ptr allocate_node(int level) {
+    node_ptr n = reclaimer_->allocator.allocate(node_units(level));
+    ::new (static_cast<void*>(&n->owners)) std::atomic<int>(2);
+    n->level = level;
+    for (int l = 0; l < level; ++l)
+      ::new (static_cast<void*>(&n->tower()[l])) std::atomic<node_ptr>(nullptr);
+    return n;
+  }
+
+  void deallocate_node(node_ptr n) { reclaimer_->allocator.deallocate(n, node_units(n->level)); }
+};
+
+}  // namespace tiny_stl
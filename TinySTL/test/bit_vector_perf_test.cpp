@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+#include "vector.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class BitVectorPerfTest : public ::testing::Test {
+protected:
+    static constexpr size_t BIT_COUNT = 1 << 24;
+
+    void SetUp() override {
+        gen = std::mt19937(42);
+        dis = std::uniform_int_distribution<size_t>(0, BIT_COUNT - 1);
+    }
+
+    template <typename Fn>
+    long long measureUs(Fn fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    void report(const char* operation, long long tiny_duration, long long std_duration) {
+        std::cout << operation << " (us): TinySTL: " << tiny_duration
+                  << " | Std: " << std_duration
+                  << " | Ratio: " << static_cast<double>(tiny_duration) / std::max(1LL, std_duration)
+                  << "\n";
+    }
+
+    std::mt19937 gen;
+    std::uniform_int_distribution<size_t> dis;
+};
+
+// 测试1: 随机置位 + popcount
+TEST_F(BitVectorPerfTest, RandomSetAndCount) {
+    std::vector<size_t> indices(BIT_COUNT / 16);
+    for (auto& index : indices) {
+        index = dis(gen);
+    }
+
+    vector<bool> tv(BIT_COUNT);
+    std::vector<bool> sv(BIT_COUNT);
+    auto tiny_set = measureUs([&]() { for (size_t i : indices) tv[i] = true; });
+    auto std_set = measureUs([&]() { for (size_t i : indices) sv[i] = true; });
+    report("Random Set", tiny_set, std_set);
+
+    size_t tiny_count = 0, std_count = 0;
+    auto tiny_duration = measureUs([&]() { tiny_count = tv.count(); });
+    auto std_duration = measureUs([&]() { std_count = std::count(sv.begin(), sv.end(), true); });
+    report("Count", tiny_duration, std_duration);
+    EXPECT_EQ(tiny_count, static_cast<size_t>(std_count));
+}
+
+// 测试2: 稀疏位图中遍历所有置位
+TEST_F(BitVectorPerfTest, SparseScan) {
+    vector<bool> tv(BIT_COUNT);
+    std::vector<bool> sv(BIT_COUNT);
+    for (size_t i = 0; i < BIT_COUNT; i += 1000) {
+        tv[i] = true;
+        sv[i] = true;
+    }
+
+    size_t tiny_sum = 0, std_sum = 0;
+    auto tiny_duration = measureUs([&]() {
+        for (size_t i = tv.find_first(); i != tv.npos; i = tv.find_next(i)) tiny_sum += i;
+    });
+    auto std_duration = measureUs([&]() {
+        for (size_t i = 0; i < sv.size(); ++i) if (sv[i]) std_sum += i;
+    });
+    report("Sparse Scan", tiny_duration, std_duration);
+    EXPECT_EQ(tiny_sum, std_sum);
+}
+
+// 测试3: 区间置位和按位或
+TEST_F(BitVectorPerfTest, RangeFillAndBulkOr) {
+    vector<bool> ta(BIT_COUNT), tb(BIT_COUNT);
+    std::vector<bool> sa(BIT_COUNT), sb(BIT_COUNT);
+
+    auto tiny_duration = measureUs([&]() { ta.set_range(3, BIT_COUNT - 3); });
+    auto std_duration = measureUs([&]() { std::fill(sa.begin() + 3, sa.end() - 3, true); });
+    report("Range Set", tiny_duration, std_duration);
+
+    tb.set_range(0, BIT_COUNT / 2);
+    std::fill(sb.begin(), sb.begin() + BIT_COUNT / 2, true);
+    tiny_duration = measureUs([&]() { ta |= tb; });
+    std_duration = measureUs([&]() {
+        for (size_t i = 0; i < sa.size(); ++i) sa[i] = sa[i] || sb[i];
+    });
+    report("Bulk Or", tiny_duration, std_duration);
+    EXPECT_EQ(ta.count(), static_cast<size_t>(std::count(sa.begin(), sa.end(), true)));
+}
+
+} // namespace test
+} // namespace tiny_stl
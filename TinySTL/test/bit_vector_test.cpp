@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "vector.h"
+#include <algorithm>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class BitVectorTest : public ::testing::Test {
+protected:
+    using bits = bit_vector<>;
+};
+
+//======================================================//
+// basic test
+//======================================================//
+TEST_F(BitVectorTest, VectorBoolIsBitPacked) {
+    vector<bool> v(1000, true);
+    EXPECT_EQ(v.size(), 1000);
+    EXPECT_EQ(v.word_count(), 16);
+    EXPECT_EQ(v.count(), 1000);
+}
+
+TEST_F(BitVectorTest, PushBackAndProxyReference) {
+    bits v;
+    for (int i = 0; i < 200; ++i) {
+        v.push_back(i % 3 == 0);
+    }
+    EXPECT_EQ(v.size(), 200);
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_EQ(v[i], i % 3 == 0);
+    }
+
+    v[1] = true;
+    v[0] = v[2];
+    EXPECT_TRUE(v[1]);
+    EXPECT_FALSE(v[0]);
+    v.flip(0);
+    EXPECT_TRUE(v.test(0));
+
+    v.pop_back();
+    EXPECT_EQ(v.size(), 199);
+    EXPECT_EQ(v.back(), 198 % 3 == 0);
+}
+
+TEST_F(BitVectorTest, IteratorWithSTLAlgorithm) {
+    bits v{true, false, true, true, false};
+    EXPECT_EQ(std::count(v.begin(), v.end(), true), 3);
+    EXPECT_EQ(v.end() - v.begin(), 5);
+    std::fill(v.begin(), v.end(), false);
+    EXPECT_TRUE(v.none());
+
+    const bits& cv = v;
+    std::vector<bool> copy(cv.begin(), cv.end());
+    EXPECT_EQ(copy.size(), 5);
+}
+
+TEST_F(BitVectorTest, CountAndFind) {
+    bits v(1000);
+    EXPECT_EQ(v.find_first(), bits::npos);
+    v.set(3);
+    v.set(64);
+    v.set(999);
+    EXPECT_EQ(v.count(), 3);
+    EXPECT_EQ(v.find_first(), 3);
+    EXPECT_EQ(v.find_next(3), 64);
+    EXPECT_EQ(v.find_next(64), 999);
+    EXPECT_EQ(v.find_next(999), bits::npos);
+}
+
+TEST_F(BitVectorTest, RangeSetReset) {
+    bits v(1000);
+    v.set_range(10, 900);
+    EXPECT_EQ(v.count(), 890);
+    EXPECT_EQ(v.find_first(), 10);
+    EXPECT_FALSE(v[900]);
+    v.reset_range(20, 30);
+    EXPECT_EQ(v.count(), 880);
+    v.set_range(5, 7);
+    EXPECT_TRUE(v[5]);
+    EXPECT_TRUE(v[6]);
+    EXPECT_FALSE(v[7]);
+}
+
+TEST_F(BitVectorTest, ResizeKeepsUnusedBitsClear) {
+    bits v(70, true);
+    v.resize(65);
+    EXPECT_EQ(v.count(), 65);
+    v.resize(200);
+    EXPECT_EQ(v.count(), 65);
+    v.resize(300, true);
+    EXPECT_EQ(v.count(), 165);
+    v.flip();
+    EXPECT_EQ(v.count(), 135);
+}
+
+TEST_F(BitVectorTest, BulkOperations) {
+    bits a(300), b(300);
+    a.set_range(0, 200);
+    b.set_range(100, 300);
+    EXPECT_EQ((a & b).count(), 100);
+    EXPECT_EQ((a | b).count(), 300);
+    EXPECT_EQ((a ^ b).count(), 200);
+
+    bits c = a;
+    EXPECT_EQ(c, a);
+    c ^= a;
+    EXPECT_TRUE(c.none());
+}
+
+} // namespace test
+} // namespace tiny_stl
@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+#include "btree_map.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class BtreeMapPerfTest : public ::testing::Test {
+protected:
+    static constexpr int SIZE = 500000;
+
+    template <typename Fn>
+    static double measure(Fn fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    static void report(const char* operation, double btree_time, double std_time) {
+        std::cout << std::setw(14) << operation << " | btree_map: " << std::setw(9) << std::fixed
+                  << std::setprecision(2) << btree_time << " ms"
+                  << " | std::map: " << std::setw(9) << std_time << " ms"
+                  << " | ratio: " << std::setprecision(2) << btree_time / std_time << "x\n";
+    }
+};
+
+TEST_F(BtreeMapPerfTest, CompareWithStdMap) {
+    std::vector<int> keys(SIZE);
+    for (int i = 0; i < SIZE; ++i) {
+        keys[i] = i;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+    std::cout << "btree_map vs std::map (" << SIZE << " int keys, " << btree_map<int, int>::node_slots
+              << " keys per node):\n";
+
+    btree_map<int, int> bm;
+    std::map<int, int> sm;
+    report("random insert", measure([&] { for (int k : keys) bm.emplace(k, k); }),
+           measure([&] { for (int k : keys) sm.emplace(k, k); }));
+
+    long long bsum = 0, ssum = 0;
+    double btree_find = measure([&] { for (int k : keys) bsum += bm.find(k)->second; });
+    double std_find = measure([&] { for (int k : keys) ssum += sm.find(k)->second; });
+    report("random find", btree_find, std_find);
+    EXPECT_EQ(bsum, ssum);
+
+    bsum = ssum = 0;
+    report("full scan", measure([&] { for (const auto& kv : bm) bsum += kv.second; }),
+           measure([&] { for (const auto& kv : sm) ssum += kv.second; }));
+    EXPECT_EQ(bsum, ssum);
+
+    report("random erase", measure([&] { for (int k : keys) bm.erase(k); }),
+           measure([&] { for (int k : keys) sm.erase(k); }));
+    EXPECT_TRUE(bm.empty());
+
+    std::vector<std::pair<int, int>> sorted;
+    for (int i = 0; i < SIZE; ++i) {
+        sorted.emplace_back(i, i);
+    }
+    report("sorted build", measure([&] { bm.bulk_load(sorted.begin(), sorted.end()); }),
+           measure([&] { sm = std::map<int, int>(sorted.begin(), sorted.end()); }));
+    EXPECT_EQ(bm.size(), sm.size());
+
+    // NOTE: 结点内是连续数组，随机查找的cache miss比红黑树少得多
+    EXPECT_LT(btree_find, std_find);
+}
+
+} // namespace test
+} // namespace tiny_stl
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include "btree_map.h"
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class BtreeMapTest : public ::testing::Test {
+protected:
+    // 遍历结果必须和std::map完全一致
+    template <typename Map, typename StdMap>
+    static void expectSameContent(const Map& m, const StdMap& expected) {
+        ASSERT_EQ(m.size(), expected.size());
+        auto it = expected.begin();
+        for (const auto& kv : m) {
+            ASSERT_NE(it, expected.end());
+            ASSERT_EQ(kv.first, it->first);
+            ASSERT_EQ(kv.second, it->second);
+            ++it;
+        }
+        EXPECT_EQ(it, expected.end());
+    }
+};
+
+//======================================================//
+// basic test
+//======================================================//
+TEST_F(BtreeMapTest, DefaultConstructor) {
+    btree_map<int, int> m;
+    EXPECT_TRUE(m.empty());
+    EXPECT_EQ(m.size(), 0);
+    EXPECT_EQ(m.begin(), m.end());
+    EXPECT_EQ(m.find(1), m.end());
+    EXPECT_EQ(m.erase(1), 0);
+}
+
+TEST_F(BtreeMapTest, InsertAndAccess) {
+    btree_map<std::string, std::string> m;
+    EXPECT_TRUE(m.emplace("b", "2").second);
+    EXPECT_TRUE(m.insert({"a", "1"}).second);
+    EXPECT_FALSE(m.emplace("b", "x").second);
+    m["c"] = "3";
+    EXPECT_EQ(m.size(), 3);
+    EXPECT_EQ(m["a"], "1");
+    EXPECT_EQ(m.at("b"), "2");
+    EXPECT_THROW(m.at("d"), std::out_of_range);
+    EXPECT_EQ(m.count("c"), 1);
+
+    std::vector<std::string> keys;
+    for (const auto& kv : m) {
+        keys.push_back(kv.first);
+    }
+    EXPECT_EQ(keys, (std::vector<std::string>{"a", "b", "c"}));
+}
+
+TEST_F(BtreeMapTest, IteratorComparesWithConstIterator) {
+    btree_map<int, int> m{{1, 10}, {2, 20}};
+    const btree_map<int, int>& cm = m;
+    EXPECT_TRUE(m.find(3) == cm.end());
+    EXPECT_TRUE(m.find(1) != cm.end());
+    EXPECT_TRUE(cm.find(2) == m.find(2));
+    EXPECT_TRUE(cm.begin() == m.begin());
+
+    // 元素的key是const的，只有value能通过迭代器修改
+    auto it = m.find(1);
+    static_assert(std::is_const<std::remove_reference_t<decltype(it->first)>>::value,
+                  "key must not be modifiable through an iterator");
+    it->second = 11;
+    EXPECT_EQ(m.at(1), 11);
+}
+
+TEST_F(BtreeMapTest, TryEmplaceDoesNotConstructOnHit) {
+    btree_map<int, std::vector<int>> m;
+    EXPECT_TRUE(m.try_emplace(1, 3, 7).second);
+    auto result = m.try_emplace(1, 100, 0);
+    EXPECT_FALSE(result.second);
+    EXPECT_EQ(result.first->second.size(), 3);
+}
+
+TEST_F(BtreeMapTest, RandomOperationsMatchStdMap) {
+    btree_map<int, int> m;
+    std::map<int, int> expected;
+    std::mt19937 rng(42);
+    for (int i = 0; i < 200000; ++i) {
+        int key = static_cast<int>(rng() % 20000);
+        if (rng() % 3 == 0) {
+            ASSERT_EQ(m.erase(key), expected.erase(key));
+        } else {
+            ASSERT_EQ(m.emplace(key, i).second, expected.emplace(key, i).second);
+        }
+    }
+    expectSameContent(m, expected);
+
+    // 删光之后树退化为一个空叶子
+    for (int key = 0; key < 20000; ++key) {
+        m.erase(key);
+    }
+    EXPECT_TRUE(m.empty());
+    EXPECT_EQ(m.begin(), m.end());
+    m[5] = 5;
+    EXPECT_EQ(m.size(), 1);
+}
+
+TEST_F(BtreeMapTest, StringKeysSplitAndMerge) {
+    // key较大时每个结点只有8个槽，分裂和合并更频繁
+    btree_map<std::string, int> m;
+    std::map<std::string, int> expected;
+    for (int i = 0; i < 5000; ++i) {
+        std::string key = "key_" + std::to_string(i * 7919 % 5000);
+        m[key] = i;
+        expected[key] = i;
+    }
+    for (int i = 0; i < 5000; i += 3) {
+        std::string key = "key_" + std::to_string(i);
+        m.erase(m.find(key));
+        expected.erase(key);
+    }
+    expectSameContent(m, expected);
+}
+
+TEST_F(BtreeMapTest, BoundsAndRangeIteration) {
+    btree_map<int, int> m;
+    for (int i = 0; i < 10000; i += 10) {
+        m[i] = i;
+    }
+    EXPECT_EQ(m.lower_bound(55)->first, 60);
+    EXPECT_EQ(m.lower_bound(60)->first, 60);
+    EXPECT_EQ(m.upper_bound(60)->first, 70);
+    EXPECT_EQ(m.lower_bound(10000), m.end());
+
+    int sum = 0;
+    for (auto it = m.lower_bound(1000); it != m.lower_bound(2000); ++it) {
+        sum += it->first;
+    }
+    EXPECT_EQ(sum, (1000 + 1990) * 100 / 2);
+}
+
+TEST_F(BtreeMapTest, BulkLoadFromSortedInput) {
+    std::vector<std::pair<int, int>> sorted;
+    for (int i = 0; i < 100000; ++i) {
+        sorted.emplace_back(i * 2, i);
+    }
+    btree_map<int, int> m;
+    m.bulk_load(sorted.begin(), sorted.end());
+    EXPECT_EQ(m.size(), sorted.size());
+    EXPECT_EQ(m.find(2 * 777)->second, 777);
+    EXPECT_EQ(m.find(3), m.end());
+
+    // 批量构建后的树可以继续插入和删除
+    std::map<int, int> expected(sorted.begin(), sorted.end());
+    for (int i = 1; i < 20000; i += 2) {
+        m[i] = -i;
+        expected[i] = -i;
+    }
+    for (int i = 0; i < 200000; i += 6) {
+        m.erase(i);
+        expected.erase(i);
+    }
+    expectSameContent(m, expected);
+
+    btree_map<int, int> copy(m);
+    expectSameContent(copy, expected);
+    btree_map<int, int> moved(std::move(copy));
+    EXPECT_TRUE(copy.empty());
+    expectSameContent(moved, expected);
+}
+
+} // namespace test
+} // namespace tiny_stl
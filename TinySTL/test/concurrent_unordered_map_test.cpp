@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "concurrent_unordered_map.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class ConcurrentUnorderedMapTest : public ::testing::Test {
+protected:
+    static constexpr int THREAD_COUNT = 4;
+    static constexpr int PER_THREAD = 20000;
+
+    template <typename Fn>
+    static void runThreads(Fn fn) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREAD_COUNT; ++t) {
+            threads.emplace_back(fn, t);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+};
+
+//======================================================//
+// basic test
+//======================================================//
+TEST_F(ConcurrentUnorderedMapTest, DefaultConstructor) {
+    concurrent_unordered_map<int, int> m;
+    EXPECT_TRUE(m.empty());
+    EXPECT_EQ(m.size(), 0);
+    EXPECT_GE(m.shard_count(), 2);
+    EXPECT_EQ(m.shard_count() & (m.shard_count() - 1), 0u);
+    EXPECT_FALSE(m.contains(1));
+    EXPECT_EQ(m.erase(1), 0);
+}
+
+TEST_F(ConcurrentUnorderedMapTest, InsertVisitUpdateErase) {
+    concurrent_unordered_map<std::string, std::string> m(5);
+    EXPECT_EQ(m.shard_count(), 8);
+    EXPECT_TRUE(m.emplace("a", "1"));
+    EXPECT_TRUE(m.insert({"b", "2"}));
+    EXPECT_FALSE(m.emplace("a", "x"));
+    EXPECT_EQ(m.size(), 2);
+
+    std::string seen;
+    EXPECT_TRUE(m.visit("a", [&](const std::pair<std::string, std::string>& kv) { seen = kv.second; }));
+    EXPECT_EQ(seen, "1");
+    EXPECT_FALSE(m.visit("c", [&](const std::pair<std::string, std::string>&) { FAIL(); }));
+
+    EXPECT_TRUE(m.update("b", [](std::string& value) { value += "!"; }));
+    EXPECT_FALSE(m.update("c", [](std::string&) { FAIL(); }));
+    m.visit("b", [&](const std::pair<std::string, std::string>& kv) { seen = kv.second; });
+    EXPECT_EQ(seen, "2!");
+
+    EXPECT_FALSE(m.insert_or_assign("a", "3"));
+    EXPECT_TRUE(m.insert_or_assign("c", "4"));
+    m.visit("a", [&](const std::pair<std::string, std::string>& kv) { seen = kv.second; });
+    EXPECT_EQ(seen, "3");
+
+    EXPECT_EQ(m.erase("a"), 1);
+    EXPECT_EQ(m.count("a"), 0);
+    m.clear();
+    EXPECT_TRUE(m.empty());
+}
+
+TEST_F(ConcurrentUnorderedMapTest, TryEmplaceOrUpdateDoesNotMoveOnHit) {
+    concurrent_unordered_map<int, std::unique_ptr<int>> m;
+    EXPECT_TRUE(m.try_emplace_or_update(1, [](std::unique_ptr<int>&) { FAIL(); }, std::make_unique<int>(1)));
+    auto value = std::make_unique<int>(2);
+    int seen = 0;
+    EXPECT_FALSE(m.try_emplace_or_update(1, [&](std::unique_ptr<int>& v) { seen = *v; }, std::move(value)));
+    EXPECT_EQ(seen, 1);
+    ASSERT_NE(value, nullptr);
+}
+
+//======================================================//
+// concurrency test
+//======================================================//
+TEST_F(ConcurrentUnorderedMapTest, ConcurrentCounting) {
+    // 所有线程对同一组key计数，每个key的结果必须等于线程数
+    concurrent_unordered_map<int, int> m(4);
+    m.set_incremental_rehash(true);
+    runThreads([&](int) {
+        for (int i = 0; i < PER_THREAD; ++i) {
+            m.try_emplace_or_update(i, [](int& count) { ++count; }, 1);
+        }
+    });
+    EXPECT_EQ(m.size(), static_cast<size_t>(PER_THREAD));
+    for (int i = 0; i < PER_THREAD; ++i) {
+        int count = 0;
+        ASSERT_TRUE(m.visit(i, [&](const std::pair<int, int>& kv) { count = kv.second; }));
+        ASSERT_EQ(count, THREAD_COUNT);
+    }
+}
+
+TEST_F(ConcurrentUnorderedMapTest, ConcurrentInsertEraseAndRead) {
+    // 每个线程写自己的key区间，同时读其他线程的区间
+    concurrent_unordered_map<int, int> m;
+    std::atomic<int> bad_values{0};
+    runThreads([&](int t) {
+        int base = t * PER_THREAD;
+        for (int i = 0; i < PER_THREAD; ++i) {
+            m.emplace(base + i, base + i);
+            int other = ((t + 1) % THREAD_COUNT) * PER_THREAD + i;
+            m.visit(other, [&](const std::pair<int, int>& kv) {
+                if (kv.first != kv.second)
+                    ++bad_values;
+            });
+            if (i % 2 == 1)
+                m.erase(base + i - 1);
+        }
+    });
+    EXPECT_EQ(bad_values.load(), 0);
+    EXPECT_EQ(m.size(), static_cast<size_t>(THREAD_COUNT * PER_THREAD / 2));
+    for (int i = 0; i < THREAD_COUNT * PER_THREAD; ++i) {
+        ASSERT_EQ(m.contains(i), i % 2 == 1);
+    }
+}
+
+} // namespace test
+} // namespace tiny_stl
@@ -0,0 +1,71 @@
+#include "gtest/gtest.h"
+#include "concurrent_vector.h"
+#include "vector.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class ConcurrentVectorPerfTest : public ::testing::Test {
+protected:
+    static constexpr size_t TOTAL_APPENDS = 2000000;
+
+    static size_t max_threads() {
+        return std::max<size_t>(2, std::min<size_t>(8, std::thread::hardware_concurrency()));
+    }
+
+    // 用thread_count个线程一共追加TOTAL_APPENDS个元素，返回耗时(ms)
+    template <typename AppendFn>
+    double measureAppend(size_t thread_count, AppendFn append) {
+        std::vector<std::thread> threads;
+        size_t per_thread = TOTAL_APPENDS / thread_count;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&append, per_thread, t]() {
+                for (size_t i = 0; i < per_thread; ++i) {
+                    append(static_cast<int>(t * per_thread + i));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    }
+};
+
+// 测试1: 1..N个线程并发追加的吞吐
+TEST_F(ConcurrentVectorPerfTest, AppendThroughput) {
+    std::cout << "Concurrent Append Throughput (" << TOTAL_APPENDS << " appends):\n";
+    for (size_t threads = 1; threads <= max_threads(); threads *= 2) {
+        concurrent_vector<int> cv;
+        double concurrent_time = measureAppend(threads, [&cv](int value) {
+            cv.push_back(value);
+        });
+
+        tiny_stl::vector<int> mv;
+        std::mutex mutex;
+        double mutex_time = measureAppend(threads, [&mv, &mutex](int value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            mv.push_back(value);
+        });
+
+        EXPECT_EQ(cv.size(), mv.size());
+        std::cout << "threads: " << std::setw(2) << threads
+                  << " | concurrent_vector: " << std::setw(8) << std::fixed
+                  << std::setprecision(2) << concurrent_time << " ms"
+                  << " | mutex + vector: " << std::setw(8) << mutex_time << " ms"
+                  << " | Mops/s: " << std::setw(7) << TOTAL_APPENDS / concurrent_time / 1e3
+                  << " vs " << std::setw(7) << TOTAL_APPENDS / mutex_time / 1e3 << "\n";
+    }
+}
+
+} // namespace test
+} // namespace tiny_stl
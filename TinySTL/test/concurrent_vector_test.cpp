@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "concurrent_vector.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class ConcurrentVectorTest : public ::testing::Test {
+protected:
+    static constexpr int THREAD_COUNT = 4;
+    static constexpr int PER_THREAD = 20000;
+};
+
+//======================================================//
+// basic test
+//======================================================//
+TEST_F(ConcurrentVectorTest, DefaultConstructor) {
+    concurrent_vector<int> v;
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(v.size(), 0);
+    EXPECT_EQ(v.begin(), v.end());
+}
+
+TEST_F(ConcurrentVectorTest, PushBackAndIndex) {
+    concurrent_vector<std::string> v;
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(v.push_back(std::to_string(i)), static_cast<size_t>(i));
+    }
+    EXPECT_EQ(v.size(), 1000);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(v[i], std::to_string(i));
+    }
+}
+
+TEST_F(ConcurrentVectorTest, GrowthNeverMovesElements) {
+    concurrent_vector<int> v;
+    v.push_back(0);
+    const int* first = &v[0];
+    for (int i = 1; i < 100000; ++i) {
+        v.push_back(i);
+    }
+    EXPECT_EQ(first, &v[0]);
+    EXPECT_EQ(*first, 0);
+}
+
+TEST_F(ConcurrentVectorTest, ConcurrentPushBack) {
+    concurrent_vector<int> v;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < THREAD_COUNT; ++t) {
+        writers.emplace_back([&v, t]() {
+            for (int i = 0; i < PER_THREAD; ++i) {
+                v.push_back(t * PER_THREAD + i);
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    ASSERT_EQ(v.size(), static_cast<size_t>(THREAD_COUNT * PER_THREAD));
+    std::vector<int> values(v.begin(), v.end());
+    std::sort(values.begin(), values.end());
+    for (int i = 0; i < THREAD_COUNT * PER_THREAD; ++i) {
+        ASSERT_EQ(values[i], i);
+    }
+}
+
+TEST_F(ConcurrentVectorTest, IterateWhileAppending) {
+    concurrent_vector<std::unique_ptr<int>> v;
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        for (int i = 0; i < PER_THREAD; ++i) {
+            v.push_back(std::make_unique<int>(i));
+        }
+        done = true;
+    });
+
+    // 读者只会看到已经发布的元素
+    while (!done) {
+        for (const auto& value : v) {
+            ASSERT_NE(value, nullptr);
+            ASSERT_GE(*value, 0);
+        }
+    }
+    writer.join();
+    EXPECT_EQ(std::distance(v.begin(), v.end()), PER_THREAD);
+}
+
+TEST_F(ConcurrentVectorTest, BeginSnapshotOlderThanEnd) {
+    concurrent_vector<int> v;
+    for (int i = 0; i < 5; ++i) {
+        v.push_back(i);
+    }
+    // 范围for先取begin再取end，中间追加的元素不在begin的快照里
+    auto first = v.begin();
+    for (int i = 5; i < 20; ++i) {
+        v.push_back(i);
+    }
+    auto last = v.end();
+    int count = 0;
+    for (auto it = first; it != last; ++it) {
+        ASSERT_EQ(*it, count);
+        ++count;
+    }
+    EXPECT_EQ(count, 5);
+}
+
+TEST_F(ConcurrentVectorTest, ClearDestroysElements) {
+    auto counter = std::make_shared<int>(0);
+    concurrent_vector<std::shared_ptr<int>> v;
+    for (int i = 0; i < 100; ++i) {
+        v.push_back(counter);
+    }
+    EXPECT_EQ(counter.use_count(), 101);
+    v.clear();
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(counter.use_count(), 1);
+}
+
+} // namespace test
+} // namespace tiny_stl
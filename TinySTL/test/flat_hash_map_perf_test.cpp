@@ -0,0 +1,100 @@
+#include "gtest/gtest.h"
+#include "flat_hash_map.h"
+#include "unordered_map.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class FlatHashMapPerfTest : public ::testing::Test {
+protected:
+    static constexpr int SIZE = 1000000;
+
+    template <typename Fn>
+    static double measure(Fn fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    static void report(const char* operation, double flat_time, double tiny_time, double std_time) {
+        std::cout << std::setw(12) << operation << " | flat_hash_map: " << std::setw(8) << std::fixed
+                  << std::setprecision(2) << flat_time << " ms"
+                  << " | unordered_map: " << std::setw(8) << tiny_time << " ms"
+                  << " | std::unordered_map: " << std::setw(8) << std_time << " ms\n";
+    }
+
+    // 三种map执行同样的插入、命中查找、未命中查找和删除，返回flat_hash_map和unordered_map插入的耗时比
+    template <typename Key>
+    static double compare(const std::vector<Key>& keys, const std::vector<Key>& misses) {
+        flat_hash_map<Key, int> fm;
+        unordered_map<Key, int> tm;
+        std::unordered_map<Key, int> sm;
+        int n = static_cast<int>(keys.size());
+
+        double flat_insert = measure([&] { for (int i = 0; i < n; ++i) fm.emplace(keys[i], i); });
+        double tiny_insert = measure([&] { for (int i = 0; i < n; ++i) tm.emplace(keys[i], i); });
+        double std_insert = measure([&] { for (int i = 0; i < n; ++i) sm.emplace(keys[i], i); });
+        report("insert", flat_insert, tiny_insert, std_insert);
+
+        long long fsum = 0, tsum = 0, ssum = 0;
+        double flat_find = measure([&] { for (const Key& k : keys) fsum += fm.find(k)->second; });
+        double tiny_find = measure([&] { for (const Key& k : keys) tsum += tm.find(k)->second; });
+        double std_find = measure([&] { for (const Key& k : keys) ssum += sm.find(k)->second; });
+        report("find hit", flat_find, tiny_find, std_find);
+        EXPECT_EQ(fsum, ssum);
+        EXPECT_EQ(tsum, ssum);
+
+        size_t fhit = 0, thit = 0, shit = 0;
+        report("find miss", measure([&] { for (const Key& k : misses) fhit += fm.count(k); }),
+               measure([&] { for (const Key& k : misses) thit += tm.count(k); }),
+               measure([&] { for (const Key& k : misses) shit += sm.count(k); }));
+        EXPECT_EQ(fhit, 0u);
+        EXPECT_EQ(thit, 0u);
+        EXPECT_EQ(shit, 0u);
+
+        report("erase", measure([&] { for (const Key& k : keys) fm.erase(k); }),
+               measure([&] { for (const Key& k : keys) tm.erase(k); }),
+               measure([&] { for (const Key& k : keys) sm.erase(k); }));
+        EXPECT_TRUE(fm.empty());
+        EXPECT_TRUE(tm.empty());
+        return flat_insert / tiny_insert;
+    }
+};
+
+TEST_F(FlatHashMapPerfTest, IntKeys) {
+    std::vector<int> keys(SIZE), misses(SIZE);
+    std::mt19937 rng(5);
+    for (int i = 0; i < SIZE; ++i) {
+        keys[i] = static_cast<int>(rng() >> 1) | 1;
+        misses[i] = static_cast<int>(rng() >> 1) & ~1;
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    std::shuffle(keys.begin(), keys.end(), rng);
+    std::cout << "Hash maps (" << keys.size() << " random int keys):\n";
+    // 元素就地存放，插入不需要为每个元素分配结点
+    EXPECT_LT(compare(keys, misses), 1.0);
+}
+
+TEST_F(FlatHashMapPerfTest, StringKeys) {
+    std::vector<std::string> keys, misses;
+    for (int i = 0; i < SIZE / 4; ++i) {
+        keys.push_back("key_" + std::to_string(i * 2));
+        misses.push_back("key_" + std::to_string(i * 2 + 1));
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(5));
+    std::cout << "Hash maps (" << keys.size() << " string keys):\n";
+    compare(keys, misses);
+}
+
+} // namespace test
+} // namespace tiny_stl
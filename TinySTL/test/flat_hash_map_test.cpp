@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include "flat_hash_map.h"
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class FlatHashMapTest : public ::testing::Test {
+protected:
+    // 内容必须和std::unordered_map完全一致
+    template <typename Map, typename StdMap>
+    static void expectSameContent(const Map& m, const StdMap& expected) {
+        ASSERT_EQ(m.size(), expected.size());
+        size_t visited = 0;
+        for (const auto& kv : m) {
+            auto it = expected.find(kv.first);
+            ASSERT_NE(it, expected.end());
+            ASSERT_EQ(kv.second, it->second);
+            ++visited;
+        }
+        EXPECT_EQ(visited, expected.size());
+    }
+
+    // 所有key都落在同一组里，用来制造墓碑
+    struct ConstantHash {
+        size_t operator()(int) const { return 42; }
+    };
+};
+
+//======================================================//
+// basic test
+//======================================================//
+TEST_F(FlatHashMapTest, DefaultConstructor) {
+    flat_hash_map<int, int> m;
+    EXPECT_TRUE(m.empty());
+    EXPECT_EQ(m.size(), 0);
+    EXPECT_EQ(m.bucket_count(), 0);
+    EXPECT_EQ(m.begin(), m.end());
+    EXPECT_EQ(m.find(1), m.end());
+    EXPECT_EQ(m.erase(1), 0);
+}
+
+TEST_F(FlatHashMapTest, InsertAndAccess) {
+    flat_hash_map<std::string, std::string> m;
+    EXPECT_TRUE(m.emplace("b", "2").second);
+    EXPECT_TRUE(m.insert({"a", "1"}).second);
+    EXPECT_FALSE(m.emplace("b", "x").second);
+    m["c"] = "3";
+    EXPECT_EQ(m.size(), 3);
+    EXPECT_EQ(m["a"], "1");
+    EXPECT_EQ(m.at("b"), "2");
+    EXPECT_THROW(m.at("d"), std::out_of_range);
+    EXPECT_EQ(m.count("c"), 1);
+    EXPECT_TRUE(m.contains("a"));
+    EXPECT_FALSE(m.contains("d"));
+}
+
+TEST_F(FlatHashMapTest, TryEmplaceDoesNotConstructOnHit) {
+    flat_hash_map<int, std::unique_ptr<int>> m;
+    auto value = std::make_unique<int>(1);
+    EXPECT_TRUE(m.try_emplace(1, std::move(value)).second);
+    auto other = std::make_unique<int>(2);
+    EXPECT_FALSE(m.try_emplace(1, std::move(other)).second);
+    ASSERT_NE(other, nullptr);
+    EXPECT_EQ(*m[1], 1);
+}
+
+TEST_F(FlatHashMapTest, GrowsBelowMaxLoadFactor) {
+    flat_hash_map<int, int> m;
+    for (int i = 0; i < 10000; ++i) {
+        m.emplace(i, i * 3);
+        ASSERT_LE(m.load_factor(), m.max_load_factor());
+    }
+    EXPECT_EQ(m.size(), 10000);
+    EXPECT_EQ(m.bucket_count() & (m.bucket_count() - 1), 0u);
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_EQ(m.at(i), i * 3);
+    }
+    EXPECT_EQ(m.find(10000), m.end());
+}
+
+TEST_F(FlatHashMapTest, EraseLeavesTombstonesInFullGroups) {
+    flat_hash_map<int, int, ConstantHash> m;
+    m.reserve(100);
+    size_t buckets = m.bucket_count();
+    // 所有key在同一个探测序列上，删除前面的key之后后面的key必须仍然可以找到
+    for (int i = 0; i < 40; ++i) {
+        m.emplace(i, i);
+    }
+    for (int i = 0; i < 40; i += 2) {
+        EXPECT_EQ(m.erase(i), 1);
+    }
+    for (int i = 1; i < 40; i += 2) {
+        ASSERT_EQ(m.at(i), i);
+    }
+    for (int i = 0; i < 40; i += 2) {
+        EXPECT_EQ(m.count(i), 0);
+    }
+    // 墓碑被重新利用，不会触发扩容
+    for (int round = 0; round < 100; ++round) {
+        m.emplace(1000 + round, round);
+        m.erase(1000 + round);
+    }
+    EXPECT_EQ(m.size(), 20);
+    EXPECT_EQ(m.bucket_count(), buckets);
+}
+
+TEST_F(FlatHashMapTest, RandomOperationsMatchStd) {
+    flat_hash_map<int, int> m;
+    std::unordered_map<int, int> expected;
+    std::mt19937 rng(11);
+    for (int i = 0; i < 200000; ++i) {
+        int key = static_cast<int>(rng() % 5000);
+        switch (rng() % 4) {
+        case 0:
+        case 1:
+            m[key] = i;
+            expected[key] = i;
+            break;
+        case 2:
+            ASSERT_EQ(m.erase(key), expected.erase(key));
+            break;
+        default:
+            ASSERT_EQ(m.count(key), expected.count(key));
+            break;
+        }
+    }
+    expectSameContent(m, expected);
+
+    // 通过迭代器删除一半
+    for (auto it = m.begin(); it != m.end(); ++it) {
+        if (it->first % 2 == 0) {
+            expected.erase(it->first);
+            m.erase(it);
+        }
+    }
+    expectSameContent(m, expected);
+}
+
+TEST_F(FlatHashMapTest, CopyMoveAndClear) {
+    flat_hash_map<std::string, int> m{{"a", 1}, {"b", 2}, {"c", 3}};
+    flat_hash_map<std::string, int> copy(m);
+    EXPECT_EQ(copy.size(), 3);
+    EXPECT_EQ(copy["b"], 2);
+
+    flat_hash_map<std::string, int> moved(std::move(copy));
+    EXPECT_EQ(moved.size(), 3);
+    EXPECT_TRUE(copy.empty());
+
+    copy = moved;
+    EXPECT_EQ(copy.at("c"), 3);
+
+    size_t buckets = m.bucket_count();
+    m.clear();
+    EXPECT_TRUE(m.empty());
+    EXPECT_EQ(m.begin(), m.end());
+    EXPECT_EQ(m.bucket_count(), buckets);
+    m["d"] = 4;
+    EXPECT_EQ(m.size(), 1);
+
+    const flat_hash_map<std::string, int>& cm = moved;
+    int sum = 0;
+    for (flat_hash_map<std::string, int>::const_iterator it = cm.begin(); it != cm.end(); ++it) {
+        sum += it->second;
+    }
+    EXPECT_EQ(sum, 6);
+}
+
+TEST_F(FlatHashMapTest, RehashAndReserve) {
+    flat_hash_map<int, int> m;
+    m.reserve(1000);
+    size_t buckets = m.bucket_count();
+    EXPECT_GE(buckets * 7 / 8, 1000);
+    for (int i = 0; i < 1000; ++i) {
+        m.emplace(i, i);
+    }
+    EXPECT_EQ(m.bucket_count(), buckets);
+
+    m.rehash(buckets * 4);
+    EXPECT_GE(m.bucket_count(), buckets * 4);
+    m.rehash(0);
+    EXPECT_EQ(m.bucket_count(), buckets);
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(m.at(i), i);
+    }
+}
+
+TEST_F(FlatHashMapTest, FindManyMatchesFind) {
+    flat_hash_map<int, int> m;
+    std::vector<int> keys{1, 2, 3};
+    std::vector<bool> found;
+    m.contains_many(keys, std::back_inserter(found));
+    EXPECT_EQ(found, std::vector<bool>(3, false));
+
+    for (int i = 0; i < 5000; i += 2) {
+        m.emplace(i, i * 3);
+    }
+    // 1001个key不是批大小的整数倍，最后一组不满
+    keys.clear();
+    for (int i = 0; i < 1001; ++i) {
+        keys.push_back((i * 7919) % 6000);
+    }
+    std::vector<flat_hash_map<int, int>::iterator> results(keys.size(), m.end());
+    EXPECT_EQ(m.find_many(keys, results.begin()), results.end());
+    found.clear();
+    m.contains_many(keys, std::back_inserter(found));
+    ASSERT_EQ(found.size(), keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        ASSERT_EQ(results[i], m.find(keys[i])) << keys[i];
+        ASSERT_EQ(found[i], m.count(keys[i]) == 1) << keys[i];
+        if (results[i] != m.end()) {
+            EXPECT_EQ(results[i]->second, keys[i] * 3);
+        }
+    }
+}
+
+} // namespace test
+} // namespace tiny_stl
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "intrusive_list.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class IntrusiveListTest : public ::testing::Test {
+protected:
+    struct Item {
+        int value;
+        std::string name;
+        intrusive_list_hook hook;
+        intrusive_list_hook lru_hook;
+
+        explicit Item(int v) : value(v), name(std::to_string(v)) {}
+    };
+
+    using ItemList = intrusive_list<Item, &Item::hook>;
+    using LruList = intrusive_list<Item, &Item::lru_hook>;
+
+    static std::vector<int> values(const ItemList& l) {
+        std::vector<int> result;
+        for (const auto& item : l) {
+            result.push_back(item.value);
+        }
+        return result;
+    }
+};
+
+TEST_F(IntrusiveListTest, PushAndIterate) {
+    Item a(1), b(2), c(3);
+    ItemList l;
+    EXPECT_TRUE(l.empty());
+    l.push_back(b);
+    l.push_back(c);
+    l.push_front(a);
+    EXPECT_EQ(l.size(), 3);
+    EXPECT_EQ(values(l), (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(&l.front(), &a);
+    EXPECT_EQ(&l.back(), &c);
+    EXPECT_EQ(l.rbegin()->value, 3);
+    EXPECT_TRUE(b.hook.is_linked());
+}
+
+TEST_F(IntrusiveListTest, RemoveByObject) {
+    Item a(1), b(2), c(3);
+    ItemList l;
+    l.push_back(a);
+    l.push_back(b);
+    l.push_back(c);
+    l.remove(b);
+    EXPECT_FALSE(b.hook.is_linked());
+    EXPECT_EQ(values(l), (std::vector<int>{1, 3}));
+    auto it = l.erase(l.iterator_to(a));
+    EXPECT_EQ(&*it, &c);
+    l.pop_back();
+    EXPECT_TRUE(l.empty());
+}
+
+TEST_F(IntrusiveListTest, AutoUnlinkOnDestruction) {
+    Item a(1);
+    ItemList l;
+    l.push_back(a);
+    {
+        Item b(2);
+        l.push_back(b);
+        EXPECT_EQ(l.size(), 2);
+    }
+    EXPECT_EQ(values(l), (std::vector<int>{1}));
+
+    // 链表先析构，元素上的钩子被重置
+    {
+        ItemList tmp;
+        tmp.push_back(*std::make_unique<Item>(0));  // 临时对象析构时自动摘除
+        EXPECT_TRUE(tmp.empty());
+        l.clear();
+        tmp.push_back(a);
+    }
+    EXPECT_FALSE(a.hook.is_linked());
+}
+
+TEST_F(IntrusiveListTest, ElementInTwoLists) {
+    std::vector<std::unique_ptr<Item>> items;
+    ItemList l;
+    LruList lru;
+    for (int i = 0; i < 5; ++i) {
+        items.push_back(std::make_unique<Item>(i));
+        l.push_back(*items.back());
+        lru.push_front(*items.back());
+    }
+    lru.move_to_front(*items[2]);
+    EXPECT_EQ(lru.front().value, 2);
+    EXPECT_EQ(lru.back().value, 0);
+    lru.move_to_back(*items[2]);
+    EXPECT_EQ(lru.back().value, 2);
+    EXPECT_EQ(values(l), (std::vector<int>{0, 1, 2, 3, 4}));
+
+    // 删除元素时同时从两个链表上摘下来
+    items.erase(items.begin() + 1);
+    EXPECT_EQ(l.size(), 4);
+    EXPECT_EQ(lru.size(), 4);
+}
+
+TEST_F(IntrusiveListTest, CopyDoesNotCopyLinks) {
+    Item a(1);
+    ItemList l;
+    l.push_back(a);
+    Item b = a;
+    EXPECT_FALSE(b.hook.is_linked());
+    b = a;
+    EXPECT_FALSE(b.hook.is_linked());
+    EXPECT_EQ(l.size(), 1);
+}
+
+TEST_F(IntrusiveListTest, SpliceAndMove) {
+    Item a(1), b(2), c(3), d(4);
+    ItemList l1, l2;
+    l1.push_back(a);
+    l1.push_back(b);
+    l2.push_back(c);
+    l2.push_back(d);
+    l1.splice(l1.begin(), l2);
+    EXPECT_TRUE(l2.empty());
+    EXPECT_EQ(values(l1), (std::vector<int>{3, 4, 1, 2}));
+
+    l2.splice(l2.end(), l1, std::next(l1.begin()), l1.end());
+    EXPECT_EQ(values(l1), (std::vector<int>{3}));
+    EXPECT_EQ(values(l2), (std::vector<int>{4, 1, 2}));
+
+    ItemList l3(std::move(l2));
+    EXPECT_TRUE(l2.empty());
+    EXPECT_EQ(values(l3), (std::vector<int>{4, 1, 2}));
+
+    l1.swap(l3);
+    EXPECT_EQ(values(l1), (std::vector<int>{4, 1, 2}));
+    EXPECT_EQ(values(l3), (std::vector<int>{3}));
+}
+
+#ifndef NDEBUG
+TEST_F(IntrusiveListTest, SafeModeChecks) {
+    Item a(1);
+    ItemList l;
+    l.push_back(a);
+    EXPECT_DEATH(l.push_back(a), "already in a list");
+    Item b(2);
+    EXPECT_DEATH(l.remove(b), "not in a list");
+}
+#endif
+
+} // namespace test
+} // namespace tiny_stl
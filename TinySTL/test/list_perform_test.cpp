@@ -11,6 +11,9 @@
 #include <iomanip>
 
 #include "list.h"
+#include "unrolled_list.h"
+#include "intrusive_list.h"
+#include "trace.h"
 #include <gtest/gtest.h>
 
 namespace tiny_stl {
@@ -53,7 +56,17 @@ protected:
     static constexpr int SMALL_SIZE = 1000;
     static constexpr int MEDIUM_SIZE = 10000;
     static constexpr int LARGE_SIZE = 100000;
+    static constexpr int SORT_SIZE = 1000000;
     static constexpr double PERFORMANCE_THRESHOLD = 2.0; // tinystl允许比std慢的最大倍数
+    static constexpr double UNROLLED_MIDDLE_INSERT_THRESHOLD = 4.0; // unrolled_list中间插入预期慢约2倍
+
+#ifdef TINY_STL_ENABLE_TRACE
+    // measure*是一个区间，tiny_stl::list内部的结点分配/释放事件嵌套在其中
+    static void TearDownTestSuite() {
+        tiny_stl::trace::dump_chrome_trace("list_perf_trace.json");
+        tiny_stl::trace::clear();
+    }
+#endif
     
     // 自动选择合适的时间单位显示
     std::string formatDuration(double seconds) {
@@ -71,14 +84,15 @@ protected:
     // 比较性能并输出结果
     void comparePerformance(const std::string& operation, 
                           double tiny_time, 
-                          double std_time) {
+                          double std_time,
+                          double threshold = PERFORMANCE_THRESHOLD) {
         std::cout << operation 
                   << " | tiny_stl: " << std::setw(12) << formatDuration(tiny_time)
                   << " | std: " << std::setw(12) << formatDuration(std_time)
                   << " | ratio: " << std::setw(6) << std::fixed << std::setprecision(2) 
                   << (tiny_time / std_time) << "x";
         
-        if (tiny_time > std_time * PERFORMANCE_THRESHOLD) {
+        if (tiny_time > std_time * threshold) {
             std::cout << " [FAIL]";
             ADD_FAILURE() << operation << " performance too slow: " 
                          << (tiny_time / std_time) << "x slower than std";
@@ -88,6 +102,7 @@ protected:
     
     template<typename ListType>
     double measureInsertPerformance(ListType& list, const std::string& position) {
+        TINY_STL_TRACE_SCOPE("ListPerformanceTest::insert", list.size());
         auto start = std::chrono::high_resolution_clock::now();
         
         if (position == "front") {
@@ -116,6 +131,7 @@ protected:
     
     template<typename ListType>
     double measureErasePerformance(ListType& list, const std::string& position) {
+        TINY_STL_TRACE_SCOPE("ListPerformanceTest::erase", list.size());
         auto start = std::chrono::high_resolution_clock::now();
         
         if (position == "front") {
@@ -142,6 +158,7 @@ protected:
     
     template<typename ListType>
     double measureIterationPerformance(ListType& list, bool reverse = false) {
+        TINY_STL_TRACE_SCOPE("ListPerformanceTest::iterate", list.size());
         auto start = std::chrono::high_resolution_clock::now();
         int sum = 0;
         
@@ -161,8 +178,18 @@ protected:
         return std::chrono::duration<double>(end - start).count();
     }
     
+    template<typename ListType>
+    double measureSortPerformance(ListType& list) {
+        TINY_STL_TRACE_SCOPE("ListPerformanceTest::sort", list.size());
+        auto start = std::chrono::high_resolution_clock::now();
+        list.sort();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    }
+
     template<typename ListType>
     double measureMergePerformance(ListType& list1, ListType& list2) {
+        TINY_STL_TRACE_SCOPE("ListPerformanceTest::merge", list1.size());
         auto start = std::chrono::high_resolution_clock::now();
         list1.merge(list2);
         auto end = std::chrono::high_resolution_clock::now();
@@ -263,6 +290,18 @@ TEST_F(ListPerformanceTest, IterationPerformanceComparison) {
     tiny_time = measureIterationPerformance(tiny_list, true);
     std_time = measureIterationPerformance(std_list, true);
     comparePerformance("Reverse Iteration", tiny_time, std_time);
+
+    // 区间insert整块分配结点，遍历时结点在内存中是连续的
+    std::vector<TestData> source;
+    for (int i = 0; i < LARGE_SIZE; ++i) {
+        source.emplace_back(100, "to_iterate", i);
+    }
+    tiny_stl::list<TestData> bulk_list;
+    bulk_list.insert(bulk_list.end(), std::make_move_iterator(source.begin()),
+                     std::make_move_iterator(source.end()));
+    double bulk_time = measureIterationPerformance(bulk_list);
+    std_time = measureIterationPerformance(std_list);
+    comparePerformance("Forward Iteration (bulk nodes)", bulk_time, std_time);
 }
 
 TEST_F(ListPerformanceTest, MergePerformanceComparison) {
@@ -295,5 +334,304 @@ TEST_F(ListPerformanceTest, MergePerformanceComparison) {
     EXPECT_TRUE(tiny_list2.empty());
 }
 
+TEST_F(ListPerformanceTest, UnrolledListTraversalComparison) {
+    std::cout << "\n=== Unrolled List Traversal Comparison ===\n";
+
+    auto fillList = [](auto& list, int size) {
+        for (int i = 0; i < size; ++i) {
+            list.push_back(TestData(100, "to_iterate", i));
+        }
+    };
+
+    tiny_stl::unrolled_list<TestData> unrolled;
+    fillList(unrolled, LARGE_SIZE);
+    tiny_stl::list<TestData> tiny_list;
+    fillList(tiny_list, LARGE_SIZE);
+    std::list<TestData> std_list;
+    fillList(std_list, LARGE_SIZE);
+
+    double unrolled_time = measureIterationPerformance(unrolled);
+    double tiny_time = measureIterationPerformance(tiny_list);
+    double std_time = measureIterationPerformance(std_list);
+    comparePerformance("Unrolled Forward Iteration", unrolled_time, std_time);
+    std::cout << "  tiny_stl::list: " << formatDuration(tiny_time) << "\n";
+
+    unrolled_time = measureIterationPerformance(unrolled, true);
+    std_time = measureIterationPerformance(std_list, true);
+    comparePerformance("Unrolled Reverse Iteration", unrolled_time, std_time);
+}
+
+TEST_F(ListPerformanceTest, UnrolledListInsertComparison) {
+    std::cout << "\n=== Unrolled List Insert Comparison ===\n";
+
+    // NOTE: 单次只有几毫秒，受首次分配缺页影响很大，取三次中最快的一次
+    auto bestBackInsert = [this](auto make_list) {
+        double best = 1e9;
+        for (int run = 0; run < 3; ++run) {
+            auto list = make_list();
+            best = std::min(best, measureInsertPerformance(list, "back"));
+        }
+        return best;
+    };
+    double unrolled_time = bestBackInsert([] { return tiny_stl::unrolled_list<TestData>(); });
+    double tiny_time = bestBackInsert([] { return tiny_stl::list<TestData>(); });
+    double std_time = bestBackInsert([] { return std::list<TestData>(); });
+    comparePerformance("Unrolled Back Insert", unrolled_time, std_time);
+    std::cout << "  tiny_stl::list: " << formatDuration(tiny_time) << "\n";
+
+    tiny_stl::unrolled_list<TestData> unrolled2;
+    tiny_stl::list<TestData> tiny_list2;
+    std::list<TestData> std_list2;
+    for (int i = 0; i < MEDIUM_SIZE / 2; ++i) {
+        unrolled2.emplace_back(100, "base", 0);
+        tiny_list2.emplace_back(100, "base", 0);
+        std_list2.emplace_back(100, "base", 0);
+    }
+    unrolled_time = measureInsertPerformance(unrolled2, "middle");
+    tiny_time = measureInsertPerformance(tiny_list2, "middle");
+    std_time = measureInsertPerformance(std_list2, "middle");
+    // NOTE: 中间插入需要在结点内搬动后面的元素，预期比std::list慢约2倍，用单独的阈值检查
+    comparePerformance("Unrolled Middle Insert", unrolled_time, std_time,
+                       UNROLLED_MIDDLE_INSERT_THRESHOLD);
+    std::cout << "  tiny_stl::list: " << formatDuration(tiny_time) << "\n";
+}
+
+TEST_F(ListPerformanceTest, SortPerformanceComparison) {
+    std::cout << "\n=== Sort Performance Comparison ===\n";
+
+    // NOTE: 用小的TestData，避免1M个结点的payload占用过多内存
+    auto fillShuffledList = [](auto& list, int size) {
+        for (int i = 0; i < size; ++i) {
+            list.push_back(TestData(1, "", (i * 7919LL) % size));
+        }
+    };
+
+    tiny_stl::list<TestData> tiny_list;
+    fillShuffledList(tiny_list, SORT_SIZE);
+    double tiny_time = measureSortPerformance(tiny_list);
+    std::list<TestData> std_list;
+    fillShuffledList(std_list, SORT_SIZE);
+    double std_time = measureSortPerformance(std_list);
+    comparePerformance("Sort", tiny_time, std_time);
+
+    EXPECT_EQ(tiny_list.size(), static_cast<size_t>(SORT_SIZE));
+    double prev = -1.0;
+    for (const auto& item : tiny_list) {
+        ASSERT_GT(item.value, prev);
+        prev = item.value;
+    }
+}
+
+TEST_F(ListPerformanceTest, QueueSteadyStateComparison) {
+    std::cout << "\n=== Queue Steady State (push_back + pop_front) ===\n";
+
+    constexpr int QUEUE_DEPTH = 1000;
+    constexpr int OPERATIONS = 2000000;
+    auto measureQueue = [](auto& list) {
+        TINY_STL_TRACE_SCOPE("ListPerformanceTest::queue", list.size());
+        for (int i = 0; i < QUEUE_DEPTH; ++i) {
+            list.push_back(i);
+        }
+        long long sum = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < OPERATIONS; ++i) {
+            sum += list.front();
+            list.pop_front();
+            list.push_back(i);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        EXPECT_GT(sum, 0);
+        return std::chrono::duration<double>(end - start).count();
+    };
+
+    tiny_stl::list<int> uncached;
+    double uncached_time = measureQueue(uncached);
+    tiny_stl::list<int> cached;
+    cached.set_node_cache_limit(QUEUE_DEPTH);
+    double cached_time = measureQueue(cached);
+    std::list<int> std_list;
+    double std_time = measureQueue(std_list);
+
+    comparePerformance("Queue (node cache)", cached_time, std_time);
+    std::cout << "  tiny_stl::list without cache: " << formatDuration(uncached_time) << "\n";
+}
+
+TEST_F(ListPerformanceTest, IntrusiveLruMoveToFrontComparison) {
+    std::cout << "\n=== LRU Move-To-Front (intrusive_list vs list<T*>) ===\n";
+
+    struct Entry {
+        int key;
+        intrusive_list_hook hook;
+        explicit Entry(int k) : key(k) {}
+    };
+
+    constexpr int ACCESSES = 1000000;
+    std::vector<std::unique_ptr<Entry>> entries;
+    for (int i = 0; i < MEDIUM_SIZE; ++i) {
+        entries.push_back(std::make_unique<Entry>(i));
+    }
+    std::vector<int> accesses(ACCESSES);
+    for (int i = 0; i < ACCESSES; ++i) {
+        accesses[i] = static_cast<int>((i * 2654435761u) % MEDIUM_SIZE);
+    }
+
+    // list<T*>需要额外保存每个元素的迭代器才能O(1)定位
+    auto measurePointerList = [&](auto& list) {
+        TINY_STL_TRACE_SCOPE("ListPerformanceTest::lru", list.size());
+        using iterator = typename std::decay_t<decltype(list)>::iterator;
+        std::vector<iterator> where;
+        for (auto& entry : entries) {
+            list.push_back(entry.get());
+            where.push_back(std::prev(list.end()));
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int key : accesses) {
+            list.splice(list.begin(), list, where[key]);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        EXPECT_EQ(list.front()->key, accesses.back());
+        return std::chrono::duration<double>(end - start).count();
+    };
+
+    intrusive_list<Entry, &Entry::hook> lru;
+    for (auto& entry : entries) {
+        lru.push_back(*entry);
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        TINY_STL_TRACE_SCOPE("ListPerformanceTest::lru", MEDIUM_SIZE);
+        for (int key : accesses) {
+            lru.move_to_front(*entries[key]);
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double intrusive_time = std::chrono::duration<double>(end - start).count();
+    EXPECT_EQ(lru.front().key, accesses.back());
+
+    tiny_stl::list<Entry*> tiny_list;
+    double tiny_time = measurePointerList(tiny_list);
+    std::list<Entry*> std_list;
+    double std_time = measurePointerList(std_list);
+
+    comparePerformance("LRU (intrusive_list)", intrusive_time, std_time);
+    std::cout << "  tiny_stl::list<T*>: " << formatDuration(tiny_time) << "\n";
+}
+
+TEST_F(ListPerformanceTest, RangeSpliceComparison) {
+    std::cout << "\n=== Range Splice Between Lists (half of " << LARGE_SIZE << " elements) ===\n";
+
+    constexpr int ROUNDS = 1000;
+    // 每轮把a开头的一半移到b，再整段移回a的末尾，两个边界迭代器交替使用
+    auto measureSplice = [](auto& a, auto& b) {
+        TINY_STL_TRACE_SCOPE("ListPerformanceTest::splice", a.size());
+        for (int i = 0; i < LARGE_SIZE; ++i) {
+            a.push_back(i);
+        }
+        auto first = a.begin();
+        auto second = std::next(a.begin(), LARGE_SIZE / 2);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < ROUNDS; ++i) {
+            b.splice(b.end(), a, a.begin(), second);
+            a.splice(a.end(), b, b.begin(), b.end());
+            std::swap(first, second);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        EXPECT_EQ(a.size(), static_cast<size_t>(LARGE_SIZE));
+        EXPECT_TRUE(b.empty());
+        return std::chrono::duration<double>(end - start).count();
+    };
+
+    tiny_stl::list<int> tiny_a, tiny_b;
+    double tiny_time = measureSplice(tiny_a, tiny_b);
+    std::list<int> std_a, std_b;
+    double std_time = measureSplice(std_a, std_b);
+
+    comparePerformance("Range Splice", tiny_time, std_time);
+}
+
+TEST_F(ListPerformanceTest, MergeAllComparison) {
+    std::cout << "\n=== K-Way Merge (merge_all vs pairwise merge, " << MEDIUM_SIZE * 8 << " elements) ===\n";
+
+    constexpr int TOTAL = MEDIUM_SIZE * 8;
+    // 第j路包含所有 i % k == j 的元素，归并时各路交替输出
+    auto makeInputs = [](int k) {
+        std::vector<tiny_stl::list<int>> inputs(k);
+        for (int i = 0; i < TOTAL; ++i) {
+            inputs[i % k].push_back(i);
+        }
+        return inputs;
+    };
+
+    for (int k = 2; k <= 256; k *= 2) {
+        auto inputs = makeInputs(k);
+        tiny_stl::list<int> loser_tree;
+        auto start = std::chrono::high_resolution_clock::now();
+        loser_tree.merge_all(inputs.begin(), inputs.end());
+        auto end = std::chrono::high_resolution_clock::now();
+        double merge_all_time = std::chrono::duration<double>(end - start).count();
+
+        inputs = makeInputs(k);
+        tiny_stl::list<int> pairwise;
+        start = std::chrono::high_resolution_clock::now();
+        for (auto& l : inputs) {
+            pairwise.merge(l);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        double pairwise_time = std::chrono::duration<double>(end - start).count();
+
+        EXPECT_EQ(loser_tree.size(), static_cast<size_t>(TOTAL));
+        EXPECT_TRUE(std::equal(loser_tree.begin(), loser_tree.end(), pairwise.begin()));
+        std::cout << "k = " << std::setw(3) << k
+                  << " | merge_all: " << std::setw(12) << formatDuration(merge_all_time)
+                  << " | pairwise: " << std::setw(12) << formatDuration(pairwise_time) << "\n";
+        // NOTE: 两两归并每个元素平均被比较k/2次，败者树只需要log(k)次
+        if (k >= 128) {
+            EXPECT_LT(merge_all_time, pairwise_time);
+        }
+    }
+}
+
+TEST_F(ListPerformanceTest, LinearizeTraversalComparison) {
+    std::cout << "\n=== Large List Traversal (scattered / linearize) ===\n";
+
+    tiny_stl::list<TestData> tiny_list;
+    std::list<TestData> std_list;
+    for (int i = 0; i < LARGE_SIZE; ++i) {
+        tiny_list.push_back(TestData(100, "to_iterate", i));
+        std_list.push_back(TestData(100, "to_iterate", i));
+    }
+    // 按打乱的key排序，结点的链表顺序和地址顺序不再一致
+    auto scrambled = [](const TestData& a, const TestData& b) {
+        auto key = [](double v) { return static_cast<uint32_t>(v) * 2654435761u; };
+        return key(a.value) < key(b.value);
+    };
+    tiny_list.sort(scrambled);
+    std_list.sort(scrambled);
+
+    auto timeIt = [](auto fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    };
+    auto sumValues = [](double acc, const TestData& item) { return acc + item.value; };
+    const double expected = static_cast<double>(LARGE_SIZE) * (LARGE_SIZE - 1) / 2;
+
+    double std_time = measureIterationPerformance(std_list);
+    double scattered_time = measureIterationPerformance(tiny_list);
+    double sum = 0;
+    double accumulate_time = timeIt([&] { sum = tiny_list.accumulate(0.0, sumValues); });
+    EXPECT_EQ(sum, expected);
+    double linearize_time = timeIt([&] { tiny_list.linearize(); });
+    double linear_time = timeIt([&] { sum = tiny_list.accumulate(0.0, sumValues); });
+    EXPECT_EQ(sum, expected);
+
+    comparePerformance("Traversal (scattered, accumulate)", accumulate_time, std_time);
+    comparePerformance("Traversal (after linearize)", linear_time, std_time);
+    std::cout << "  range-for: " << formatDuration(scattered_time)
+              << " | linearize: " << formatDuration(linearize_time) << "\n";
+    EXPECT_LT(linear_time, scattered_time);
+}
+
 } // namespace test
-} // namespace tiny_stl
\ No newline at end of file
+} // namespace tiny_stl
@@ -5,6 +5,10 @@
 #include <string>
 #include <memory>
 #include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 namespace tiny_stl {
 namespace test {
@@ -45,6 +49,31 @@ protected:
             return name == other.name && id == other.id;
         }
     };
+
+    // 统计还没归还的结点数（按分配的元素个数计）
+    static long& liveNodes() {
+        static long live = 0;
+        return live;
+    }
+
+    template <typename T>
+    struct CountingAllocator : std::allocator<T> {
+        template <typename U>
+        struct rebind { using other = CountingAllocator<U>; };
+
+        CountingAllocator() = default;
+        template <typename U>
+        CountingAllocator(const CountingAllocator<U>&) {}
+
+        T* allocate(size_t n) {
+            liveNodes() += n;
+            return std::allocator<T>::allocate(n);
+        }
+        void deallocate(T* p, size_t n) {
+            liveNodes() -= n;
+            std::allocator<T>::deallocate(p, n);
+        }
+    };
 };
 
 //======================================================//
@@ -258,27 +287,413 @@ TEST_F(ListTest, UniqueOperation) {
     EXPECT_EQ(l.size(), 3); // Should remove consecutive increasing by 1
 }
 
-// TEST_F(ListTest, SortOperation) {
-//     list<int> l{5, 3, 1, 4, 2};
+TEST_F(ListTest, SortOperation) {
+    list<int> l{5, 3, 1, 4, 2};
     
-//     l.sort();
+    l.sort();
     
-//     int prev = 0;
-//     for(int val : l) {
-//         EXPECT_GT(val, prev);
-//         prev = val;
-//     }
+    int prev = 0;
+    for(int val : l) {
+        EXPECT_GT(val, prev);
+        prev = val;
+    }
     
-//     // Test with custom comparator
-//     l = {1, 3, 5, 2, 4};
-//     l.sort(std::greater<int>());
+    // Test with custom comparator
+    l = {1, 3, 5, 2, 4};
+    l.sort(std::greater<int>());
     
-//     prev = 100;
-//     for(int val : l) {
-//         EXPECT_LT(val, prev);
-//         prev = val;
-//     }
-// }
+    prev = 100;
+    for(int val : l) {
+        EXPECT_LT(val, prev);
+        prev = val;
+    }
+}
+
+TEST_F(ListTest, SortIsStableAndRelinksNodes) {
+    list<std::pair<int, int>> l;
+    for (int i = 0; i < 1000; ++i) {
+        l.push_back({(i * 7919) % 10, i});
+    }
+    const std::pair<int, int>* first_addr = &l.front();
+    l.sort([](const auto& a, const auto& b) { return a.first < b.first; });
+    EXPECT_EQ(l.size(), 1000);
+    EXPECT_TRUE(std::is_sorted(l.begin(), l.end()));
+
+    // 结点没有重新分配，原来的首元素仍在链表中
+    bool found = false;
+    for (const auto& value : l) {
+        found = found || &value == first_addr;
+    }
+    EXPECT_TRUE(found);
+
+    // 反向遍历验证prev指针
+    int count = 0;
+    for (auto it = --l.end(); it != l.end(); --it) {
+        ++count;
+    }
+    EXPECT_EQ(count, 1000);
+}
+
+TEST_F(ListTest, MergeWithComparator) {
+    list<int> l1{5, 3, 1};
+    list<int> l2{6, 4, 2};
+    l1.merge(l2, std::greater<int>());
+    EXPECT_TRUE(l2.empty());
+    EXPECT_TRUE(std::is_sorted(l1.begin(), l1.end(), std::greater<int>()));
+    EXPECT_EQ(l1.size(), 6);
+}
+
+TEST_F(ListTest, RangeSpliceRecountsSizeLazily) {
+    list<int> l1{1, 2, 3, 4, 5};
+    list<int> l2{6, 7};
+
+    // 区间splice之后size需要重新计算
+    l2.splice(l2.begin(), l1, std::next(l1.begin()), std::prev(l1.end()));
+    EXPECT_EQ(l1.size(), 2);
+    EXPECT_EQ(l2.size(), 5);
+    EXPECT_EQ(l2.front(), 2);
+
+    // 未知的size在整体splice、push和swap之后仍然正确
+    l1.splice(l1.end(), l2, l2.begin(), std::next(l2.begin(), 2));
+    l1.push_back(8);
+    list<int> l3{9};
+    l3.splice(l3.end(), l1);
+    EXPECT_TRUE(l1.empty());
+    EXPECT_EQ(l1.size(), 0);
+    EXPECT_EQ(l3.size(), 6);
+    l3.swap(l2);
+    EXPECT_EQ(l2.size(), 6);
+    EXPECT_EQ(l3.size(), 3);
+
+    // 同一个list内部的splice不改变size
+    l2.splice(l2.begin(), l2, std::next(l2.begin(), 3), l2.end());
+    EXPECT_EQ(l2.size(), 6);
+    EXPECT_EQ(l2.front(), 2);
+}
+
+TEST_F(ListTest, ConstSizeFromManyThreads) {
+    list<int> src;
+    for (int i = 0; i < 10000; ++i) {
+        src.push_back(i);
+    }
+    list<int> dst;
+    dst.splice(dst.end(), src, std::next(src.begin(), 100), src.end());
+
+    // size未知时多个线程同时调用const的size()，各自重新数并写回缓存
+    const list<int>& cdst = dst;
+    std::vector<size_t> sizes(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < sizes.size(); ++t) {
+        threads.emplace_back([&, t] { sizes[t] = cdst.size(); });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    for (size_t n : sizes) {
+        EXPECT_EQ(n, 9900);
+    }
+    EXPECT_EQ(src.size(), 100);
+}
+
+TEST_F(ListTest, BulkConstructionUsesContiguousNodes) {
+    list<std::string> l(5, "abc");
+    list<std::string> copy(l);
+    list<int> il{1, 2, 3, 4};
+    for (auto* lst : {&l, &copy}) {
+        auto it = lst->begin();
+        const std::string* prev = &*it;
+        for (++it; it != lst->end(); ++it) {
+            EXPECT_GT(&*it, prev);
+            prev = &*it;
+        }
+    }
+    EXPECT_EQ(copy.size(), 5);
+    EXPECT_EQ(copy.back(), "abc");
+    EXPECT_EQ(&*std::next(il.begin()) - &*il.begin(), &*std::next(il.begin(), 2) - &*std::next(il.begin()));
+
+    // 块内结点删除后被复用
+    const int* second = &*std::next(il.begin());
+    il.erase(std::next(il.begin()));
+    il.push_back(5);
+    EXPECT_EQ(&il.back(), second);
+}
+
+TEST_F(ListTest, InsertRangeLinksChainOnce) {
+    list<int> l{1, 5};
+    std::vector<int> v{2, 3, 4};
+    auto it = l.insert(std::next(l.begin()), v.begin(), v.end());
+    EXPECT_EQ(*it, 2);
+    EXPECT_EQ(l.size(), 5);
+    EXPECT_EQ(std::vector<int>(l.begin(), l.end()), (std::vector<int>{1, 2, 3, 4, 5}));
+
+    // 输入迭代器只能遍历一次，逐个分配结点
+    std::istringstream in("6 7 8");
+    l.insert(l.end(), std::istream_iterator<int>(in), std::istream_iterator<int>());
+    EXPECT_EQ(l.size(), 8);
+    EXPECT_EQ(l.back(), 8);
+    EXPECT_EQ(l.insert(l.begin(), v.begin(), v.begin()), l.begin());
+}
+
+TEST_F(ListTest, BlockNodesOutliveSourceList) {
+    list<std::string> dst;
+    {
+        list<std::string> src(100, "block");
+        dst.splice(dst.end(), src, std::next(src.begin(), 10), std::next(src.begin(), 20));
+        dst.splice(dst.begin(), src, src.begin());
+        list<std::string> other(3, "x");
+        dst.merge(other);
+    }
+    EXPECT_EQ(dst.size(), 14);
+    for (int i = 0; i < 100; ++i) {
+        dst.push_back("new");
+        dst.pop_front();
+    }
+    EXPECT_EQ(dst.size(), 14);
+    EXPECT_EQ(dst.front(), "new");
+}
+
+TEST_F(ListTest, BlockNodesHaveNoBackPointer) {
+    // 整块分配的结点不记录所属的块，结点仍然只有数据和两个指针
+    static_assert(sizeof(list_node<void*>) == 3 * sizeof(void*), "list_node grew");
+}
+
+TEST_F(ListTest, CopyAssignDoesNotAccumulateBlocks) {
+    using counted_list = list<int, CountingAllocator<int>>;
+    liveNodes() = 0;
+    {
+        std::vector<int> values(1000);
+        std::iota(values.begin(), values.end(), 0);
+        counted_list src;
+        src.insert(src.end(), values.begin(), values.end());
+        counted_list dst;
+        for (int i = 0; i < 2000; ++i) {
+            dst = src;
+        }
+        EXPECT_EQ(dst.size(), 1000);
+        EXPECT_EQ(dst.block_count(), 1);
+        // 两个哨兵 + 两份元素 + 两个块头
+        EXPECT_EQ(liveNodes(), 2 + 2 * 1000 + 2);
+    }
+    EXPECT_EQ(liveNodes(), 0);
+}
+
+TEST_F(ListTest, RangeInsertReusesIdleBlockNodes) {
+    using counted_list = list<int, CountingAllocator<int>>;
+    liveNodes() = 0;
+    {
+        std::vector<int> values(1000, 7);
+        counted_list l;
+        l.insert(l.end(), values.begin(), values.end());
+        for (int i = 0; i < 500; ++i) {
+            l.pop_front();
+        }
+        EXPECT_EQ(liveNodes(), 1 + 1000 + 1);
+
+        // 500个空闲结点先被复用，只为剩下的200个分配新块
+        l.insert(l.end(), values.begin(), values.begin() + 700);
+        EXPECT_EQ(l.size(), 1200);
+        EXPECT_EQ(l.block_count(), 2);
+        EXPECT_EQ(liveNodes(), 1 + 1200 + 2);
+
+        // clear之后块留着给下次批量构造用，list为空时shrink才归还
+        l.clear();
+        EXPECT_EQ(l.block_count(), 2);
+        l.shrink();
+        EXPECT_EQ(l.block_count(), 0);
+        EXPECT_EQ(liveNodes(), 1);
+    }
+    EXPECT_EQ(liveNodes(), 0);
+}
+
+TEST_F(ListTest, BlocksReleasedByLastHoldingList) {
+    using counted_list = list<int, CountingAllocator<int>>;
+    liveNodes() = 0;
+    {
+        counted_list owner(100, 1);
+        counted_list other;
+        other.splice(other.end(), owner);
+        EXPECT_EQ(other.block_count(), 1);
+        other.clear();
+        // 两个list都持有这一块，owner放弃之后other还在用
+        owner.shrink();
+        EXPECT_EQ(owner.block_count(), 0);
+        EXPECT_EQ(liveNodes(), 2 + 100 + 1);
+        other.push_back(3);
+        EXPECT_EQ(liveNodes(), 2 + 100 + 1);
+        other.clear();
+        other.shrink();
+        EXPECT_EQ(liveNodes(), 2);
+
+        // source先析构，块由other归还
+        {
+            counted_list source(10, 2);
+            other.splice(other.end(), source, std::next(source.begin(), 3), source.end());
+        }
+        EXPECT_EQ(liveNodes(), 2 + 10 + 1);
+        other.clear();
+        other.shrink();
+        EXPECT_EQ(liveNodes(), 2);
+    }
+    EXPECT_EQ(liveNodes(), 0);
+}
+
+TEST_F(ListTest, MergeAllIsStable) {
+    using Item = std::pair<int, int>;  // (key, 来源)
+    auto by_key = [](const Item& a, const Item& b) { return a.first < b.first; };
+
+    list<Item> result{{1, 0}, {3, 0}};
+    std::vector<list<Item>> inputs(300);
+    for (int i = 0; i < 300; ++i) {
+        for (int key = i % 4; key < 6; key += 2) {
+            inputs[i].push_back({key, i + 1});
+        }
+    }
+    size_t expected_size = 2;
+    for (auto& l : inputs) {
+        expected_size += l.size();
+    }
+
+    // 超过256路时分两轮归并
+    result.merge_all(inputs.begin(), inputs.end(), by_key);
+    EXPECT_EQ(result.size(), expected_size);
+    for (auto& l : inputs) {
+        EXPECT_TRUE(l.empty());
+    }
+    auto prev = result.begin();
+    for (auto it = std::next(result.begin()); it != result.end(); prev = it++) {
+        ASSERT_LE(prev->first, it->first);
+        if (prev->first == it->first) {
+            ASSERT_LT(prev->second, it->second);
+        }
+        ASSERT_EQ(&*std::prev(it), &*prev);
+    }
+
+    list<int> empty;
+    std::vector<list<int>> singles{{3}, {}, {1, 2}};
+    empty.merge_all(singles.begin(), singles.end());
+    EXPECT_EQ(std::vector<int>(empty.begin(), empty.end()), (std::vector<int>{1, 2, 3}));
+}
+
+TEST_F(ListTest, TraversalHelpers) {
+    list<int> l;
+    for (int i = 1; i <= 100; ++i) {
+        l.push_back(i);
+    }
+    int sum = 0;
+    l.for_each([&](int& v) { sum += v; v *= 2; });
+    EXPECT_EQ(sum, 5050);
+    EXPECT_EQ(l.accumulate(0), 10100);
+    EXPECT_EQ(l.accumulate(std::string(), [](std::string acc, int v) {
+        return v <= 6 ? acc + std::to_string(v) : acc;
+    }), "246");
+
+    auto it = l.find_if([](int v) { return v > 50; });
+    ASSERT_NE(it, l.end());
+    EXPECT_EQ(*it, 52);
+    EXPECT_EQ(l.find_if([](int v) { return v < 0; }), l.end());
+
+    const list<int>& cl = l;
+    EXPECT_EQ(*cl.find_if([](int v) { return v == 4; }), 4);
+    list<int> short_list{1, 2};
+    EXPECT_EQ(short_list.accumulate(0), 3);
+}
+
+TEST_F(ListTest, LinearizeRelinksExistingNodes) {
+    list<std::string> l;
+    for (int i = 0; i < 50; ++i) {
+        l.push_back(std::to_string(i));
+        l.push_front(std::to_string(-i));
+    }
+    std::vector<std::string> before(l.begin(), l.end());
+    std::vector<const std::string*> nodes;
+    for (auto& s : l) {
+        nodes.push_back(&s);
+    }
+    auto kept = std::next(l.begin(), 10);
+    l.linearize();
+    EXPECT_EQ(std::vector<std::string>(l.begin(), l.end()), before);
+    EXPECT_EQ(l.size(), 100);
+
+    // 还是原来那些结点，只是按地址顺序重新链接
+    std::vector<const std::string*> after;
+    for (auto& s : l) {
+        after.push_back(&s);
+    }
+    EXPECT_TRUE(std::is_sorted(after.begin(), after.end()));
+    std::sort(nodes.begin(), nodes.end());
+    EXPECT_EQ(after, nodes);
+    // 迭代器没有失效，指向落在该结点上的元素
+    EXPECT_NE(std::find(l.begin(), l.end(), *kept), l.end());
+    EXPECT_EQ(*std::next(kept), *std::next(std::find(l.begin(), l.end(), *kept)));
+
+    // 已经按地址有序时元素不移动
+    auto first = l.begin();
+    l.linearize();
+    EXPECT_EQ(l.begin(), first);
+    EXPECT_EQ(std::vector<std::string>(l.begin(), l.end()), before);
+
+    list<std::unique_ptr<int>> owners;
+    for (int i = 0; i < 10; ++i) {
+        owners.push_front(std::make_unique<int>(i));
+    }
+    owners.linearize();
+    int expected = 9;
+    for (auto& p : owners) {
+        EXPECT_EQ(*p, expected--);
+    }
+    l.pop_front();
+    l.push_back("end");
+    EXPECT_EQ(l.back(), "end");
+    EXPECT_EQ(l.size(), 100);
+}
+
+TEST_F(ListTest, NodeCacheRecyclesNodes) {
+    list<int> l;
+    l.set_node_cache_limit(2);
+    l.push_back(1);
+    const int* addr = &l.front();
+    l.pop_front();
+    EXPECT_EQ(l.cached_nodes(), 1);
+
+    // 复用刚释放的结点
+    l.push_back(2);
+    EXPECT_EQ(&l.front(), addr);
+    EXPECT_EQ(l.cached_nodes(), 0);
+
+    // 缓存数量不超过上限
+    for (int i = 0; i < 10; ++i) {
+        l.push_back(i);
+    }
+    l.clear();
+    EXPECT_TRUE(l.empty());
+    EXPECT_EQ(l.cached_nodes(), 2);
+
+    l.shrink();
+    EXPECT_EQ(l.cached_nodes(), 0);
+    EXPECT_EQ(l.node_cache_limit(), 2);
+}
+
+TEST_F(ListTest, MergeIntoEmptyKeepsNodeCache) {
+    list<int> q;
+    q.set_node_cache_limit(100);
+    list<int> b;
+    b.set_node_cache_limit(3);
+    for (int i = 0; i < 5; ++i) {
+        b.push_back(i);
+    }
+    b.pop_back();
+    EXPECT_EQ(b.cached_nodes(), 1);
+
+    // 空list归并时直接接过结点，两边的缓存上限和缓存的结点都留在原处
+    q.merge(b);
+    EXPECT_EQ(q.size(), 4);
+    EXPECT_TRUE(b.empty());
+    EXPECT_EQ(q.node_cache_limit(), 100);
+    EXPECT_EQ(b.node_cache_limit(), 3);
+    EXPECT_EQ(q.cached_nodes(), 0);
+    EXPECT_EQ(b.cached_nodes(), 1);
+    EXPECT_EQ(std::vector<int>(q.begin(), q.end()), (std::vector<int>{0, 1, 2, 3}));
+}
 
 TEST_F(ListTest, SpliceOperations) {
     list<int> l1{1, 2, 3};
@@ -396,15 +811,15 @@ TEST_F(ListTest, STLAlgorithmReverseCopy) {
     }
 }
 
-// TEST_F(ListTest, STLAlgorithmSortWithList) {
-//     list<int> l{5, 3, 1, 4, 2};
+TEST_F(ListTest, STLAlgorithmSortWithList) {
+    list<int> l{5, 3, 1, 4, 2};
     
-//     // STL sort requires random access iterators, which list doesn't have
-//     // So we should test that our list works with algorithms that don't require random access
-//     l.sort(); // Use list's own sort
+    // STL sort requires random access iterators, which list doesn't have
+    // So we should test that our list works with algorithms that don't require random access
+    l.sort(); // Use list's own sort
     
-//     EXPECT_TRUE(std::is_sorted(l.begin(), l.end()));
-// }
+    EXPECT_TRUE(std::is_sorted(l.begin(), l.end()));
+}
 
 TEST_F(ListTest, STLAlgorithmMaxElement) {
     list<int> l{3, 1, 4, 1, 5, 9, 2, 6};
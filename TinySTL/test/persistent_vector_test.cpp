@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include "persistent_vector.h"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class PersistentVectorTest : public ::testing::Test {
+protected:
+    static constexpr size_t LARGE_SIZE = 100000;
+
+    static persistent_vector<int> make_vector(size_t size) {
+        auto t = persistent_vector<int>().transient();
+        for (size_t i = 0; i < size; ++i) {
+            t.push_back(static_cast<int>(i));
+        }
+        return t.persistent();
+    }
+};
+
+//======================================================//
+// basic test
+//======================================================//
+TEST_F(PersistentVectorTest, DefaultConstructor) {
+    persistent_vector<int> v;
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(v.size(), 0);
+    EXPECT_EQ(v.begin(), v.end());
+}
+
+TEST_F(PersistentVectorTest, InitializerListConstructor) {
+    persistent_vector<std::string> v{"a", "b", "c"};
+    EXPECT_EQ(v.size(), 3);
+    EXPECT_EQ(v[0], "a");
+    EXPECT_EQ(v[2], "c");
+    EXPECT_THROW(v.at(3), std::out_of_range);
+}
+
+TEST_F(PersistentVectorTest, PushBackKeepsOldVersion) {
+    persistent_vector<int> v0;
+    auto v1 = v0.push_back(1);
+    auto v2 = v1.push_back(2);
+    EXPECT_EQ(v0.size(), 0);
+    EXPECT_EQ(v1.size(), 1);
+    EXPECT_EQ(v2.size(), 2);
+    EXPECT_EQ(v1.back(), 1);
+    EXPECT_EQ(v2.back(), 2);
+}
+
+TEST_F(PersistentVectorTest, DeepTreeAccess) {
+    // 32 * 32 * 32 + 1 个元素，树至少有三层
+    const size_t size = 32 * 32 * 32 + 33;
+    auto v = make_vector(size);
+    ASSERT_EQ(v.size(), size);
+    for (size_t i = 0; i < size; ++i) {
+        ASSERT_EQ(v[i], static_cast<int>(i));
+    }
+    size_t expected = 0;
+    for (int value : v) {
+        ASSERT_EQ(value, static_cast<int>(expected++));
+    }
+    EXPECT_EQ(expected, size);
+}
+
+TEST_F(PersistentVectorTest, SetCopiesPathOnly) {
+    auto v = make_vector(5000);
+    auto w = v.set(10, -1).set(4999, -2);
+    EXPECT_EQ(v[10], 10);
+    EXPECT_EQ(v[4999], 4999);
+    EXPECT_EQ(w[10], -1);
+    EXPECT_EQ(w[4999], -2);
+    // 没有修改的叶子是共享的
+    EXPECT_EQ(&v[100], &w[100]);
+    EXPECT_NE(&v[10], &w[10]);
+}
+
+TEST_F(PersistentVectorTest, PopBackShrinksTree) {
+    const size_t size = 32 * 32 + 40;
+    auto v = make_vector(size);
+    auto w = v;
+    for (size_t i = size; i > 0; --i) {
+        ASSERT_EQ(w.size(), i);
+        ASSERT_EQ(w.back(), static_cast<int>(i - 1));
+        w = w.pop_back();
+    }
+    EXPECT_TRUE(w.empty());
+    EXPECT_EQ(v.size(), size);
+    EXPECT_EQ(v.back(), static_cast<int>(size - 1));
+}
+
+TEST_F(PersistentVectorTest, TransientDoesNotAffectSource) {
+    auto v = make_vector(100);
+    auto t = v.transient();
+    t.set(0, 42);
+    t.push_back(100);
+    t.pop_back();
+    t.pop_back();
+    auto w = t.persistent();
+    EXPECT_TRUE(t.empty());
+    EXPECT_EQ(v.size(), 100);
+    EXPECT_EQ(v[0], 0);
+    EXPECT_EQ(w.size(), 99);
+    EXPECT_EQ(w[0], 42);
+}
+
+TEST_F(PersistentVectorTest, ElementLifetime) {
+    auto counter = std::make_shared<int>(0);
+    {
+        persistent_vector<std::shared_ptr<int>> v;
+        for (int i = 0; i < 100; ++i) {
+            v = v.push_back(counter);
+        }
+        auto w = v.set(0, nullptr);
+        EXPECT_EQ(counter.use_count(), 1 + 100 + 31);
+    }
+    EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST_F(PersistentVectorTest, ConcurrentSnapshotRead) {
+    auto v = make_vector(LARGE_SIZE);
+    std::vector<std::thread> readers;
+    std::vector<long long> sums(4, 0);
+    for (size_t t = 0; t < sums.size(); ++t) {
+        readers.emplace_back([snapshot = v, &sums, t]() {
+            for (int value : snapshot) {
+                sums[t] += value;
+            }
+        });
+    }
+    // 读线程持有快照的同时修改并丢弃新版本
+    for (int i = 0; i < 1000; ++i) {
+        v = v.set(i, -i);
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    const long long expected = static_cast<long long>(LARGE_SIZE) * (LARGE_SIZE - 1) / 2;
+    for (long long sum : sums) {
+        EXPECT_EQ(sum, expected);
+    }
+}
+
+TEST_F(PersistentVectorTest, SnapshotPerformance) {
+    auto v = make_vector(LARGE_SIZE);
+    std::vector<int> sv(LARGE_SIZE, 1);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < 1000; ++i) {
+        persistent_vector<int> snapshot = v;
+        ASSERT_EQ(snapshot.size(), LARGE_SIZE);
+    }
+    auto persistent_duration = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < 1000; ++i) {
+        std::vector<int> snapshot = sv;
+        ASSERT_EQ(snapshot.size(), LARGE_SIZE);
+    }
+    auto std_duration = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    std::cout << "Snapshot Performance (us, 1000 copies):\n"
+              << "persistent_vector: " << persistent_duration << "\n"
+              << "std::vector: " << std_duration << "\n";
+    EXPECT_LT(persistent_duration, std_duration);
+}
+
+} // namespace test
+} // namespace tiny_stl
@@ -0,0 +1,144 @@
+#include "gtest/gtest.h"
+#include "concurrent_unordered_map.h"
+#include "rcu_unordered_map.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class RcuUnorderedMapPerfTest : public ::testing::Test {
+protected:
+    static constexpr size_t TOTAL_READS = 2000000;
+    static constexpr int KEY_RANGE = 100000;
+
+    static size_t max_threads() {
+        return std::max<size_t>(2, std::min<size_t>(8, std::thread::hardware_concurrency()));
+    }
+
+    // thread_count个读者一共查找TOTAL_READS次，同时有一个写者不停地改写/删除/插入，
+    // 返回读者的总耗时(ms)；writes返回读者运行期间写者完成的写操作数
+    template <typename ReadFn, typename WriteFn>
+    double measureReads(size_t thread_count, ReadFn read, WriteFn write, size_t& writes) {
+        std::atomic<bool> stop{false};
+        std::atomic<size_t> write_count{0};
+        std::thread writer([&]() {
+            uint32_t state = 12345;
+            size_t n = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                state = state * 1664525u + 1013904223u;
+                write(static_cast<int>((state >> 8) % KEY_RANGE), state % 3);
+                ++n;
+                // 读多写少：写者每次写完让出CPU
+                std::this_thread::yield();
+            }
+            write_count = n;
+        });
+
+        std::vector<std::thread> threads;
+        size_t per_thread = TOTAL_READS / thread_count;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&, per_thread, t]() {
+                uint32_t state = static_cast<uint32_t>(t * 2654435761u + 1);
+                for (size_t i = 0; i < per_thread; ++i) {
+                    state = state * 1664525u + 1013904223u;
+                    read(static_cast<int>((state >> 8) % KEY_RANGE));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        double elapsed = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+        stop = true;
+        writer.join();
+        writes = write_count.load();
+        return elapsed;
+    }
+};
+
+// NOTE: 只输出报告不做断言，单核机器上体现不出读者之间的cache line争用
+TEST_F(RcuUnorderedMapPerfTest, ReaderScalingWithActiveWriter) {
+    std::cout << "Reader scaling (" << TOTAL_READS << " lookups, 1 writer thread active):\n";
+    for (size_t threads = 1; threads <= max_threads(); threads *= 2) {
+        rcu_unordered_map<int, int> rm;
+        concurrent_unordered_map<int, int> cm;
+        unordered_map<int, int> um;
+        for (int i = 0; i < KEY_RANGE; i += 2) {
+            rm.emplace(i, i);
+            cm.emplace(i, i);
+            um.emplace(i, i);
+        }
+
+        size_t rcu_writes = 0;
+        std::atomic<size_t> rcu_hits{0};
+        double rcu_time = measureReads(
+            threads,
+            [&](int key) {
+                if (rm.contains(key))
+                    rcu_hits.fetch_add(1, std::memory_order_relaxed);
+            },
+            [&](int key, uint32_t op) {
+                if (op == 0)
+                    rm.insert_or_assign(key, key + 1);
+                else if (op == 1)
+                    rm.erase(key);
+                else
+                    rm.emplace(key, key);
+            },
+            rcu_writes);
+
+        size_t sharded_writes = 0;
+        double sharded_time = measureReads(
+            threads, [&](int key) { cm.contains(key); },
+            [&](int key, uint32_t op) {
+                if (op == 0)
+                    cm.insert_or_assign(key, key + 1);
+                else if (op == 1)
+                    cm.erase(key);
+                else
+                    cm.emplace(key, key);
+            },
+            sharded_writes);
+
+        std::shared_mutex mutex;
+        size_t global_writes = 0;
+        double global_time = measureReads(
+            threads,
+            [&](int key) {
+                std::shared_lock<std::shared_mutex> lock(mutex);
+                um.count(key);
+            },
+            [&](int key, uint32_t op) {
+                std::unique_lock<std::shared_mutex> lock(mutex);
+                if (op == 0)
+                    um.insert_or_assign(key, key + 1);
+                else if (op == 1)
+                    um.erase(key);
+                else
+                    um.emplace(key, key);
+            },
+            global_writes);
+
+        std::cout << "readers: " << std::setw(2) << threads << std::fixed << std::setprecision(2)
+                  << " | rcu_unordered_map: " << std::setw(8) << rcu_time << " ms (" << rcu_writes
+                  << " writes)"
+                  << " | concurrent_unordered_map: " << std::setw(8) << sharded_time << " ms ("
+                  << sharded_writes << " writes)"
+                  << " | global rwlock: " << std::setw(8) << global_time << " ms (" << global_writes
+                  << " writes)\n";
+        EXPECT_GT(rcu_hits.load(), 0u);
+    }
+}
+
+} // namespace test
+} // namespace tiny_stl
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include "rcu_unordered_map.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class RcuUnorderedMapTest : public ::testing::Test {
+protected:
+    // 统计存活对象的个数，用来检查退休的结点最终都被释放
+    struct Counted {
+        static std::atomic<int> live;
+        int value;
+        explicit Counted(int v = 0) : value(v) { ++live; }
+        Counted(const Counted& other) : value(other.value) { ++live; }
+        Counted& operator=(const Counted& other) = default;
+        ~Counted() { --live; }
+    };
+
+    void TearDown() override { impl::epoch_domain::instance().reclaim(); }
+
+    // 所有读者都已经退出临界区，连续回收两次能把之前退休的对象全部释放
+    static void reclaimAll() {
+        impl::epoch_domain::instance().reclaim();
+        impl::epoch_domain::instance().reclaim();
+    }
+
+    template <typename Map>
+    static int valueOf(const Map& m, int key) {
+        int value = -1;
+        m.visit(key, [&](const typename Map::value_type& kv) { value = kv.second; });
+        return value;
+    }
+};
+
+std::atomic<int> RcuUnorderedMapTest::Counted::live{0};
+
+//======================================================//
+// basic test
+//======================================================//
+TEST_F(RcuUnorderedMapTest, InsertFindErase) {
+    rcu_unordered_map<int, int> m;
+    EXPECT_TRUE(m.empty());
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(m.emplace(i, i * 2));
+    }
+    EXPECT_FALSE(m.emplace(1, 0));
+    EXPECT_EQ(m.size(), 1000);
+    EXPECT_GE(m.bucket_count(), 1000);
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(valueOf(m, i), i * 2);
+    }
+    EXPECT_FALSE(m.contains(1000));
+
+    for (int i = 0; i < 1000; i += 2) {
+        EXPECT_EQ(m.erase(i), 1);
+    }
+    EXPECT_EQ(m.erase(0), 0);
+    EXPECT_EQ(m.size(), 500);
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(m.count(i), static_cast<size_t>(i % 2));
+    }
+}
+
+TEST_F(RcuUnorderedMapTest, AssignAndUpdate) {
+    rcu_unordered_map<std::string, std::string> m;
+    EXPECT_TRUE(m.insert({"a", "1"}));
+    EXPECT_TRUE(m.insert_or_assign("b", "2"));
+    EXPECT_FALSE(m.insert_or_assign("a", "3"));
+    EXPECT_TRUE(m.update("b", [](std::string& value) { value += "!"; }));
+    EXPECT_FALSE(m.update("c", [](std::string&) { FAIL(); }));
+
+    std::string seen;
+    m.visit("a", [&](const std::pair<std::string, std::string>& kv) { seen = kv.second; });
+    EXPECT_EQ(seen, "3");
+    m.visit("b", [&](const std::pair<std::string, std::string>& kv) { seen = kv.second; });
+    EXPECT_EQ(seen, "2!");
+    EXPECT_EQ(m.size(), 2);
+
+    m.clear();
+    EXPECT_TRUE(m.empty());
+    EXPECT_FALSE(m.contains("a"));
+}
+
+TEST_F(RcuUnorderedMapTest, CopyOnWriteKeepsChainIntact) {
+    // 所有key落在同一个桶里，删除/修改链中间的结点时前缀要被复制
+    struct SameHash {
+        size_t operator()(int) const { return 0; }
+    };
+    rcu_unordered_map<int, int, SameHash> m(1024);
+    for (int i = 0; i < 20; ++i) {
+        m.emplace(i, i);
+    }
+    EXPECT_TRUE(m.update(10, [](int& value) { value = 100; }));
+    EXPECT_EQ(m.erase(5), 1);
+    EXPECT_FALSE(m.insert_or_assign(0, -1));
+    EXPECT_EQ(m.size(), 19);
+    for (int i = 0; i < 20; ++i) {
+        int expected = i == 5 ? -1 : i == 10 ? 100 : i == 0 ? -1 : i;
+        ASSERT_EQ(valueOf(m, i), expected);
+    }
+}
+
+TEST_F(RcuUnorderedMapTest, RetiredNodesAreReclaimed) {
+    reclaimAll();
+    {
+        rcu_unordered_map<int, Counted> m;
+        for (int i = 0; i < 2000; ++i) {
+            m.emplace(i, i);
+        }
+        for (int i = 0; i < 2000; i += 3) {
+            m.update(i, [](Counted& c) { ++c.value; });
+        }
+        for (int i = 0; i < 2000; i += 2) {
+            m.erase(i);
+        }
+        reclaimAll();
+        EXPECT_EQ(impl::epoch_domain::instance().pending(), 0);
+        EXPECT_EQ(Counted::live.load(), static_cast<int>(m.size()));
+
+        // 读者还在临界区里时，退休的结点不能被释放
+        impl::epoch_domain::guard guard;
+        m.erase(1);
+        reclaimAll();
+        EXPECT_GT(impl::epoch_domain::instance().pending(), 0);
+        EXPECT_EQ(Counted::live.load(), static_cast<int>(m.size()) + 1);
+    }
+    reclaimAll();
+    EXPECT_EQ(Counted::live.load(), 0);
+}
+
+//======================================================//
+// concurrency test
+//======================================================//
+TEST_F(RcuUnorderedMapTest, ReadersSeeConsistentValuesDuringWrites) {
+    // 写者不停地改写value、删除重插、触发扩容；读者看到的value必须等于key的某个合法版本
+    rcu_unordered_map<int, int> m;
+    constexpr int KEYS = 2000;
+    for (int i = 0; i < KEYS; ++i) {
+        m.emplace(i, i);
+    }
+    std::atomic<bool> stop{false};
+    std::atomic<int> bad{0};
+    std::atomic<int> found{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&, t]() {
+            int key = t;
+            while (!stop.load(std::memory_order_relaxed)) {
+                key = (key + 7) % KEYS;
+                m.visit(key, [&](const std::pair<int, int>& kv) {
+                    if (kv.second % KEYS != kv.first)
+                        ++bad;
+                    ++found;
+                });
+            }
+        });
+    }
+    for (int round = 1; round <= 20; ++round) {
+        for (int i = 0; i < KEYS; ++i) {
+            m.insert_or_assign(i, i + round * KEYS);
+        }
+        for (int i = round % 2; i < KEYS; i += 2) {
+            m.erase(i);
+            m.emplace(i, i);
+        }
+        for (int i = 0; i < 200; ++i) {
+            m.emplace(KEYS * 100 + round * 200 + i, KEYS * 100 + round * 200 + i);
+        }
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(bad.load(), 0);
+    EXPECT_GT(found.load(), 0);
+    EXPECT_EQ(m.size(), static_cast<size_t>(KEYS + 20 * 200));
+}
+
+} // namespace test
+} // namespace tiny_stl
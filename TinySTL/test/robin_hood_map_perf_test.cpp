@@ -0,0 +1,166 @@
+#include "gtest/gtest.h"
+#include "flat_hash_map.h"
+#include "robin_hood_map.h"
+#include "unordered_map.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class RobinHoodMapPerfTest : public ::testing::Test {
+protected:
+    static constexpr int LOOKUP_ROUNDS = 10;
+
+    template <typename Fn>
+    static double measure(Fn fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    // 先插入keys，再对probes做LOOKUP_ROUNDS轮查找，返回查找耗时(ms)
+    template <typename Map>
+    static double missHeavyLookup(const std::vector<int>& keys, const std::vector<int>& probes,
+                                  size_t& hits) {
+        Map m;
+        for (int k : keys) {
+            m.emplace(k, k);
+        }
+        hits = 0;
+        return measure([&] {
+            for (int round = 0; round < LOOKUP_ROUNDS; ++round)
+                for (int k : probes) hits += m.count(k);
+        });
+    }
+
+    // 素数取模、平均链长为4的链式哈希表：桶分布再均匀，未命中也要走完整条链
+    struct long_chain_map
+        : unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                        std::allocator<std::pair<const int, int>>, hashtable_prime_policy> {
+        long_chain_map() { this->max_load_factor(4.0f); }
+    };
+
+    struct LookupTimes {
+        double robin;
+        double chained;  // long_chain_map
+        double std_map;
+    };
+
+    // 每10次查找只有1次命中
+    static LookupTimes compare(const char* name, const std::vector<int>& keys, const std::vector<int>& misses) {
+        std::vector<int> probes;
+        for (size_t i = 0; i < misses.size(); ++i) {
+            probes.push_back(i % 10 == 0 ? keys[i % keys.size()] : misses[i]);
+        }
+        size_t robin_hits, flat_hits, tiny_hits, chained_hits, std_hits;
+        LookupTimes times;
+        times.robin = missHeavyLookup<robin_hood_map<int, int>>(keys, probes, robin_hits);
+        double flat_time = missHeavyLookup<flat_hash_map<int, int>>(keys, probes, flat_hits);
+        double tiny_time = missHeavyLookup<unordered_map<int, int>>(keys, probes, tiny_hits);
+        times.chained = missHeavyLookup<long_chain_map>(keys, probes, chained_hits);
+        times.std_map = missHeavyLookup<std::unordered_map<int, int>>(keys, probes, std_hits);
+        EXPECT_EQ(robin_hits, std_hits);
+        EXPECT_EQ(flat_hits, std_hits);
+        EXPECT_EQ(tiny_hits, std_hits);
+        EXPECT_EQ(chained_hits, std_hits);
+
+        std::cout << std::setw(14) << name << " | robin_hood_map: " << std::setw(8) << std::fixed
+                  << std::setprecision(2) << times.robin << " ms"
+                  << " | flat_hash_map: " << std::setw(8) << flat_time << " ms"
+                  << " | unordered_map: " << std::setw(9) << tiny_time << " ms"
+                  << " | prime, load 4: " << std::setw(9) << times.chained << " ms"
+                  << " | std::unordered_map: " << std::setw(8) << times.std_map << " ms\n";
+        return times;
+    }
+
+    // 逐个count和按批contains_many的耗时(ms)
+    template <typename Map>
+    static std::pair<double, double> batchLookup(const Map& m, const std::vector<std::vector<int>>& batches) {
+        long long loop_hits = 0, batch_hits = 0;
+        double loop_time = measure([&] {
+            for (const auto& keys : batches)
+                for (int k : keys) loop_hits += m.count(k);
+        });
+        std::vector<bool> found(batches[0].size());
+        double batch_time = measure([&] {
+            for (const auto& keys : batches) {
+                m.contains_many(keys, found.begin());
+                for (size_t i = 0; i < keys.size(); ++i) batch_hits += found[i];
+            }
+        });
+        EXPECT_EQ(loop_hits, batch_hits);
+        return std::make_pair(loop_time, batch_time);
+    }
+};
+
+TEST_F(RobinHoodMapPerfTest, MissHeavyLookup) {
+    std::cout << "Miss-heavy lookup (" << LOOKUP_ROUNDS << " rounds, 90% misses):\n";
+
+    // 4K对齐的key（地址、分页id等）：std::hash<int>是恒等函数，低12位全为0；
+    // _hashtable默认的fibonacci策略乘法后取高位，这些key也能均匀地分到各个桶里，这里只输出做对照
+    const int aligned_count = 50000;
+    std::vector<int> aligned, aligned_misses;
+    for (int i = 0; i < aligned_count; ++i) {
+        aligned.push_back(i * 4096);
+        aligned_misses.push_back((i + aligned_count) * 4096);
+    }
+    compare("4K-aligned", aligned, aligned_misses);
+
+    const int random_count = 500000;
+    std::vector<int> random, random_misses;
+    std::mt19937 rng(3);
+    for (int i = 0; i < random_count; ++i) {
+        random.push_back(static_cast<int>(rng() >> 1) | 1);
+        random_misses.push_back(static_cast<int>(rng() >> 1) & ~1);
+    }
+    // 未命中时robin_hood_map碰到距离更短的槽就提前结束，链式哈希表要走完整条链；链越长差得越多
+    LookupTimes times = compare("random", random, random_misses);
+    EXPECT_LT(times.robin, times.std_map);
+    EXPECT_LT(times.robin, times.chained);
+}
+
+TEST_F(RobinHoodMapPerfTest, BatchLookupLargeTable) {
+    // 8M个槽远大于LLC，每次查找至少一次cache miss（flat_hash_map是控制字节加槽两次）
+    const int keys = 6000000;
+    const int probes = 2000000;
+    const size_t batch = 256;
+    std::mt19937 rng(43);
+    robin_hood_map<int, int> robin;
+    flat_hash_map<int, int> flat;
+    robin.reserve(keys);
+    flat.reserve(keys);
+    std::vector<int> inserted;
+    for (int i = 0; i < keys; ++i) {
+        inserted.push_back(static_cast<int>(rng() >> 1) | 1);
+        robin.emplace(inserted.back(), i);
+        flat.emplace(inserted.back(), i);
+    }
+    // 一半命中一半不命中
+    std::vector<std::vector<int>> batches(probes / batch, std::vector<int>(batch));
+    for (auto& keys_in_batch : batches) {
+        for (size_t i = 0; i < batch; ++i) {
+            keys_in_batch[i] = i % 2 ? inserted[rng() % inserted.size()] : static_cast<int>(rng() >> 1) & ~1;
+        }
+    }
+
+    std::cout << "Batch lookup (" << robin.size() << " int keys, " << batches.size() << " batches of "
+              << batch << ", 50% hits):\n";
+    const std::pair<const char*, std::pair<double, double>> results[] = {
+        {"robin_hood_map", batchLookup(robin, batches)}, {"flat_hash_map", batchLookup(flat, batches)}};
+    for (const auto& result : results) {
+        double loop_time = result.second.first, batch_time = result.second.second;
+        std::cout << std::setw(16) << result.first << " | count loop: " << std::setw(8) << std::fixed
+                  << std::setprecision(2) << loop_time << " ms | contains_many: " << std::setw(8)
+                  << batch_time << " ms | ratio: " << batch_time / loop_time << "x\n";
+        EXPECT_LT(batch_time, loop_time);
+    }
+}
+
+} // namespace test
+} // namespace tiny_stl
@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include "robin_hood_map.h"
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class RobinHoodMapTest : public ::testing::Test {
+protected:
+    template <typename Map, typename StdMap>
+    static void expectSameContent(const Map& m, const StdMap& expected) {
+        ASSERT_EQ(m.size(), expected.size());
+        size_t visited = 0;
+        for (const auto& kv : m) {
+            auto it = expected.find(kv.first);
+            ASSERT_NE(it, expected.end());
+            ASSERT_EQ(kv.second, it->second);
+            ++visited;
+        }
+        EXPECT_EQ(visited, expected.size());
+    }
+
+    // 只有几个不同的hash值，制造很长的探测序列
+    struct FewHashes {
+        size_t operator()(int key) const { return static_cast<size_t>(key % 4); }
+    };
+};
+
+//======================================================//
+// basic test
+//======================================================//
+TEST_F(RobinHoodMapTest, DefaultConstructor) {
+    robin_hood_map<int, int> m;
+    EXPECT_TRUE(m.empty());
+    EXPECT_EQ(m.size(), 0);
+    EXPECT_EQ(m.begin(), m.end());
+    EXPECT_EQ(m.find(1), m.end());
+    EXPECT_EQ(m.erase(1), 0);
+}
+
+TEST_F(RobinHoodMapTest, InsertAndAccess) {
+    robin_hood_map<std::string, std::string> m;
+    EXPECT_TRUE(m.emplace("b", "2").second);
+    EXPECT_TRUE(m.insert({"a", "1"}).second);
+    EXPECT_FALSE(m.emplace("b", "x").second);
+    m["c"] = "3";
+    EXPECT_EQ(m.size(), 3);
+    EXPECT_EQ(m["a"], "1");
+    EXPECT_EQ(m.at("b"), "2");
+    EXPECT_THROW(m.at("d"), std::out_of_range);
+    EXPECT_EQ(m.count("c"), 1);
+    EXPECT_FALSE(m.contains("d"));
+}
+
+TEST_F(RobinHoodMapTest, TryEmplaceDoesNotConstructOnHit) {
+    robin_hood_map<int, std::unique_ptr<int>> m;
+    EXPECT_TRUE(m.try_emplace(1, std::make_unique<int>(1)).second);
+    auto other = std::make_unique<int>(2);
+    EXPECT_FALSE(m.try_emplace(1, std::move(other)).second);
+    ASSERT_NE(other, nullptr);
+    EXPECT_EQ(*m[1], 1);
+}
+
+TEST_F(RobinHoodMapTest, ReturnedIteratorPointsToNewElement) {
+    robin_hood_map<int, int, FewHashes> m;
+    // 新元素会把已有元素挤走，返回的迭代器必须指向新元素本身
+    for (int i = 0; i < 200; ++i) {
+        auto result = m.emplace(i, i * 10);
+        ASSERT_TRUE(result.second);
+        ASSERT_EQ(result.first->first, i);
+        ASSERT_EQ(result.first->second, i * 10);
+    }
+}
+
+TEST_F(RobinHoodMapTest, BackwardShiftEraseWithLongProbes) {
+    robin_hood_map<int, int, FewHashes> m;
+    std::unordered_map<int, int> expected;
+    for (int i = 0; i < 300; ++i) {
+        m.emplace(i, i);
+        expected.emplace(i, i);
+    }
+    for (int i = 0; i < 300; i += 3) {
+        EXPECT_EQ(m.erase(i), 1);
+        expected.erase(i);
+    }
+    expectSameContent(m, expected);
+    for (int i = 0; i < 300; ++i) {
+        EXPECT_EQ(m.count(i), i % 3 == 0 ? 0u : 1u);
+    }
+}
+
+TEST_F(RobinHoodMapTest, RandomOperationsMatchStd) {
+    robin_hood_map<int, int> m;
+    std::unordered_map<int, int> expected;
+    std::mt19937 rng(17);
+    for (int i = 0; i < 200000; ++i) {
+        int key = static_cast<int>(rng() % 5000);
+        switch (rng() % 4) {
+        case 0:
+        case 1:
+            m[key] = i;
+            expected[key] = i;
+            break;
+        case 2:
+            ASSERT_EQ(m.erase(key), expected.erase(key));
+            break;
+        default:
+            ASSERT_EQ(m.count(key), expected.count(key));
+            break;
+        }
+        ASSERT_LE(m.load_factor(), m.max_load_factor());
+    }
+    expectSameContent(m, expected);
+}
+
+TEST_F(RobinHoodMapTest, CopyMoveAndClear) {
+    robin_hood_map<std::string, int> m{{"a", 1}, {"b", 2}, {"c", 3}};
+    robin_hood_map<std::string, int> copy(m);
+    EXPECT_EQ(copy.size(), 3);
+    EXPECT_EQ(copy["b"], 2);
+
+    robin_hood_map<std::string, int> moved(std::move(copy));
+    EXPECT_EQ(moved.size(), 3);
+    EXPECT_TRUE(copy.empty());
+    copy = moved;
+    EXPECT_EQ(copy.at("c"), 3);
+
+    m.clear();
+    EXPECT_TRUE(m.empty());
+    EXPECT_EQ(m.begin(), m.end());
+    m["d"] = 4;
+    EXPECT_EQ(m.size(), 1);
+
+    m.reserve(1000);
+    EXPECT_GE(m.bucket_count() * 9 / 10, 1000);
+    EXPECT_EQ(m.at("d"), 4);
+}
+
+TEST_F(RobinHoodMapTest, FindManyMatchesFind) {
+    robin_hood_map<int, int> m;
+    std::vector<int> keys{1, 2, 3};
+    std::vector<bool> found;
+    m.contains_many(keys, std::back_inserter(found));
+    EXPECT_EQ(found, std::vector<bool>(3, false));
+
+    for (int i = 0; i < 5000; i += 2) {
+        m.emplace(i, i * 3);
+    }
+    // 1001个key不是批大小的整数倍，最后一组不满
+    keys.clear();
+    for (int i = 0; i < 1001; ++i) {
+        keys.push_back((i * 7919) % 6000);
+    }
+    std::vector<robin_hood_map<int, int>::iterator> results(keys.size(), m.end());
+    EXPECT_EQ(m.find_many(keys, results.begin()), results.end());
+    found.clear();
+    m.contains_many(keys, std::back_inserter(found));
+    ASSERT_EQ(found.size(), keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        ASSERT_EQ(results[i], m.find(keys[i])) << keys[i];
+        ASSERT_EQ(found[i], m.count(keys[i]) == 1) << keys[i];
+        if (results[i] != m.end()) {
+            EXPECT_EQ(results[i]->second, keys[i] * 3);
+        }
+    }
+}
+
+} // namespace test
+} // namespace tiny_stl
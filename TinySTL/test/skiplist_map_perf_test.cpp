@@ -0,0 +1,100 @@
+#include "gtest/gtest.h"
+#include "skiplist_map.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class SkiplistMapPerfTest : public ::testing::Test {
+protected:
+    static constexpr size_t TOTAL_OPS = 1000000;
+    static constexpr int KEY_RANGE = 100000;
+
+    static size_t max_threads() {
+        return std::max<size_t>(2, std::min<size_t>(8, std::thread::hardware_concurrency()));
+    }
+
+    // thread_count个线程一共执行TOTAL_OPS次操作：80%查找，10%插入，10%删除，返回耗时(ms)
+    template <typename FindFn, typename InsertFn, typename EraseFn>
+    double measureMixed(size_t thread_count, FindFn find, InsertFn insert, EraseFn erase) {
+        std::vector<std::thread> threads;
+        size_t per_thread = TOTAL_OPS / thread_count;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&, per_thread, t]() {
+                uint32_t state = static_cast<uint32_t>(t * 2654435761u + 1);
+                for (size_t i = 0; i < per_thread; ++i) {
+                    state = state * 1664525u + 1013904223u;
+                    int key = static_cast<int>((state >> 8) % KEY_RANGE);
+                    uint32_t op = state % 10;
+                    if (op == 0) {
+                        insert(key);
+                    } else if (op == 1) {
+                        erase(key);
+                    } else {
+                        find(key);
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    }
+};
+
+TEST_F(SkiplistMapPerfTest, MixedWorkloadScaling) {
+    std::cout << "Mixed Workload (" << TOTAL_OPS << " ops, 80% find / 10% insert / 10% erase):\n";
+    for (size_t threads = 1; threads <= max_threads(); threads *= 2) {
+        skiplist_map<int, int> sm;
+        std::map<int, int> mm;
+        for (int i = 0; i < KEY_RANGE; i += 2) {
+            sm.emplace(i, i);
+            mm.emplace(i, i);
+        }
+
+        std::atomic<size_t> sm_hits{0};
+        double skiplist_time = measureMixed(
+            threads, [&](int key) { sm_hits += sm.contains(key); },
+            [&](int key) { sm.emplace(key, key); }, [&](int key) { sm.erase(key); });
+
+        std::mutex mutex;
+        std::atomic<size_t> mm_hits{0};
+        double mutex_time = measureMixed(
+            threads,
+            [&](int key) {
+                std::lock_guard<std::mutex> lock(mutex);
+                mm_hits += mm.count(key);
+            },
+            [&](int key) {
+                std::lock_guard<std::mutex> lock(mutex);
+                mm.emplace(key, key);
+            },
+            [&](int key) {
+                std::lock_guard<std::mutex> lock(mutex);
+                mm.erase(key);
+            });
+
+        std::cout << "threads: " << std::setw(2) << threads
+                  << " | skiplist_map: " << std::setw(8) << std::fixed
+                  << std::setprecision(2) << skiplist_time << " ms"
+                  << " | mutex + std::map: " << std::setw(8) << mutex_time << " ms"
+                  << " | Mops/s: " << std::setw(7) << TOTAL_OPS / skiplist_time / 1e3
+                  << " vs " << std::setw(7) << TOTAL_OPS / mutex_time / 1e3 << "\n";
+        if (threads == 1) {
+            EXPECT_EQ(sm.size(), mm.size());
+        }
+    }
+}
+
+} // namespace test
+} // namespace tiny_stl
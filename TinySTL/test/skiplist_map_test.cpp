@@ -0,0 +1,317 @@
+#include <gtest/gtest.h>
+#include "skiplist_map.h"
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class SkiplistMapTest : public ::testing::Test {
+protected:
+    static constexpr int THREAD_COUNT = 4;
+    static constexpr int PER_THREAD = 20000;
+
+    // 统计分配次数的分配器，检查结点通过传入的分配器分配和释放
+    template <typename T>
+    struct CountingAllocator {
+        using value_type = T;
+        std::shared_ptr<std::atomic<long>> live;
+
+        CountingAllocator() : live(std::make_shared<std::atomic<long>>(0)) {}
+        template <typename U>
+        CountingAllocator(const CountingAllocator<U>& other) : live(other.live) {}
+
+        T* allocate(size_t n) {
+            ++*live;
+            return std::allocator<T>().allocate(n);
+        }
+        void deallocate(T* p, size_t n) {
+            --*live;
+            std::allocator<T>().deallocate(p, n);
+        }
+    };
+};
+
+//======================================================//
+// basic test
+//======================================================//
+TEST_F(SkiplistMapTest, DefaultConstructor) {
+    skiplist_map<int, int> m;
+    EXPECT_TRUE(m.empty());
+    EXPECT_EQ(m.size(), 0);
+    EXPECT_EQ(m.begin(), m.end());
+    EXPECT_EQ(m.find(1), m.end());
+}
+
+TEST_F(SkiplistMapTest, InsertFindErase) {
+    skiplist_map<int, std::string> m;
+    EXPECT_TRUE(m.emplace(2, "two"));
+    EXPECT_TRUE(m.insert({1, "one"}));
+    EXPECT_FALSE(m.emplace(2, "again"));
+    EXPECT_EQ(m.size(), 2);
+    EXPECT_EQ(m.find(2)->second, "two");
+    EXPECT_TRUE(m.contains(1));
+
+    EXPECT_TRUE(m.erase(2));
+    EXPECT_FALSE(m.erase(2));
+    EXPECT_FALSE(m.contains(2));
+    EXPECT_EQ(m.size(), 1);
+
+    // 删除后重新插入得到新的值
+    EXPECT_TRUE(m.emplace(2, "new"));
+    EXPECT_EQ(m.find(2)->second, "new");
+    EXPECT_EQ(m.count(2), 1);
+}
+
+TEST_F(SkiplistMapTest, OrderedIterationSkipsDeleted) {
+    skiplist_map<int, int> m;
+    for (int i = 999; i >= 0; --i) {
+        m.emplace(i, i * 10);
+    }
+    for (int i = 0; i < 1000; i += 2) {
+        m.erase(i);
+    }
+    m.emplace(10, -1);  // 删除后重新插入
+    std::vector<int> keys;
+    for (const auto& kv : m) {
+        keys.push_back(kv.first);
+    }
+    EXPECT_EQ(keys.size(), 501);
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+    EXPECT_EQ(std::adjacent_find(keys.begin(), keys.end()), keys.end());
+    EXPECT_EQ(m.find(10)->second, -1);
+}
+
+TEST_F(SkiplistMapTest, RangeIteration) {
+    skiplist_map<std::string, int> m;
+    for (int i = 0; i < 100; ++i) {
+        m.emplace(std::to_string(1000 + i), i);
+    }
+    m.erase("1020");
+    EXPECT_EQ(m.lower_bound("1020")->first, "1021");
+
+    const std::string lower = "1010", upper = "1030";
+    int count = 0;
+    for (const auto& kv : m.range(lower, upper)) {
+        EXPECT_GE(kv.first, "1010");
+        EXPECT_LT(kv.first, "1030");
+        ++count;
+    }
+    EXPECT_EQ(count, 19);
+    const std::string far_lower = "2000", far_upper = "3000";
+    auto empty = m.range(far_lower, far_upper);
+    EXPECT_EQ(empty.begin(), empty.end());
+}
+
+TEST_F(SkiplistMapTest, RangeWithTemporaryBounds) {
+    skiplist_map<std::string, int> m;
+    for (int i = 100; i < 200; ++i) {
+        m.emplace("k" + std::to_string(i), i);
+    }
+    // 上界是临时对象，在range返回后就析构了，迭代器要自己保存一份
+    const std::string lower = "k120";
+    int count = 0;
+    for (const auto& kv : m.range(lower, std::string("k130"))) {
+        EXPECT_EQ(kv.second, 120 + count);
+        ++count;
+    }
+    EXPECT_EQ(count, 10);
+
+    skiplist_map<int, int> ints;
+    for (int i = 0; i < 50; ++i) {
+        ints.emplace(i, i);
+    }
+    auto r = ints.range(10, 20);
+    std::vector<int> keys;
+    for (const auto& kv : r) {
+        keys.push_back(kv.first);
+    }
+    EXPECT_EQ(keys.size(), 10);
+    EXPECT_EQ(keys.front(), 10);
+    EXPECT_EQ(keys.back(), 19);
+}
+
+TEST_F(SkiplistMapTest, UsesProvidedAllocator) {
+    using Alloc = CountingAllocator<std::pair<const int, std::string>>;
+    Alloc alloc;
+    {
+        skiplist_map<int, std::string, std::less<int>, Alloc> m(std::less<int>(), alloc);
+        for (int i = 0; i < 100; ++i) {
+            m.emplace(i, std::to_string(i));
+            m.erase(i / 2);
+        }
+        // 删除的结点等宽限期过后才释放；没有读者时回收一次就全部释放
+        impl::epoch_domain::instance().reclaim();
+        EXPECT_EQ(*alloc.live, 1 + 50);  // 头结点 + 剩下的50个结点
+    }
+    EXPECT_EQ(*alloc.live, 0);
+}
+
+TEST_F(SkiplistMapTest, ChurnReclaimsErasedNodes) {
+    using Alloc = CountingAllocator<std::pair<const int, std::string>>;
+    Alloc alloc;
+    {
+        skiplist_map<int, std::string, std::less<int>, Alloc> m(std::less<int>(), alloc);
+        for (int i = 0; i < 100; ++i) {
+            m.emplace(i, std::to_string(i));
+        }
+        long peak = 0;
+        for (int round = 0; round < 1000; ++round) {
+            for (int i = 0; i < 100; ++i) {
+                ASSERT_TRUE(m.erase(i));
+                ASSERT_TRUE(m.emplace(i, std::to_string(round)));
+            }
+            peak = std::max(peak, alloc.live->load());
+        }
+        // 10万次删除的结点都被摘下并回收，只有等待宽限期的一小批还没释放
+        EXPECT_LT(peak, 1 + 100 + 1000);
+        EXPECT_EQ(m.size(), 100);
+        EXPECT_EQ(m.find(42)->second, "999");
+        impl::epoch_domain::instance().reclaim();
+        EXPECT_EQ(*alloc.live, 1 + 100);
+    }
+    EXPECT_EQ(*alloc.live, 0);
+}
+
+//======================================================//
+// concurrent test
+//======================================================//
+TEST_F(SkiplistMapTest, ConcurrentInsertDisjointKeys) {
+    skiplist_map<int, int> m;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREAD_COUNT; ++t) {
+        threads.emplace_back([&m, t]() {
+            // 交错的key，让不同线程在相邻位置竞争
+            for (int i = 0; i < PER_THREAD; ++i) {
+                m.emplace(i * THREAD_COUNT + t, t);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(m.size(), THREAD_COUNT * PER_THREAD);
+    int expected = 0;
+    for (const auto& kv : m) {
+        ASSERT_EQ(kv.first, expected);
+        ASSERT_EQ(kv.second, expected % THREAD_COUNT);
+        ++expected;
+    }
+    EXPECT_EQ(expected, THREAD_COUNT * PER_THREAD);
+}
+
+TEST_F(SkiplistMapTest, ConcurrentInsertEraseSameKeys) {
+    skiplist_map<int, int> m;
+    constexpr int KEYS = 64;
+    std::atomic<int> inserted{0};
+    std::atomic<int> erased{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREAD_COUNT; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < PER_THREAD; ++i) {
+                int key = (i * 7 + t) % KEYS;
+                if ((i + t) % 2 == 0) {
+                    inserted += m.emplace(key, t);
+                } else {
+                    erased += m.erase(key);
+                }
+                m.contains(key);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    // 每个key的插入成功次数减删除成功次数就是它现在是否存在
+    int live = 0;
+    for (int key = 0; key < KEYS; ++key) {
+        live += m.contains(key);
+    }
+    EXPECT_EQ(inserted - erased, live);
+    EXPECT_EQ(static_cast<int>(m.size()), live);
+    int visited = 0;
+    for (auto it = m.begin(); it != m.end(); ++it) {
+        ++visited;
+    }
+    EXPECT_EQ(visited, live);
+}
+
+TEST_F(SkiplistMapTest, ConcurrentChurnWithReaders) {
+    using Alloc = CountingAllocator<std::pair<const int, int>>;
+    Alloc alloc;
+    {
+        skiplist_map<int, int, std::less<int>, Alloc> m(std::less<int>(), alloc);
+        constexpr int KEYS = 256;
+        for (int key = 0; key < KEYS; ++key) {
+            m.emplace(key, key);
+        }
+        std::atomic<bool> done{false};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 2; ++t) {
+            // 每个写者只删除再插入自己的key，所以结束后所有key都在
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    int key = (i * 2 + t) % KEYS;
+                    EXPECT_TRUE(m.erase(key));
+                    EXPECT_TRUE(m.emplace(key, i));
+                }
+            });
+        }
+        std::thread reader([&]() {
+            const int lower = 64, upper = 192;
+            while (!done) {
+                int prev = -1;
+                for (const auto& kv : m.range(lower, upper)) {
+                    ASSERT_GT(kv.first, prev);
+                    prev = kv.first;
+                }
+            }
+        });
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        done = true;
+        reader.join();
+        EXPECT_EQ(m.size(), KEYS);
+        impl::epoch_domain::instance().reclaim();
+        EXPECT_EQ(*alloc.live, 1 + KEYS);
+    }
+    EXPECT_EQ(*alloc.live, 0);
+}
+
+TEST_F(SkiplistMapTest, ReadersDuringInsert) {
+    skiplist_map<int, int> m;
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        for (int i = 0; i < PER_THREAD; ++i) {
+            m.emplace(i, i);
+        }
+        done = true;
+    });
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 2; ++t) {
+        readers.emplace_back([&]() {
+            while (!done) {
+                int prev = -1;
+                for (const auto& kv : m) {
+                    ASSERT_GT(kv.first, prev);
+                    ASSERT_EQ(kv.first, kv.second);
+                    prev = kv.first;
+                }
+            }
+        });
+    }
+    writer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(m.size(), PER_THREAD);
+}
+
+} // namespace test
+} // namespace tiny_stl
@@ -0,0 +1,383 @@
+#include "gtest/gtest.h"
+#include "unordered_map.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tiny_stl {
+namespace test {
+
+class UnorderedMapPerfTest : public ::testing::Test {
+protected:
+    static constexpr int LATENCY_KEYS = 10000000;
+    // 渐进式rehash单次插入的最坏延迟最多是p99的多少倍；剩下的只有缺页这类和元素个数无关的抖动
+    static constexpr uint64_t MAX_TO_P99 = 400;
+
+    struct LatencyStats {
+        uint64_t p50;
+        uint64_t p99;
+        uint64_t max;
+        double total_ms;
+    };
+
+    // 线程CPU时间(ns)：被调度出去的时间不算在单次插入里，max反映的是插入本身做了多少工作
+    static int64_t threadCpuNanos() {
+        timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+    // 逐个计时插入keys个元素，返回单次插入延迟的分位数(ns)
+    static LatencyStats measureInsertLatency(bool incremental, int keys) {
+        unordered_map<int, int> m;
+        m.set_incremental_rehash(incremental);
+        std::vector<uint32_t> latency(keys);
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < keys; ++i) {
+            int64_t start = threadCpuNanos();
+            m.emplace(i, i);
+            int64_t stop = threadCpuNanos();
+            latency[i] = static_cast<uint32_t>(std::min<int64_t>(UINT32_MAX, stop - start));
+        }
+        double total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        EXPECT_EQ(m.size(), static_cast<size_t>(keys));
+
+        LatencyStats stats;
+        stats.max = *std::max_element(latency.begin(), latency.end());
+        std::nth_element(latency.begin(), latency.begin() + keys / 2, latency.end());
+        stats.p50 = latency[keys / 2];
+        std::nth_element(latency.begin(), latency.begin() + keys / 100 * 99, latency.end());
+        stats.p99 = latency[keys / 100 * 99];
+        stats.total_ms = total;
+        return stats;
+    }
+
+    // 表能放进L2，查找的耗时主要是算桶下标和比较key，而不是cache miss
+    static constexpr int LOOKUP_KEYS = 16384;
+    static constexpr int LOOKUP_ROUNDS = 50;
+
+    template <typename Policy>
+    using policy_map = unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                                     std::allocator<std::pair<const int, int>>, Policy>;
+
+    template <typename Fn>
+    static double measure(Fn fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    // 插入keys后按打乱的顺序逐个查找，返回查找耗时(ms)
+    template <typename Map>
+    static double lookupTime(const std::vector<int>& keys, const std::vector<int>& order) {
+        Map m;
+        for (int k : keys) {
+            m.emplace(k, k);
+        }
+        long long sum = 0;
+        double time = measure([&] {
+            for (int round = 0; round < LOOKUP_ROUNDS; ++round)
+                for (int k : order) sum += m.find(k)->second;
+        });
+        long long expected = 0;
+        for (int k : order) {
+            expected += k;
+        }
+        EXPECT_EQ(sum, expected * LOOKUP_ROUNDS);
+        return time;
+    }
+
+    static void report(const char* mode, const LatencyStats& stats) {
+        std::cout << std::setw(12) << mode << " | p50: " << std::setw(6) << stats.p50 << " ns"
+                  << " | p99: " << std::setw(6) << stats.p99 << " ns"
+                  << " | max: " << std::setw(12) << stats.max << " ns"
+                  << " | total: " << std::fixed << std::setprecision(2) << stats.total_ms << " ms\n";
+    }
+};
+
+TEST_F(UnorderedMapPerfTest, InsertLatencyFullVsIncrementalRehash) {
+    std::cout << "Insert latency (" << LATENCY_KEYS << " int keys, max_load_factor 1.0):\n";
+    LatencyStats full = measureInsertLatency(false, LATENCY_KEYS);
+    report("full", full);
+    LatencyStats incremental = measureInsertLatency(true, LATENCY_KEYS);
+    report("incremental", incremental);
+
+    // 一次性rehash的最坏情况要搬迁所有结点；渐进式扩容只映射新表，搬迁和旧表的归还都分摊到之后的插入上，
+    // 最坏情况不能再随元素个数增长
+    EXPECT_LT(incremental.max, full.max);
+    EXPECT_LT(incremental.max, incremental.p99 * MAX_TO_P99);
+}
+
+TEST_F(UnorderedMapPerfTest, LookupByBucketPolicy) {
+    std::vector<int> sequential, strided, random;
+    std::mt19937 rng(9);
+    for (int i = 0; i < LOOKUP_KEYS; ++i) {
+        sequential.push_back(i);
+        strided.push_back(i * 4096);  // NOTE: 16384 * 4096正好不溢出int
+        random.push_back(static_cast<int>(rng() >> 1));
+    }
+    std::sort(random.begin(), random.end());
+    random.erase(std::unique(random.begin(), random.end()), random.end());
+
+    std::cout << "Lookup by bucket policy (" << LOOKUP_KEYS << " int keys x " << LOOKUP_ROUNDS
+              << " rounds, std::hash<int>):\n";
+    const std::pair<const char*, const std::vector<int>*> patterns[] = {
+        {"sequential", &sequential}, {"strided 4096", &strided}, {"random", &random}};
+    for (const auto& pattern : patterns) {
+        const std::vector<int>& keys = *pattern.second;
+        std::vector<int> order(keys);
+        std::shuffle(order.begin(), order.end(), rng);
+        double prime = lookupTime<policy_map<hashtable_prime_policy>>(keys, order);
+        double fibonacci = lookupTime<policy_map<hashtable_fibonacci_policy>>(keys, order);
+        double avalanche = lookupTime<policy_map<hashtable_avalanche_policy>>(keys, order);
+        double std_time = lookupTime<std::unordered_map<int, int>>(keys, order);
+        std::cout << std::setw(13) << pattern.first << " | prime: " << std::setw(7) << std::fixed
+                  << std::setprecision(2) << prime << " ms | fibonacci: " << std::setw(7) << fibonacci
+                  << " ms | avalanche: " << std::setw(7) << avalanche
+                  << " ms | std::unordered_map: " << std::setw(7) << std_time << " ms\n";
+    }
+}
+
+TEST_F(UnorderedMapPerfTest, TransparentTokenLookup) {
+    // 词表里都是超过SSO长度的标识符，构造临时std::string一定会分配内存
+    const int vocabulary = 5000;
+    const int tokens = 1000000;
+    std::vector<std::string> words;
+    for (int i = 0; i < vocabulary; ++i) {
+        words.push_back("identifier_name_" + std::to_string(i));
+    }
+    std::string buffer;
+    std::mt19937 rng(13);
+    for (int i = 0; i < tokens; ++i) {
+        buffer += words[rng() % vocabulary];
+        buffer += i % 2 ? " unknown_identifier_name " : " ";
+    }
+
+    unordered_map<std::string, int> plain;
+    unordered_map<std::string, int, transparent_string_hash, std::equal_to<>> transparent;
+    for (int i = 0; i < vocabulary; ++i) {
+        plain.emplace(words[i], i);
+        transparent.emplace(words[i], i);
+    }
+
+    // 按空格切分buffer，每个token查一次表
+    auto parse = [&](auto lookup) {
+        long long sum = 0;
+        std::string_view rest(buffer);
+        while (!rest.empty()) {
+            size_t end = rest.find(' ');
+            std::string_view token = rest.substr(0, end);
+            sum += lookup(token);
+            rest.remove_prefix(end == std::string_view::npos ? rest.size() : end + 1);
+        }
+        return sum;
+    };
+
+    long long plain_sum = 0, transparent_sum = 0;
+    double plain_time = measure([&] {
+        plain_sum = parse([&](std::string_view token) {
+            auto it = plain.find(std::string(token));
+            return it == plain.end() ? -1 : it->second;
+        });
+    });
+    double transparent_time = measure([&] {
+        transparent_sum = parse([&](std::string_view token) {
+            auto it = transparent.find(token);
+            return it == transparent.end() ? -1 : it->second;
+        });
+    });
+    EXPECT_EQ(plain_sum, transparent_sum);
+
+    std::cout << "Token lookup (" << buffer.size() / 1024 / 1024 << " MB buffer, " << tokens * 3 / 2
+              << " tokens):\n"
+              << "  std::string temporary: " << std::fixed << std::setprecision(2) << plain_time << " ms\n"
+              << "  transparent lookup:    " << transparent_time << " ms"
+              << " | ratio: " << transparent_time / plain_time << "x\n";
+    EXPECT_LT(transparent_time, plain_time);
+}
+
+TEST_F(UnorderedMapPerfTest, DuplicateHeavyInsert) {
+    // 2M次插入只有50k个不同的key，97.5%的插入都是重复的
+    const int inserts = 2000000;
+    const int distinct = 50000;
+    std::vector<std::string> keys;
+    std::mt19937 rng(21);
+    for (int i = 0; i < inserts; ++i) {
+        keys.push_back("session_" + std::to_string(rng() % distinct));
+    }
+
+    unordered_map<std::string, int> emplaced, tried, counted;
+    std::unordered_map<std::string, int> std_tried;
+    double emplace_time = measure([&] { for (const auto& k : keys) emplaced.emplace(k, 1); });
+    double try_time = measure([&] { for (const auto& k : keys) tried.try_emplace(k, 1); });
+    double bracket_time = measure([&] { for (const auto& k : keys) ++counted[k]; });
+    double std_time = measure([&] { for (const auto& k : keys) std_tried.try_emplace(k, 1); });
+    EXPECT_EQ(emplaced.size(), std_tried.size());
+    EXPECT_EQ(tried.size(), std_tried.size());
+    EXPECT_EQ(counted.size(), std_tried.size());
+
+    std::cout << "Duplicate-heavy insert (" << inserts << " inserts, " << std_tried.size()
+              << " distinct string keys):\n"
+              << std::fixed << std::setprecision(2)
+              << "  emplace:                        " << std::setw(8) << emplace_time << " ms\n"
+              << "  try_emplace:                    " << std::setw(8) << try_time << " ms\n"
+              << "  ++operator[]:                   " << std::setw(8) << bracket_time << " ms\n"
+              << "  std::unordered_map try_emplace: " << std::setw(8) << std_time << " ms\n";
+    // emplace只有构造出元素才能拿到key，重复时白白分配、构造再销毁一个结点
+    EXPECT_LT(try_time, emplace_time);
+}
+
+TEST_F(UnorderedMapPerfTest, StringKeysCachedHash) {
+    // 同样长度、共享很长前缀的路径，比较两个key要扫过整个前缀
+    const int keys = 200000;
+    const float load_factor = 4.0f;  // NOTE: 桶链平均长度为4，放大每次探测的key比较
+    std::vector<std::string> present, missing;
+    for (int i = 0; i < keys; ++i) {
+        present.push_back("/api/v1/tenants/default/resources/items/" + std::to_string(1000000 + i));
+        missing.push_back("/api/v1/tenants/default/resources/items/" + std::to_string(2000000 + i));
+    }
+    std::mt19937 rng(37);
+    std::shuffle(present.begin(), present.end(), rng);
+
+    auto run = [&](auto& m, double& insert_time, double& hit_time, double& miss_time) {
+        m.max_load_factor(load_factor);
+        insert_time = measure([&] { for (const auto& k : present) m.emplace(k, 1); });
+        long long hits = 0;
+        hit_time = measure([&] { for (const auto& k : present) hits += m.count(k); });
+        miss_time = measure([&] { for (const auto& k : missing) hits += m.count(k); });
+        EXPECT_EQ(hits, keys);
+    };
+
+    using cached_map = unordered_map<std::string, int, std::hash<std::string>, std::equal_to<std::string>,
+                                     std::allocator<std::pair<const std::string, int>>,
+                                     hashtable_fibonacci_policy, true>;
+    using uncached_map = unordered_map<std::string, int, std::hash<std::string>, std::equal_to<std::string>,
+                                       std::allocator<std::pair<const std::string, int>>,
+                                       hashtable_fibonacci_policy, false>;
+    cached_map cached;
+    uncached_map uncached;
+    double cached_insert, cached_hit, cached_miss;
+    double uncached_insert, uncached_hit, uncached_miss;
+    run(cached, cached_insert, cached_hit, cached_miss);
+    run(uncached, uncached_insert, uncached_hit, uncached_miss);
+
+    std::cout << "String keys (" << keys << " paths, " << present[0].size()
+              << " chars, max_load_factor " << load_factor << "):\n"
+              << std::fixed << std::setprecision(2)
+              << "           | insert+rehash | hit lookup | miss lookup\n"
+              << "  cached   | " << std::setw(10) << cached_insert << " ms | " << std::setw(7) << cached_hit
+              << " ms | " << std::setw(8) << cached_miss << " ms\n"
+              << "  uncached | " << std::setw(10) << uncached_insert << " ms | " << std::setw(7)
+              << uncached_hit << " ms | " << std::setw(8) << uncached_miss << " ms\n";
+    // 未命中时每个结点都要比较整个前缀，缓存hash后几乎都在比较hash这一步被排除
+    EXPECT_LT(cached_miss, uncached_miss);
+}
+
+TEST_F(UnorderedMapPerfTest, BatchLookupLargeTable) {
+    // 4M个结点随机分布在远大于LLC的内存里，每次查找都是桶和结点两次cache miss
+    const int keys = 4000000;
+    const int probes = 2000000;
+    std::mt19937 rng(41);
+    unordered_map<int, int> m;
+    m.reserve(keys);
+    std::vector<int> inserted;
+    for (int i = 0; i < keys; ++i) {
+        inserted.push_back(static_cast<int>(rng() >> 1) | 1);
+        m.emplace(inserted.back(), i);
+    }
+    // 一半命中一半不命中，按请求的批大小切好
+    std::vector<int> flat_probes;
+    for (int i = 0; i < probes; ++i) {
+        flat_probes.push_back(i % 2 ? inserted[rng() % inserted.size()] : static_cast<int>(rng() >> 1) & ~1);
+    }
+
+    std::cout << "Batch lookup (" << m.size() << " int keys, " << probes << " probes, 50% hits):\n";
+    for (size_t batch : {64, 256, 1024}) {
+        std::vector<std::vector<int>> batches;
+        for (size_t i = 0; i < flat_probes.size(); i += batch) {
+            batches.emplace_back(flat_probes.begin() + i,
+                                 flat_probes.begin() + std::min(i + batch, flat_probes.size()));
+        }
+        long long loop_hits = 0, batch_hits = 0;
+        double loop_time = measure([&] {
+            for (const auto& keys_in_batch : batches)
+                for (int k : keys_in_batch) loop_hits += m.count(k);
+        });
+        std::vector<bool> found(batch);
+        double batch_time = measure([&] {
+            for (const auto& keys_in_batch : batches) {
+                m.contains_many(keys_in_batch, found.begin());
+                for (size_t i = 0; i < keys_in_batch.size(); ++i) batch_hits += found[i];
+            }
+        });
+        EXPECT_EQ(loop_hits, batch_hits);
+        std::cout << "  batch " << std::setw(4) << batch << " | count loop: " << std::setw(8) << std::fixed
+                  << std::setprecision(2) << loop_time << " ms | contains_many: " << std::setw(8)
+                  << batch_time << " ms | ratio: " << batch_time / loop_time << "x\n";
+        // 一组16个key的桶和首结点同时预取，cache miss互相重叠
+        EXPECT_LT(batch_time, loop_time);
+    }
+}
+
+TEST_F(UnorderedMapPerfTest, FullScanSparseTable) {
+    // 先装满再删掉绝大部分元素：桶数组还是很大，但几乎全是空桶
+    const int keys = 4000000;
+    const int kept = 40000;
+    unordered_map<int, int> tiny;
+    std::unordered_map<int, int> std_map;
+    tiny.reserve(keys);
+    std_map.reserve(keys);
+    for (int i = 0; i < keys; ++i) {
+        tiny.emplace(i, i);
+        std_map.emplace(i, i);
+    }
+    for (int i = 0; i < keys; ++i) {
+        if (i % (keys / kept) != 0) {
+            tiny.erase(i);
+            std_map.erase(i);
+        }
+    }
+
+    long long tiny_sum = 0, std_sum = 0, bucket_sum = 0;
+    const int rounds = 10;
+    double tiny_time = measure([&] {
+        for (int round = 0; round < rounds; ++round)
+            for (const auto& kv : tiny) tiny_sum += kv.second;
+    });
+    // 对照：不用位图，逐个桶检查是否为空（begin()原来的做法）
+    std::vector<const int*> buckets(tiny.bucket_count(), nullptr);
+    for (const auto& kv : tiny) {
+        buckets[static_cast<size_t>(kv.first) * 2654435761u % buckets.size()] = &kv.second;
+    }
+    double bucket_time = measure([&] {
+        for (int round = 0; round < rounds; ++round)
+            for (const int* p : buckets)
+                if (p) bucket_sum += *p;
+    });
+    double std_time = measure([&] {
+        for (int round = 0; round < rounds; ++round)
+            for (const auto& kv : std_map) std_sum += kv.second;
+    });
+    EXPECT_EQ(tiny_sum, std_sum);
+
+    std::cout << "Full scan (" << tiny.size() << " elements in " << tiny.bucket_count() << " buckets, load factor "
+              << std::setprecision(4) << tiny.load_factor() << ", " << rounds << " rounds):\n"
+              << std::fixed << std::setprecision(2)
+              << "  unordered_map (bitmap):      " << std::setw(8) << tiny_time << " ms\n"
+              << "  bucket-by-bucket scan:       " << std::setw(8) << bucket_time << " ms\n"
+              << "  std::unordered_map:          " << std::setw(8) << std_time << " ms\n";
+    // 位图一次跳过64个空桶，不用读桶数组本身
+    EXPECT_LT(tiny_time, bucket_time);
+}
+
+} // namespace test
+} // namespace tiny_stl
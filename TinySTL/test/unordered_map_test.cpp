@@ -1,7 +1,12 @@
 #include <gtest/gtest.h>
 #include "unordered_map.h"
+#include <algorithm>
 #include <string>
+#include <string_view>
+#include <iterator>
 #include <memory>
+#include <numeric>
+#include <vector>
 
 namespace tiny_stl {
 namespace test {
@@ -32,8 +37,84 @@ protected:
         ComplexValue() : data(new int[10]), name("default") {}
         ComplexValue(std::string n) : data(new int[10]), name(std::move(n)) {}
     };
+
+    // 记录hasher和key_equal的调用次数
+    static size_t hash_calls;
+    static size_t equal_calls;
+
+    struct CountingHash {
+        size_t operator()(const std::string& key) const {
+            ++hash_calls;
+            return std::hash<std::string>()(key);
+        }
+    };
+
+    struct CountingEqual {
+        bool operator()(const std::string& lhs, const std::string& rhs) const {
+            ++equal_calls;
+            return lhs == rhs;
+        }
+    };
+
+    template <bool CacheHash>
+    using counting_map = unordered_map<std::string, int, CountingHash, CountingEqual,
+                                       std::allocator<std::pair<const std::string, int>>,
+                                       hashtable_fibonacci_policy, CacheHash>;
+
+    // 4K对齐的key在各种策略下都要能正确插入和查找
+    template <typename Policy>
+    static void checkBucketPolicy(bool power_of_two) {
+        unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                      std::allocator<std::pair<const int, int>>, Policy> m;
+        for (int i = 0; i < 10000; ++i) {
+            m.emplace(i * 4096, i);
+        }
+        size_t buckets = m.bucket_count();
+        EXPECT_EQ((buckets & (buckets - 1)) == 0, power_of_two);
+        for (int i = 0; i < 10000; ++i) {
+            ASSERT_EQ(m.at(i * 4096), i);
+        }
+        EXPECT_EQ(m.count(4095), 0);
+    }
+
+    // 刚扩容时大部分结点还在旧表里，用it = erase(it)边遍历边删除，每个结点恰好被访问一次
+    template <typename Policy>
+    static void checkEraseWhileIterating() {
+        unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                      std::allocator<std::pair<const int, int>>, Policy> m;
+        m.set_incremental_rehash(true);
+        int n = 0;
+        for (; n < 1000; ++n) {
+            m.emplace(n, n);
+        }
+        size_t buckets = m.bucket_count();
+        for (; m.bucket_count() == buckets; ++n) {
+            m.emplace(n, n);
+        }
+
+        std::vector<int> visited;
+        for (auto it = m.begin(); it != m.end();) {
+            visited.push_back(it->first);
+            if (it->first % 2 == 0) {
+                it = m.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        std::sort(visited.begin(), visited.end());
+        std::vector<int> expected(n);
+        std::iota(expected.begin(), expected.end(), 0);
+        EXPECT_EQ(visited, expected);
+        EXPECT_EQ(m.size(), static_cast<size_t>(n / 2));
+        for (int i = 0; i < n; ++i) {
+            ASSERT_EQ(m.count(i), i % 2 == 0 ? 0u : 1u);
+        }
+    }
 };
 
+size_t UnorderedMapTest::hash_calls = 0;
+size_t UnorderedMapTest::equal_calls = 0;
+
 //======================================================//
 // basic test
 //======================================================//
@@ -109,23 +190,367 @@ TEST_F(UnorderedMapTest, FindAndCount) {
 }
 
 TEST_F(UnorderedMapTest, RehashAndBucketInterface) {
-    // unordered_map<int, ComplexValue> m;
+    unordered_map<int, ComplexValue> m;
     
-    // // Insert enough elements to trigger rehash
-    // for(int i = 0; i < 100; ++i) {
-    //     m.emplace(i, ComplexValue(std::to_string(i)));
-    // }
+    // Insert enough elements to trigger rehash
+    for(int i = 0; i < 1000; ++i) {
+        m.emplace(i, ComplexValue(std::to_string(i)));
+    }
     
-    // // Check bucket interface
-    // EXPECT_GT(m.bucket_count(), 0);
-    // for(size_t i = 0; i < m.bucket_count(); ++i) {
-    //     EXPECT_LE(m.bucket_size(i), m.max_bucket_size());
-    // }
+    // Check bucket interface
+    EXPECT_GE(m.bucket_count(), 1000);
+    EXPECT_LE(m.load_factor(), m.max_load_factor());
+    for(int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(m.at(i).name, std::to_string(i));
+    }
     
-    // // Force rehash
-    // m.rehash(200);
-    // EXPECT_GE(m.bucket_count(), 200);
+    // Force rehash
+    m.rehash(4000);
+    EXPECT_GE(m.bucket_count(), 4000);
+    EXPECT_EQ(m.size(), 1000);
+    EXPECT_EQ(m.count(999), 1);
+
+    // rehash never shrinks below size / max_load_factor
+    m.rehash(10);
+    EXPECT_GE(m.bucket_count(), 1000);
+    EXPECT_EQ(m[500].name, "500");
+}
+
+TEST_F(UnorderedMapTest, EraseByKeyKeepsCollidingKeys) {
+    // 素数取模时key和key + bucket_count一定落在同一个桶
+    unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                  std::allocator<std::pair<const int, int>>, hashtable_prime_policy> m;
+    size_t buckets = m.bucket_count();
+    m.emplace(1, 1);
+    m.emplace(1 + static_cast<int>(buckets), 2);
+    EXPECT_EQ(m.erase(1), 1);
+    EXPECT_EQ(m.erase(1), 0);
+    EXPECT_EQ(m.size(), 1);
+    EXPECT_EQ(m.count(1 + static_cast<int>(buckets)), 1);
+}
+
+TEST_F(UnorderedMapTest, BucketPolicies) {
+    checkBucketPolicy<hashtable_prime_policy>(false);
+    checkBucketPolicy<hashtable_fibonacci_policy>(true);
+    checkBucketPolicy<hashtable_avalanche_policy>(true);
+
+    EXPECT_EQ(hashtable_prime_policy::bucket_count(100), 193u);
+    EXPECT_EQ(hashtable_fibonacci_policy::bucket_count(100), 128u);
+    // 低位完全相同的key也要分散到不同的桶
+    EXPECT_NE(hashtable_fibonacci_policy::index(1 << 20, 1024),
+              hashtable_fibonacci_policy::index(2 << 20, 1024));
+    EXPECT_NE(hashtable_avalanche_policy::index(1 << 20, 1024),
+              hashtable_avalanche_policy::index(2 << 20, 1024));
+}
+
+TEST_F(UnorderedMapTest, TransparentLookup) {
+    unordered_map<std::string, int, transparent_string_hash, std::equal_to<>> m;
+    m.emplace("alpha", 1);
+    m.emplace("beta", 2);
+    m.emplace("gamma", 3);
+
+    const char buffer[] = "alpha beta delta";
+    std::string_view alpha(buffer, 5), beta(buffer + 6, 4), delta(buffer + 11, 5);
+    auto it = m.find(alpha);
+    ASSERT_NE(it, m.end());
+    EXPECT_EQ(it->second, 1);
+    EXPECT_EQ(m.find(delta), m.end());
+    EXPECT_EQ(m.count(beta), 1);
+    EXPECT_EQ(m.count("gamma"), 1);
+    EXPECT_EQ(m.at(beta), 2);
+    EXPECT_THROW(m.at(delta), std::out_of_range);
+    EXPECT_EQ(m.erase(beta), 1);
+    EXPECT_EQ(m.erase(beta), 0);
+    EXPECT_EQ(m.size(), 2);
+
+    // key_type本身仍然走原来的重载
+    EXPECT_EQ(m.count(std::string("alpha")), 1);
+    m.erase(m.find(std::string("gamma")));
+    EXPECT_EQ(m.size(), 1);
+
+    static_assert(hashtable_is_transparent<transparent_string_hash, std::equal_to<>>::value, "");
+    static_assert(!hashtable_is_transparent<std::hash<std::string>, std::equal_to<>>::value, "");
+    static_assert(!hashtable_is_transparent<transparent_string_hash, std::equal_to<std::string>>::value, "");
+}
+
+TEST_F(UnorderedMapTest, TryEmplaceAndInsertOrAssign) {
+    unordered_map<std::string, std::unique_ptr<int>> m;
+    auto one = std::make_unique<int>(1);
+    auto result = m.try_emplace("a", std::move(one));
+    EXPECT_TRUE(result.second);
+    EXPECT_EQ(*result.first->second, 1);
+
+    // key已存在时参数不会被移走
+    auto two = std::make_unique<int>(2);
+    result = m.try_emplace("a", std::move(two));
+    EXPECT_FALSE(result.second);
+    ASSERT_NE(two, nullptr);
+    EXPECT_EQ(*m["a"], 1);
+
+    result = m.insert_or_assign("a", std::move(two));
+    EXPECT_FALSE(result.second);
+    EXPECT_EQ(two, nullptr);
+    EXPECT_EQ(*m["a"], 2);
+
+    std::string key = "b";
+    result = m.insert_or_assign(key, std::make_unique<int>(3));
+    EXPECT_TRUE(result.second);
+    EXPECT_EQ(*m.at("b"), 3);
+    EXPECT_EQ(m.size(), 2);
+
+    // operator[]只在插入时默认构造value
+    EXPECT_EQ(m[key].get(), result.first->second.get());
+    EXPECT_EQ(m["c"], nullptr);
+    EXPECT_EQ(m.size(), 3);
+}
+
+TEST_F(UnorderedMapTest, DuplicateInsertDestroysNode) {
+    struct Counted {
+        int* live;
+        explicit Counted(int* l) : live(l) { ++*live; }
+        Counted(const Counted& other) : live(other.live) { ++*live; }
+        ~Counted() { --*live; }
+    };
+    int live = 0;
+    {
+        unordered_map<int, Counted> m;
+        Counted value(&live);
+        for (int round = 0; round < 3; ++round) {
+            for (int i = 0; i < 100; ++i) {
+                m.emplace(i, value);
+                m.insert({i, value});
+                m.try_emplace(i, value);
+            }
+        }
+        EXPECT_EQ(m.size(), 100);
+        // 100个元素加上value本身
+        EXPECT_EQ(live, 101);
+    }
+    EXPECT_EQ(live, 0);
+}
+
+TEST_F(UnorderedMapTest, IncrementalRehash) {
+    unordered_map<int, int> m;
+    m.set_incremental_rehash(true);
+    EXPECT_TRUE(m.incremental_rehash());
+
+    // 迁移过程中插入、查找、删除都要同时看到新旧两张表
+    const int n = 20000;
+    for (int i = 0; i < n; ++i) {
+        m.emplace(i, i * 2);
+        ASSERT_EQ(m.count(i / 2), 1) << i;
+        if (i % 7 == 0) {
+            EXPECT_EQ(m.erase(i / 2), 1);
+            m.emplace(i / 2, i / 2 * 2);
+            EXPECT_EQ(m.at(i / 2), i / 2 * 2);
+        }
+    }
+    EXPECT_EQ(m.size(), n);
+    EXPECT_GE(m.bucket_count(), n);
+    for (int i = 0; i < n; i += 3) {
+        auto it = m.find(i);
+        ASSERT_NE(it, m.end());
+        m.erase(it);
+    }
+    for (int i = 0; i < n; ++i) {
+        EXPECT_EQ(m.count(i), i % 3 == 0 ? 0u : 1u);
+    }
+
+    // 关闭时把剩下的旧桶一次搬完
+    m.set_incremental_rehash(false);
+    for (int i = 1; i < n; i += 3) {
+        EXPECT_EQ(m.at(i), i * 2);
+    }
+
+    unordered_map<int, int> copy(m);
+    m.clear();
+    EXPECT_TRUE(m.empty());
+    EXPECT_EQ(copy.size(), n - (n + 2) / 3);
+    EXPECT_EQ(copy.count(2), 1);
+}
+
+TEST_F(UnorderedMapTest, CachedHashCodes) {
+    static_assert(!unordered_map<int, int>::cache_hash, "int keys should not cache hash");
+    static_assert(unordered_map<std::string, int>::cache_hash, "string keys should cache hash");
+    static_assert(unordered_map<int, int, ComplexKeyHash>::cache_hash, "custom hash should cache");
+
+    counting_map<true> cached;
+    counting_map<false> uncached;
+    for (int i = 0; i < 1000; ++i) {
+        cached.emplace("key" + std::to_string(i), i);
+        uncached.emplace("key" + std::to_string(i), i);
+    }
+
+    // rehash直接用结点里的hash，不再调用hasher
+    hash_calls = 0;
+    cached.rehash(cached.bucket_count() * 4);
+    EXPECT_EQ(hash_calls, 0);
+    uncached.rehash(uncached.bucket_count() * 4);
+    EXPECT_EQ(hash_calls, 1000);
+
+    // hash不相等时不比较key：查找不存在的key一次equal都不调用
+    equal_calls = 0;
+    for (int i = 1000; i < 2000; ++i) {
+        EXPECT_EQ(cached.count("key" + std::to_string(i)), 0);
+    }
+    EXPECT_EQ(equal_calls, 0);
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(cached.at("key" + std::to_string(i)), i);
+    }
+    EXPECT_EQ(equal_calls, 1000);
+
+    // 渐进式rehash搬迁结点时也不调用hasher
+    cached.set_incremental_rehash(true);
+    for (int i = 1000; i < 5000; ++i) {
+        cached.emplace("key" + std::to_string(i), i);
+    }
+    hash_calls = 0;
+    cached.set_incremental_rehash(false);
+    EXPECT_EQ(hash_calls, 0);
+    EXPECT_EQ(cached.erase("key42"), 1);
+    EXPECT_EQ(cached.size(), 4999);
+    EXPECT_EQ(cached.at("key4999"), 4999);
+}
+
+TEST_F(UnorderedMapTest, FindManyMatchesFind) {
+    unordered_map<std::string, int> m;
+    m.set_incremental_rehash(true);
+    std::vector<std::string> keys;
+    for (int i = 0; i < 3000; ++i) {
+        keys.push_back("key" + std::to_string(i));
+        if (i % 3 != 0) {
+            m.emplace(keys.back(), i);
+        }
+    }
+    // 刚扩容时旧表几乎还没搬，批量查找也要同时看新旧两张表
+    size_t buckets = m.bucket_count();
+    while (m.bucket_count() == buckets) {
+        m.emplace("filler" + std::to_string(m.size()), -1);
+    }
+    std::vector<unordered_map<std::string, int>::iterator> results;
+    m.find_many(keys, std::back_inserter(results));
+    std::vector<bool> found(keys.size());
+    m.contains_many(keys, found.begin());
+    ASSERT_EQ(results.size(), keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        ASSERT_EQ(results[i], m.find(keys[i])) << keys[i];
+        ASSERT_EQ(found[i], i % 3 != 0) << keys[i];
+        if (found[i]) {
+            EXPECT_EQ(results[i]->second, static_cast<int>(i));
+        }
+    }
+
+    // 透明查找的map可以直接用string_view批量查
+    unordered_map<std::string, int, transparent_string_hash, std::equal_to<>> transparent;
+    transparent.emplace("alpha", 1);
+    std::vector<std::string_view> views{"alpha", "beta"};
+    std::vector<bool> view_found;
+    transparent.contains_many(views, std::back_inserter(view_found));
+    EXPECT_EQ(view_found, (std::vector<bool>{true, false}));
+}
+
+TEST_F(UnorderedMapTest, ForwardIteration) {
+    unordered_map<int, int> m;
+    EXPECT_EQ(m.begin(), m.end());
+    EXPECT_EQ(m.cbegin(), m.cend());
+
+    const int n = 5000;
+    for (int i = 0; i < n; ++i) {
+        m.emplace(i, i);
+    }
+    // 通过iterator修改value，再用const_iterator检查每个key恰好出现一次
+    for (auto it = m.begin(); it != m.end(); ++it) {
+        it->second *= 2;
+    }
+    const unordered_map<int, int>& cm = m;
+    std::vector<int> seen(n, 0);
+    for (const auto& kv : cm) {
+        ASSERT_EQ(kv.second, kv.first * 2);
+        ++seen[kv.first];
+    }
+    EXPECT_EQ(std::count(seen.begin(), seen.end(), 1), n);
+    EXPECT_EQ(std::distance(cm.begin(), cm.end()), n);
+
+    unordered_map<int, int>::const_iterator cit = m.find(42);
+    EXPECT_EQ(cit->second, 84);
+    EXPECT_EQ(cm.find(n), cm.end());
+    EXPECT_EQ(cm.at(7), 14);
+
+    // 删掉大部分元素后，表变得很稀疏，空桶都要被跳过
+    for (int i = 0; i < n; ++i) {
+        if (i % 97 != 0)
+            m.erase(i);
+    }
+    std::vector<int> keys;
+    for (auto it = m.begin(); it != m.end(); it++) {
+        keys.push_back(it->first);
+    }
+    std::sort(keys.begin(), keys.end());
+    ASSERT_EQ(keys.size(), m.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        EXPECT_EQ(keys[i], static_cast<int>(i) * 97);
+    }
+    m.clear();
+    EXPECT_EQ(m.begin(), m.end());
+}
+
+TEST_F(UnorderedMapTest, IterationDuringIncrementalRehash) {
+    unordered_map<std::string, int> m;
+    m.set_incremental_rehash(true);
+    int n = 0;
+    for (int round = 0; round < 4; ++round) {
+        // 刚扩容时大部分结点还在旧表里，遍历要同时走完新表和旧表
+        size_t buckets = m.bucket_count();
+        while (m.bucket_count() == buckets) {
+            m.emplace(std::to_string(n), n);
+            ++n;
+        }
+        long long sum = 0;
+        size_t count = 0;
+        for (const auto& kv : m) {
+            sum += kv.second;
+            ++count;
+        }
+        EXPECT_EQ(count, static_cast<size_t>(n));
+        EXPECT_EQ(sum, static_cast<long long>(n) * (n - 1) / 2);
+    }
+}
+
+TEST_F(UnorderedMapTest, EraseWhileIteratingDuringIncrementalRehash) {
+    // fibonacci策略下旧桶按顺序分裂到新表，即使删除时搬迁也碰巧不会漏；另外两种策略会
+    checkEraseWhileIterating<hashtable_prime_policy>();
+    checkEraseWhileIterating<hashtable_fibonacci_policy>();
+    checkEraseWhileIterating<hashtable_avalanche_policy>();
+}
+
+TEST_F(UnorderedMapTest, IteratorComparesWithConstIterator) {
+    unordered_map<int, int> m;
+    m.emplace(1, 10);
+    EXPECT_TRUE(m.find(2) == m.cend());
+    EXPECT_TRUE(m.find(1) != m.cend());
+    EXPECT_TRUE(m.cend() == m.find(2));
+    EXPECT_TRUE(m.begin() == m.cbegin());
+
+    const unordered_map<int, int>& cm = m;
+    EXPECT_TRUE(cm.find(1) == m.find(1));
+    EXPECT_FALSE(m.find(1) != cm.begin());
+}
+
+TEST_F(UnorderedMapTest, IterationWithPrimeBuckets) {
+    // 素数个桶时位图最后一个字只用了一部分
+    unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                  std::allocator<std::pair<const int, int>>, hashtable_prime_policy> m;
+    m.reserve(100);
+    for (int i = 0; i < 100; ++i) {
+        m.emplace(i * 31, i);
+    }
+    size_t count = 0;
+    for (auto& kv : m) {
+        EXPECT_EQ(kv.first, kv.second * 31);
+        ++count;
+    }
+    EXPECT_EQ(count, 100);
 }
 
 } // namespace test
-} // namespace tiny_stl
\ No newline at end of file
+} // namespace tiny_stl
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include "unrolled_list.h"
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+
+namespace tiny_stl {
+namespace test {
+
+class UnrolledListTest : public ::testing::Test {
+protected:
+    // 每个结点只放4个元素，方便触发split/merge
+    using small_list = unrolled_list<int, 4>;
+
+    template <typename ListA, typename ListB>
+    void expectSameElements(const ListA& a, const ListB& b) {
+        ASSERT_EQ(a.size(), b.size());
+        EXPECT_TRUE(std::equal(a.begin(), a.end(), b.begin()));
+    }
+};
+
+//======================================================//
+// basic test
+//======================================================//
+TEST_F(UnrolledListTest, DefaultConstructor) {
+    unrolled_list<int> l;
+    EXPECT_TRUE(l.empty());
+    EXPECT_EQ(l.size(), 0);
+    EXPECT_EQ(l.begin(), l.end());
+}
+
+TEST_F(UnrolledListTest, PushPopOperations) {
+    small_list l;
+    for (int i = 0; i < 10; ++i) {
+        l.push_back(i);
+    }
+    l.push_front(-1);
+    EXPECT_EQ(l.size(), 11);
+    EXPECT_EQ(l.front(), -1);
+    EXPECT_EQ(l.back(), 9);
+    // push_back填满结点后才开新结点
+    EXPECT_EQ(l.node_count(), 4);
+
+    l.pop_front();
+    l.pop_back();
+    EXPECT_EQ(l.front(), 0);
+    EXPECT_EQ(l.back(), 8);
+}
+
+TEST_F(UnrolledListTest, BidirectionalIteration) {
+    small_list l{1, 2, 3, 4, 5, 6, 7, 8, 9};
+    EXPECT_EQ(std::accumulate(l.begin(), l.end(), 0), 45);
+    std::vector<int> reversed(l.rbegin(), l.rend());
+    EXPECT_EQ(reversed.front(), 9);
+    EXPECT_EQ(reversed.back(), 1);
+    auto it = l.end();
+    std::advance(it, -9);
+    EXPECT_EQ(it, l.begin());
+}
+
+TEST_F(UnrolledListTest, InsertSplitsFullNode) {
+    small_list l{0, 1, 2, 3};
+    EXPECT_EQ(l.node_count(), 1);
+    auto it = std::next(l.begin(), 3);
+    it = l.insert(it, 100);
+    EXPECT_EQ(*it, 100);
+    EXPECT_EQ(l.node_count(), 2);
+    std::list<int> expected{0, 1, 2, 100, 3};
+    expectSameElements(l, expected);
+}
+
+TEST_F(UnrolledListTest, EraseMergesSparseNodes) {
+    small_list l;
+    for (int i = 0; i < 16; ++i) {
+        l.push_back(i);
+    }
+    EXPECT_EQ(l.node_count(), 4);
+    auto it = l.begin();
+    while (it != l.end()) {
+        it = (*it % 2 == 0) ? l.erase(it) : std::next(it);
+    }
+    EXPECT_EQ(l.size(), 8);
+    EXPECT_LT(l.node_count(), 4);
+    std::list<int> expected{1, 3, 5, 7, 9, 11, 13, 15};
+    expectSameElements(l, expected);
+}
+
+TEST_F(UnrolledListTest, RandomOperationsMatchStdList) {
+    std::mt19937 gen(7);
+    small_list l;
+    std::list<int> ref;
+    for (int i = 0; i < 5000; ++i) {
+        size_t pos = ref.empty() ? 0 : gen() % (ref.size() + 1);
+        if (gen() % 3 == 0 && !ref.empty()) {
+            pos = pos % ref.size();
+            auto tiny_it = l.erase(std::next(l.begin(), pos));
+            auto std_it = ref.erase(std::next(ref.begin(), pos));
+            ASSERT_EQ(std::distance(l.begin(), tiny_it), std::distance(ref.begin(), std_it));
+        } else {
+            auto tiny_it = l.insert(std::next(l.begin(), pos), i);
+            ref.insert(std::next(ref.begin(), pos), i);
+            ASSERT_EQ(*tiny_it, i);
+        }
+    }
+    expectSameElements(l, ref);
+}
+
+TEST_F(UnrolledListTest, SpliceWholeList) {
+    small_list a{1, 2, 3, 4, 5};
+    small_list b{10, 11, 12};
+    a.splice(std::next(a.begin(), 2), b);
+    EXPECT_TRUE(b.empty());
+    std::list<int> expected{1, 2, 10, 11, 12, 3, 4, 5};
+    expectSameElements(a, expected);
+
+    small_list c{20};
+    a.splice(a.end(), c);
+    EXPECT_EQ(a.back(), 20);
+    EXPECT_EQ(a.size(), 9);
+}
+
+TEST_F(UnrolledListTest, CopyMoveAndNonTrivialType) {
+    unrolled_list<std::string, 3> l;
+    for (int i = 0; i < 10; ++i) {
+        l.push_back(std::to_string(i));
+    }
+    auto copy = l;
+    auto moved = std::move(l);
+    EXPECT_TRUE(l.empty());
+    expectSameElements(copy, moved);
+
+    unrolled_list<std::unique_ptr<int>, 3> owners;
+    for (int i = 0; i < 10; ++i) {
+        owners.push_front(std::make_unique<int>(i));
+    }
+    owners.erase(std::next(owners.begin(), 5));
+    EXPECT_EQ(*owners.front(), 9);
+    EXPECT_EQ(owners.size(), 9);
+}
+
+} // namespace test
+} // namespace tiny_stl
@@ -1,5 +1,6 @@
 #include "gtest/gtest.h"
 #include "vector.h"
+#include "trace.h"
 #include <vector>
 #include <chrono>
 #include <random>
@@ -30,12 +31,21 @@ protected:
         return str;
     }
     
+#ifdef TINY_STL_ENABLE_TRACE
+    // 每个测试是一个区间，vector内部的grow/relocate事件嵌套在其中，用于定位耗时
+    static void TearDownTestSuite() {
+        tiny_stl::trace::dump_chrome_trace("vector_perf_trace.json");
+        tiny_stl::trace::clear();
+    }
+#endif
+
     std::mt19937 gen;
     std::uniform_int_distribution<> dis;
 };
 
 // 测试1: 字符串连续push_back
 TEST_F(VectorPerfTest, StringPushBack) {
+    TINY_STL_TRACE_SCOPE("VectorPerfTest.StringPushBack", 0);
     auto start = std::chrono::high_resolution_clock::now();
     tiny_stl::vector<std::string> tv;
     for(size_t i = 0; i < MEDIUM_SIZE; ++i) {
@@ -62,6 +72,7 @@ TEST_F(VectorPerfTest, StringPushBack) {
 
 // 测试2: 字符串随机插入/删除
 TEST_F(VectorPerfTest, StringRandomInsertErase) {
+    TINY_STL_TRACE_SCOPE("VectorPerfTest.StringRandomInsertErase", 0);
     tiny_stl::vector<std::string> tv;
     for(size_t i = 0; i < MEDIUM_SIZE; ++i) {
         tv.push_back(random_string());
@@ -99,6 +110,7 @@ TEST_F(VectorPerfTest, StringRandomInsertErase) {
 
 // 测试3: 智能指针向量操作
 TEST_F(VectorPerfTest, SmartPointerVector) {
+    TINY_STL_TRACE_SCOPE("VectorPerfTest.SmartPointerVector", 0);
     auto start = std::chrono::high_resolution_clock::now();
     tiny_stl::vector<std::shared_ptr<std::string>> tv;
     for(size_t i = 0; i < MEDIUM_SIZE; ++i) {
@@ -125,6 +137,7 @@ TEST_F(VectorPerfTest, SmartPointerVector) {
 
 // 测试4: 复杂对象移动语义
 TEST_F(VectorPerfTest, ComplexObjectMove) {
+    TINY_STL_TRACE_SCOPE("VectorPerfTest.ComplexObjectMove", 0);
     struct ComplexObj {
         std::string name;
         std::vector<std::pair<int, std::string>> data;
@@ -193,6 +206,7 @@ TEST_F(VectorPerfTest, ComplexObjectMove) {
 
 // 测试5: 嵌套容器性能
 TEST_F(VectorPerfTest, NestedContainer) {
+    TINY_STL_TRACE_SCOPE("VectorPerfTest.NestedContainer", 0);
     auto start = std::chrono::high_resolution_clock::now();
     tiny_stl::vector<tiny_stl::vector<std::string>> tv;
     for(size_t i = 0; i < SMALL_SIZE; ++i) {
@@ -226,6 +240,7 @@ TEST_F(VectorPerfTest, NestedContainer) {
 
 // 测试6: 自定义对象排序性能
 TEST_F(VectorPerfTest, CustomObjectSort) {
+    TINY_STL_TRACE_SCOPE("VectorPerfTest.CustomObjectSort", 0);
     struct Person {
         std::string name;
         int age;
@@ -262,6 +277,7 @@ TEST_F(VectorPerfTest, CustomObjectSort) {
 
 // 测试7: 字符串查找性能
 TEST_F(VectorPerfTest, StringFind) {
+    TINY_STL_TRACE_SCOPE("VectorPerfTest.StringFind", 0);
     tiny_stl::vector<std::string> tv;
     for(size_t i = 0; i < LARGE_SIZE; ++i) {
         tv.push_back(random_string());
@@ -289,6 +305,7 @@ TEST_F(VectorPerfTest, StringFind) {
 
 // 测试8: 对象拷贝性能
 TEST_F(VectorPerfTest, ObjectCopy) {
+    TINY_STL_TRACE_SCOPE("VectorPerfTest.ObjectCopy", 0);
     struct Config {
         std::string name;
         std::vector<std::string> options;
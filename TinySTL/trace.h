@@ -0,0 +1,163 @@
+#pragma once
+
+// 容器热路径上的埋点（扩容、搬迁、结点分配、rehash）
+// 默认情况下所有宏都展开为空，参数也不会被求值；定义TINY_STL_ENABLE_TRACE后才会记录事件。
+// 每个线程写自己的环形缓冲区，写入路径上没有锁；dump_chrome_trace输出Chrome trace JSON，
+// 可以直接在chrome://tracing或Perfetto中打开。
+
+#ifdef TINY_STL_ENABLE_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace tiny_stl {
+namespace trace {
+
+struct record {
+  const char* name;  // NOTE: 只保存指针，name必须是字符串字面量
+  uint64_t begin_ns;
+  uint64_t duration_ns;
+  uint64_t arg;
+};
+
+// 单写者环形缓冲区：只有所属线程写入，写满后覆盖最旧的记录
+class ring_buffer {
+ public:
+  static constexpr size_t capacity = size_t(1) << 18;
+
+  explicit ring_buffer(uint32_t tid) : tid_(tid), records_(new record[capacity]) {}
+
+  void push(const char* name, uint64_t begin_ns, uint64_t duration_ns, uint64_t arg) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    records_[head & (capacity - 1)] = record{name, begin_ns, duration_ns, arg};
+    head_.store(head + 1, std::memory_order_release);
+  }
+
+  // NOTE: 导出时写线程应当已经停止，否则最旧的几条记录可能正在被覆盖
+  template <typename Fn>
+  void for_each(Fn fn) const {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint64_t first = head > capacity ? head - capacity : 0;
+    for (uint64_t i = first; i < head; ++i)
+      fn(records_[i & (capacity - 1)]);
+  }
+
+  void clear() { head_.store(0, std::memory_order_release); }
+
+  uint32_t tid() const { return tid_; }
+
+ private:
+  uint32_t tid_;
+  std::unique_ptr<record[]> records_;
+  std::atomic<uint64_t> head_{0};
+};
+
+// 所有线程的缓冲区都登记在这里，线程退出后缓冲区依然保留，方便最后统一导出
+class registry {
+ public:
+  static registry& instance() {
+    static registry reg;
+    return reg;
+  }
+
+  ring_buffer* create() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.emplace_back(new ring_buffer(static_cast<uint32_t>(buffers_.size())));
+    return buffers_.back().get();
+  }
+
+  template <typename Fn>
+  void for_each(Fn fn) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& buffer : buffers_)
+      fn(*buffer);
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<ring_buffer>> buffers_;
+};
+
+inline uint64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+inline ring_buffer& local_buffer() {
+  // NOTE: 只有每个线程第一次记录时会加锁登记
+  thread_local ring_buffer* buffer = registry::instance().create();
+  return *buffer;
+}
+
+inline void instant(const char* name, uint64_t arg = 0) {
+  local_buffer().push(name, now_ns(), 0, arg);
+}
+
+class scope {
+ public:
+  scope(const char* name, uint64_t arg = 0) : name_(name), arg_(arg), begin_(now_ns()) {}
+  ~scope() { local_buffer().push(name_, begin_, now_ns() - begin_, arg_); }
+
+  scope(const scope&) = delete;
+  scope& operator=(const scope&) = delete;
+
+ private:
+  const char* name_;
+  uint64_t arg_;
+  uint64_t begin_;
+};
+
+inline void clear() {
+  registry::instance().for_each([](ring_buffer& buffer) { buffer.clear(); });
+}
+
+inline void dump_chrome_trace(std::ostream& os) {
+  os << "{\"traceEvents\":[";
+  bool first = true;
+  registry::instance().for_each([&](const ring_buffer& buffer) {
+    buffer.for_each([&](const record& r) {
+      os << (first ? "\n" : ",\n");
+      first = false;
+      // 时间单位是微秒，带小数保留纳秒精度
+      os << "{\"name\":\"" << r.name << "\",\"ph\":\"" << (r.duration_ns ? 'X' : 'i')
+         << "\",\"ts\":" << r.begin_ns / 1000 << '.' << r.begin_ns % 1000 / 100;
+      if (r.duration_ns)
+        os << ",\"dur\":" << r.duration_ns / 1000 << '.' << r.duration_ns % 1000 / 100;
+      else
+        os << ",\"s\":\"t\"";
+      os << ",\"pid\":1,\"tid\":" << buffer.tid() << ",\"args\":{\"n\":" << r.arg << "}}";
+    });
+  });
+  os << "\n]}\n";
+}
+
+inline bool dump_chrome_trace(const char* path) {
+  std::ofstream os(path);
+  if (!os)
+    return false;
+  dump_chrome_trace(os);
+  return bool(os);
+}
+
+}  // namespace trace
+}  // namespace tiny_stl
+
+#define TINY_STL_TRACE_CONCAT_IMPL(a, b) a##b
+#define TINY_STL_TRACE_CONCAT(a, b) TINY_STL_TRACE_CONCAT_IMPL(a, b)
+#define TINY_STL_TRACE_SCOPE(name, arg) \
+  ::tiny_stl::trace::scope TINY_STL_TRACE_CONCAT(tiny_stl_trace_scope_, __LINE__)(name, arg)
+#define TINY_STL_TRACE_EVENT(name, arg) ::tiny_stl::trace::instant(name, arg)
+
+#else
+
+#define TINY_STL_TRACE_SCOPE(name, arg) ((void)0)
+#define TINY_STL_TRACE_EVENT(name, arg) ((void)0)
+
+#endif
@@ -1,16 +1,166 @@
 #pragma once
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstdlib>
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
+
+#include "trace.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define TINY_STL_HASHTABLE_MMAP 1
+#endif
 
 namespace tiny_stl {
 
 template <typename Key, typename T, typename Hash,
-typename Pred, typename Alloc>
+typename Pred, typename Alloc, typename Policy, bool CacheHash>
 class _hashtable;
 
+// 桶下标策略：bucket_count把期望的桶数调整成策略支持的桶数，index把hash映射到桶
+// 素数取模：对任意hash都能分散开，但每次查找都要做一次整数除法
+struct hashtable_prime_policy {
+  static size_t bucket_count(size_t n) {
+    static const size_t primes[] = {
+      5ul, 11ul, 23ul, 53ul, 97ul, 193ul, 389ul, 769ul, 1543ul, 3079ul, 6151ul, 12289ul,
+      24593ul, 49157ul, 98317ul, 196613ul, 393241ul, 786433ul, 1572869ul, 3145739ul,
+      6291469ul, 12582917ul, 25165843ul, 50331653ul, 100663319ul, 201326611ul,
+      402653189ul, 805306457ul, 1610612741ul, 3221225473ul, 4294967291ul};
+    for (size_t p : primes)
+      if (p >= n)
+        return p;
+    return n | 1;
+  }
+  static size_t index(size_t code, size_t count) { return code % count; }
+};
+
+// 2的幂个桶，乘以2^64/黄金分割比后取高位：一次乘法和移位，低位相同的key也会被打散
+struct hashtable_fibonacci_policy {
+  static size_t bucket_count(size_t n) {
+    size_t count = 2;
+    while (count < n)
+      count *= 2;
+    return count;
+  }
+  static size_t index(size_t code, size_t count) {
+    return (code * 0x9E3779B97F4A7C15ull) >> (64 - __builtin_ctzll(count));
+  }
+};
+
+// murmur3的fmix64：输入的每一位都会影响输出的每一位
+inline size_t hashtable_mix64(size_t code) {
+  code ^= code >> 33;
+  code *= 0xff51afd7ed558ccdull;
+  code ^= code >> 33;
+  code *= 0xc4ceb9fe1a85ec53ull;
+  code ^= code >> 33;
+  return code;
+}
+
+// 2的幂个桶，先用fmix64把所有位充分混合再取低位，适合质量很差的hash
+struct hashtable_avalanche_policy {
+  static size_t bucket_count(size_t n) { return hashtable_fibonacci_policy::bucket_count(n); }
+  static size_t index(size_t code, size_t count) { return hashtable_mix64(code) & (count - 1); }
+};
+
+
+
+// 桶数组和位图：内容全为0的定长数组
+// 大数组直接mmap匿名内存，分配本身是O(1)的，页面第一次被访问时才由系统填0；
+// 渐进式rehash扩容时新表不用在触发扩容的那次插入里整张清零。小数组用calloc
+// NOTE: 只用于平凡类型，并且假设全0的指针就是nullptr
+template <typename T>
+class hashtable_zeroed_array {
+  static_assert(std::is_trivial<T>::value, "hashtable_zeroed_array needs a trivial type");
+
+public:
+  hashtable_zeroed_array() = default;
+  explicit hashtable_zeroed_array(size_t n) : size_(n) {
+    if (n == 0)
+      return;
+#ifdef TINY_STL_HASHTABLE_MMAP
+    if (bytes() >= release_bytes) {
+      void* p = ::mmap(nullptr, bytes(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (p == MAP_FAILED)
+        throw std::bad_alloc();
+      data_ = static_cast<T*>(p);
+      mapped_ = true;
+      return;
+    }
+#endif
+    data_ = static_cast<T*>(std::calloc(n, sizeof(T)));
+    if (!data_)
+      throw std::bad_alloc();
+  }
+  hashtable_zeroed_array(hashtable_zeroed_array&& other) noexcept { swap(other); }
+  hashtable_zeroed_array& operator=(hashtable_zeroed_array&& other) noexcept {
+    hashtable_zeroed_array(std::move(other)).swap(*this);
+    return *this;
+  }
+  hashtable_zeroed_array(const hashtable_zeroed_array&) = delete;
+  hashtable_zeroed_array& operator=(const hashtable_zeroed_array&) = delete;
+
+  ~hashtable_zeroed_array() {
+#ifdef TINY_STL_HASHTABLE_MMAP
+    if (mapped_) {
+      if (released_ < bytes())
+        ::munmap(reinterpret_cast<char*>(data_) + released_, bytes() - released_);
+      return;
+    }
+#endif
+    std::free(data_);
+  }
+
+  void swap(hashtable_zeroed_array& other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(mapped_, other.mapped_);
+    std::swap(released_, other.released_);
+  }
 
+  // 下标小于n的元素不会再被访问：按release_bytes为单位把它们占的页提前还给系统
+  // 旧表边搬迁边释放，搬完时析构不用一次归还整张表
+  void release_before(size_t n) {
+#ifdef TINY_STL_HASHTABLE_MMAP
+    size_t end = n * sizeof(T) / release_bytes * release_bytes;
+    if (!mapped_ || end <= released_)
+      return;
+    ::munmap(reinterpret_cast<char*>(data_) + released_, end - released_);
+    released_ = end;
+#else
+    (void)n;
+#endif
+  }
+
+  T& operator[](size_t i) { return data_[i]; }
+  const T& operator[](size_t i) const { return data_[i]; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  T* begin() { return data_; }
+  T* end() { return data_ + size_; }
+  const T* begin() const { return data_; }
+  const T* end() const { return data_ + size_; }
+
+private:
+  static constexpr size_t release_bytes = 64 * 1024;  // 页大小的整数倍
+
+  size_t bytes() const { return size_ * sizeof(T); }
+
+  T* data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+  size_t released_ = 0;  // 已经归还的前缀字节数
+};
 
 template <typename T, typename = void>
 struct hashtable_value_traits {
@@ -35,7 +185,29 @@ struct hashtable_value_traits<T, std::void_t<typename T::first_type, typename T:
   static const mapped_type& get_mapped(const value_type& val) { return val.second; }
 };
 
-template <typename T>
+// Hash和Pred都声明了is_transparent时，查找可以直接用任何能和key一起hash、比较的类型，
+// 比如用std::string_view查std::string的key，不需要先构造一个临时的key
+template <typename Hash, typename Pred, typename = void>
+struct hashtable_is_transparent : std::false_type {};
+
+template <typename Hash, typename Pred>
+struct hashtable_is_transparent<Hash, Pred,
+    std::void_t<typename Hash::is_transparent, typename Pred::is_transparent>> : std::true_type {};
+
+// 和std::hash<std::string>的结果一致，可以接受std::string、std::string_view和const char*
+struct transparent_string_hash {
+  using is_transparent = void;
+  size_t operator()(std::string_view str) const { return std::hash<std::string_view>()(str); }
+};
+
+// 整数、枚举、指针用std::hash时hash几乎没有开销，缓存反而让每个结点多占8字节；其他情况默认缓存
+template <typename Key, typename Hash>
+struct hashtable_cache_hash
+    : std::integral_constant<bool, !((std::is_integral<Key>::value || std::is_enum<Key>::value ||
+                                      std::is_pointer<Key>::value) &&
+                                     std::is_same<Hash, std::hash<Key>>::value)> {};
+
+template <typename T, bool CacheHash = false>
 struct hashtable_node {
   using value_type = T;
   
@@ -43,34 +215,69 @@ struct hashtable_node {
   hashtable_node* next;
 };
 
-template<typename Key, typename T, typename Hash, typename Pred, typename Alloc>
+// 结点里保存完整的hash：rehash不再调用hasher，查找时hash不相等就不用比较key
+template <typename T>
+struct hashtable_node<T, true> {
+  using value_type = T;
+
+  value_type val;
+  hashtable_node* next;
+  size_t hash;
+};
+
+// 链表走到头时，用结点的hash算出当前桶，再在占用位图里找下一个非空的桶
+template<typename Key, typename T, typename Hash, typename Pred, typename Alloc, typename Policy,
+         bool CacheHash, bool IsConst>
 struct hashtable_iterator {
   using iterator_category = std::forward_iterator_tag;
   using difference_type = std::ptrdiff_t;
   using value_type = T;
-  using pointer = T*;
-  using reference = T&;
+  using pointer = typename std::conditional<IsConst, const T*, T*>::type;
+  using reference = typename std::conditional<IsConst, const T&, T&>::type;
 
-  using node_type = hashtable_node<value_type>;
+  using node_type = hashtable_node<value_type, CacheHash>;
   using node_ptr = node_type*;
 
-  using hashtable_type = _hashtable<Key, value_type, Hash, Pred, Alloc>;
+  using hashtable_type = _hashtable<Key, value_type, Hash, Pred, Alloc, Policy, CacheHash>;
+  using self = hashtable_iterator;
 
   node_ptr node_;
-  hashtable_type* ht_;
+  const hashtable_type* ht_;
 
-  hashtable_iterator(node_ptr n, hashtable_type* ht) : node_(n), ht_(ht) {}
+  hashtable_iterator(node_ptr n, const hashtable_type* ht) : node_(n), ht_(ht) {}
+  template <bool C = IsConst, typename = typename std::enable_if<C>::type>
+  hashtable_iterator(const hashtable_iterator<Key, T, Hash, Pred, Alloc, Policy, CacheHash, false>& other)
+      : node_(other.node_), ht_(other.ht_) {}
 
   reference operator*() const { return node_->val; }
   pointer operator->() const { return &(operator*()); }
-  bool operator==(const hashtable_iterator& other) const { return node_ == other.node_; }
-  bool operator!=(const hashtable_iterator& other) const { return node_ != other.node_; }
+
+  self& operator++() {
+    node_ = ht_->next_node(node_);
+    return *this;
+  }
+
+  self operator++(int) {
+    self tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  // NOTE: iterator和const_iterator可以互相比较，比如m.find(k) == m.cend()
+  template <bool C>
+  bool operator==(const hashtable_iterator<Key, T, Hash, Pred, Alloc, Policy, CacheHash, C>& other) const {
+    return node_ == other.node_;
+  }
+  template <bool C>
+  bool operator!=(const hashtable_iterator<Key, T, Hash, Pred, Alloc, Policy, CacheHash, C>& other) const {
+    return node_ != other.node_;
+  }
 };
 
 
 
 template <typename Key, typename T, typename Hash,
-          typename Pred, typename Alloc>
+          typename Pred, typename Alloc, typename Policy, bool CacheHash>
 class _hashtable {
 
 public:
@@ -81,6 +288,8 @@ public:
   using hasher = Hash;
   using key_equal = Pred;
   using allocator_type = Alloc;
+  using bucket_policy = Policy;
+  static constexpr bool cache_hash = CacheHash;
 
   using pointer = value_type*;
   using const_pointer = const value_type*;
@@ -88,15 +297,19 @@ public:
   using const_reference = const value_type&;
   using size_type = size_t;
   using difference_type = ptrdiff_t;
-  using iterator = hashtable_iterator<Key, T, Hash, Pred, Alloc>;
-  using const_iterator = int; // preserve
+  using iterator = hashtable_iterator<Key, T, Hash, Pred, Alloc, Policy, CacheHash, false>;
+  using const_iterator = hashtable_iterator<Key, T, Hash, Pred, Alloc, Policy, CacheHash, true>;
 
 
-  using node_type = hashtable_node<value_type>;
+  using node_type = hashtable_node<value_type, CacheHash>;
   using node_ptr = node_type*;
   using node_allocator = typename Alloc::template rebind<node_type>::other;
   using data_allocator = typename Alloc::template rebind<value_type>::other;
-  using table_type = std::vector<node_ptr>;
+  using table_type = hashtable_zeroed_array<node_ptr>;
+  using bitmap_type = hashtable_zeroed_array<uint64_t>;
+
+  static constexpr size_type rehash_step = 4; // 渐进式rehash每次插入至少搬迁的旧桶数
+  static constexpr size_type batch_width = 16; // 批量查找时同时在途的key数
 
 private:
   table_type buckets_;
@@ -107,34 +320,91 @@ private:
   float mlf_; 
   node_allocator node_alloc_;
   data_allocator data_alloc_;
+  // 渐进式rehash：old_buckets_中下标小于migrate_pos_的桶已经搬到buckets_，其余的还在旧表里
+  bool incremental_;
+  table_type old_buckets_;
+  size_type migrate_pos_;
+  size_type migrate_step_;  // 每次插入搬迁的旧桶数，保证下一次扩容之前旧表已经搬完
+  // 每个桶一位，非空的桶置1；遍历时用ctz一次跳过64个空桶
+  bitmap_type occupied_;
+  bitmap_type old_occupied_;
+
+  template <typename, typename, typename, typename, typename, typename, bool, bool>
+  friend struct hashtable_iterator;
 
 public:
   _hashtable(size_type bucket_size, const hasher& hash = hasher(), const key_equal& equal = key_equal(),
             const float& mlf = 1.0f, const allocator_type& node_alloc = allocator_type(), 
             const node_allocator& data_alloc = data_allocator())
-    : bucket_size_(bucket_size),
+    : bucket_size_(Policy::bucket_count(bucket_size)),
       size_(0),
       hash_(hash),
       equal_(equal),
       mlf_(mlf),
       node_alloc_(node_alloc),
-      data_alloc_(data_alloc) {
-    buckets_.reserve(bucket_size_);
-    buckets_.assign(bucket_size_, nullptr);
+      data_alloc_(data_alloc),
+      incremental_(false),
+      migrate_pos_(0),
+      migrate_step_(rehash_step) {
+    table_type(bucket_size_).swap(buckets_);
+    bitmap_type(bitmap_words(bucket_size_)).swap(occupied_);
+  }
+
+  _hashtable(const _hashtable& other)
+    : _hashtable(other.bucket_size_, other.hash_, other.equal_, other.mlf_) {
+    incremental_ = other.incremental_;
+    other.for_each_node([this](node_ptr node) { emplace_unique(node->val); });
   }
 
-  iterator begin() { 
-    for (node_ptr node : buckets_)
-      if (node)
-        return iterator(node, this);
-    return end();
+  _hashtable& operator=(const _hashtable& other) {
+    if (this != &other) {
+      _hashtable tmp(other);
+      swap(tmp);
+    }
+    return *this;
   }
 
+  ~_hashtable() { clear(); }
+
+  void swap(_hashtable& other) {
+    std::swap(buckets_, other.buckets_);
+    std::swap(bucket_size_, other.bucket_size_);
+    std::swap(size_, other.size_);
+    std::swap(hash_, other.hash_);
+    std::swap(equal_, other.equal_);
+    std::swap(mlf_, other.mlf_);
+    std::swap(incremental_, other.incremental_);
+    std::swap(old_buckets_, other.old_buckets_);
+    std::swap(migrate_pos_, other.migrate_pos_);
+    std::swap(migrate_step_, other.migrate_step_);
+    std::swap(occupied_, other.occupied_);
+    std::swap(old_occupied_, other.old_occupied_);
+  }
+
+  // 新表的桶在前，渐进式rehash中旧表里还没搬迁的桶在后
+  iterator begin() { return iterator(first_node(), this); }
   iterator end() { return iterator(nullptr, this); }
+  const_iterator begin() const { return const_iterator(first_node(), this); }
+  const_iterator end() const { return const_iterator(nullptr, this); }
 
   bool empty() const { return size_ == 0; }
   size_type size() const { return size_; }
 
+  size_type bucket_count() const { return bucket_size_; }
+  float load_factor() const { return (float)size_ / bucket_size_; }
+  float max_load_factor() const { return mlf_; }
+  void max_load_factor(float mlf) { mlf_ = mlf; }
+
+  // 打开后扩容不再一次性搬迁所有结点，而是分摊到之后的每次插入上
+  // NOTE: 删除不搬迁，所以it = erase(it)遍历着删除时不会漏掉或重复访问结点
+  void set_incremental_rehash(bool on) {
+    if (!on)
+      finish_migration();
+    incremental_ = on;
+  }
+  bool incremental_rehash() const { return incremental_; }
+  bool rehashing() const { return !old_buckets_.empty(); }
+
   void clear() {
     for (node_ptr& node : buckets_) {
       node_ptr cur = node;
@@ -145,83 +415,389 @@ public:
       }
       node = nullptr;
     }
+    std::fill(occupied_.begin(), occupied_.end(), 0);
+    for (size_type i = migrate_pos_; i < old_buckets_.size(); ++i) {
+      node_ptr cur = old_buckets_[i];
+      while (cur) {
+        node_ptr next = cur->next;
+        destroy_node(cur);
+        cur = next;
+      }
+    }
+    table_type().swap(old_buckets_);
+    bitmap_type().swap(old_occupied_);
+    migrate_pos_ = 0;
     size_ = 0;
   }
 
+  // 一次性重建桶数组，桶数至少能容纳当前元素；只重新链接结点，不重新分配
+  void rehash(size_type count) {
+    finish_migration();
+    size_type needed = (size_type)((float)size_ / mlf_) + 1;
+    count = Policy::bucket_count(std::max(count, needed));
+    if (count == bucket_size_)
+      return;
+    TINY_STL_TRACE_SCOPE("hashtable::rehash", count);
+    table_type buckets(count);
+    bitmap_type occupied(bitmap_words(count));
+    for (node_ptr cur : buckets_) {
+      while (cur) {
+        node_ptr next = cur->next;
+        size_type index = bucket_index(node_hash(cur), count);
+        cur->next = buckets[index];
+        buckets[index] = cur;
+        occupied[index / 64] |= 1ull << (index % 64);
+        cur = next;
+      }
+    }
+    buckets_.swap(buckets);
+    occupied_.swap(occupied);
+    bucket_size_ = count;
+  }
+
+  void reserve(size_type count) { rehash((size_type)((float)count / mlf_) + 1); }
+
+  // 只有先构造出元素才能拿到key，key已存在时销毁刚构造的结点
   template<typename... Args>
   std::pair<iterator, bool> 
   emplace_unique(Args&&... args) {
     node_ptr node = create_node(std::forward<Args>(args)...);
-    if ((float)(size_ + 1) / bucket_size_ > mlf_)
-      ;// TODO: rehash(bucket_size_ * 2);
-    return insert_node_unique(node);
+    const key_type& key = value_traits::get_key(node->val);
+    size_t code = hash_(key);
+    node_ptr found = probe_for_insert(key, code);
+    if (found) {
+      destroy_node(node);
+      return std::make_pair(iterator(found, this), false);
+    }
+    return std::make_pair(link_new_node(node, code), true);
   }
 
-  iterator find(const key_type& key) {
-    size_type index = hash(key);
-    node_ptr cur = buckets_[index];
-    for (; cur; cur = cur->next)
-      if (equal_(value_traits::get_key(cur->val), key))
-        return iterator(cur, this);
-    return end();
+  // key已存在时不构造结点；只计算一次hash，只查找一次
+  template<typename K, typename... Args>
+  std::pair<iterator, bool>
+  try_emplace_unique(K&& key, Args&&... args) {
+    size_t code = hash_(key);
+    node_ptr found = probe_for_insert(key, code);
+    if (found)
+      return std::make_pair(iterator(found, this), false);
+    node_ptr node = create_node(std::piecewise_construct,
+                                std::forward_as_tuple(std::forward<K>(key)),
+                                std::forward_as_tuple(std::forward<Args>(args)...));
+    return std::make_pair(link_new_node(node, code), true);
   }
 
-  void erase(iterator pos) { // NOTE: 因为是单向链表，所以需要遍历，找到前一个节点断链
+  // NOTE: 条件必须依赖函数模板自己的参数H，不满足时才只是去掉这个重载而不是编译错误
+  template <typename H>
+  using enable_if_transparent = typename std::enable_if<hashtable_is_transparent<H, Pred>::value>::type;
+
+  iterator find(const key_type& key) { return iterator(find_node(key), this); }
+  const_iterator find(const key_type& key) const { return const_iterator(find_node(key), this); }
+  template <typename K, typename H = Hash, typename = enable_if_transparent<H>>
+  iterator find(const K& key) { return iterator(find_node(key), this); }
+  template <typename K, typename H = Hash, typename = enable_if_transparent<H>>
+  const_iterator find(const K& key) const { return const_iterator(find_node(key), this); }
+
+  // 返回被删结点的下一个结点；除了被删的结点，其他迭代器都不失效
+  iterator erase(iterator pos) { // NOTE: 因为是单向链表，所以需要遍历，找到前一个节点断链
     if (pos == end())
-      return;
+      return pos;
     node_ptr node = pos.node_;
-    size_type index = hash(value_traits::get_key(node->val));
-    node_ptr cur = buckets_[index];
-    if (cur == node) {
-      buckets_[index] = node->next;
-      destroy_node(node);
-      --size_;
-      return;
-    }
-    for (; cur; cur = cur->next) {
-      if (cur->next == node) {
-        cur->next = node->next;
+    iterator next(next_node(node), this);
+    size_type bucket = bucket_pos(node_hash(node));
+    node_ptr* link = &bucket_at_pos(bucket);
+    for (; *link; link = &(*link)->next) {
+      if (*link == node) {
+        *link = node->next;
+        sync_occupied(bucket);
         destroy_node(node);
         --size_;
-        return;
+        return next;
       }
     }
     assert(0), "unreachable";
+    return next;
   }
 
-  size_type erase(const key_type& key) {
-    size_type index = hash(key);
-    node_ptr cur = buckets_[index];
-    size_type erased = 0;
-    while (cur) {
-      node_ptr next = cur->next;
-      destroy_node(cur);
-      size_--;
-      erased++;
-      cur = next;
+  size_type erase(const key_type& key) { return erase_key(key); }
+  template <typename K, typename H = Hash, typename = enable_if_transparent<H>>
+  size_type erase(const K& key) { return erase_key(key); }
+
+  size_type count(const key_type& key) const { return count_key(key); }
+  template <typename K, typename H = Hash, typename = enable_if_transparent<H>>
+  size_type count(const K& key) const { return count_key(key); }
+
+  // 按keys的顺序把每个key的查找结果写到out，不存在的key写end()
+  template <typename Keys, typename OutputIt>
+  OutputIt find_many(const Keys& keys, OutputIt out) {
+    probe_many(keys, [&](node_ptr node) { *out++ = iterator(node, this); });
+    return out;
+  }
+
+  // 按keys的顺序把每个key是否存在写到out
+  template <typename Keys, typename OutputIt>
+  OutputIt contains_many(const Keys& keys, OutputIt out) const {
+    probe_many(keys, [&](node_ptr node) { *out++ = node != nullptr; });
+    return out;
+  }
+
+private:
+  template <typename K>
+  node_ptr find_node(const K& key) const {
+    size_t code = hash_(key);
+    node_ptr cur = bucket_at(code);
+    for (; cur; cur = cur->next)
+      if (node_matches(cur, code, key))
+        return cur;
+    return nullptr;
+  }
+
+  template <typename K>
+  size_type erase_key(const K& key) {
+    size_t code = hash_(key);
+    size_type bucket = bucket_pos(code);
+    node_ptr* link = &bucket_at_pos(bucket);
+    for (; *link; link = &(*link)->next) {
+      if (node_matches(*link, code, key)) {
+        node_ptr node = *link;
+        *link = node->next;
+        sync_occupied(bucket);
+        destroy_node(node);
+        --size_;
+        return 1;
+      }
     }
-    buckets_[index] = nullptr; // NOTE: 头节点置空表示该桶为空
-    return erased;
+    return 0;
   }
 
-  size_type count(const key_type& key) const {
-    size_type index = hash(key);
-    node_ptr cur = buckets_[index];
-    size_type res = 0;
-    while (cur) {
-      res++;
-      cur = cur->next;
+  template <typename K>
+  size_type count_key(const K& key) const {
+    size_t code = hash_(key);
+    for (node_ptr cur = bucket_at(code); cur; cur = cur->next)
+      if (node_matches(cur, code, key))
+        return 1;
+    return 0;
+  }
+
+  // 每batch_width个key一组：先算完整组的hash并预取桶，再预取每个桶的第一个结点，最后才逐个比较key，
+  // 这样一组里的cache miss可以同时在途，而不是一个接一个地等
+  template <typename Keys, typename Fn>
+  void probe_many(const Keys& keys, Fn fn) const {
+    using key_ptr = decltype(std::addressof(*std::begin(keys)));
+    key_ptr batch[batch_width];
+    size_t codes[batch_width];
+    const node_ptr* slots[batch_width];
+    auto it = std::begin(keys);
+    auto last = std::end(keys);
+    while (it != last) {
+      size_type n = 0;
+      for (; n < batch_width && it != last; ++n, ++it) {
+        batch[n] = std::addressof(*it);
+        codes[n] = hash_(*batch[n]);
+        slots[n] = &bucket_at(codes[n]);
+        __builtin_prefetch(slots[n]);
+      }
+      for (size_type i = 0; i < n; ++i)
+        if (node_ptr head = *slots[i])
+          __builtin_prefetch(head);
+      for (size_type i = 0; i < n; ++i) {
+        node_ptr cur = *slots[i];
+        while (cur && !node_matches(cur, codes[i], *batch[i]))
+          cur = cur->next;
+        fn(cur);
+      }
     }
-    return res;
   }
 
-private:
-  size_type hash(const key_type& key) const {
-    return hash_(key) % bucket_size_;
+  size_type bucket_index(size_t code, size_type count) const {
+    return Policy::index(code, count);
   }
 
+  size_t node_hash(node_ptr node) const {
+    if constexpr (CacheHash)
+      return node->hash;
+    else
+      return hash_(value_traits::get_key(node->val));
+  }
+
+  // 缓存了hash时先比较hash，只有hash相等才调用equal_
+  template <typename K>
+  bool node_matches(node_ptr node, size_t code, const K& key) const {
+    if constexpr (CacheHash) {
+      if (node->hash != code)
+        return false;
+    }
+    return equal_(value_traits::get_key(node->val), key);
+  }
+
+  // 桶的位置：[0, bucket_size_)是新表，bucket_size_ + i是旧表的第i个桶
+  // hash为code的key所在的桶：rehash过程中旧表里还没搬迁的桶优先，否则在新表里
+  size_type bucket_pos(size_t code) const {
+    if (!old_buckets_.empty()) {
+      size_type old_index = bucket_index(code, old_buckets_.size());
+      if (old_index >= migrate_pos_)
+        return bucket_size_ + old_index;
+    }
+    return bucket_index(code, bucket_size_);
+  }
+
+  // 所有桶位置的上界，遍历到这里就结束了
+  size_type bucket_end() const { return bucket_size_ + old_buckets_.size(); }
+
+  const node_ptr& bucket_at_pos(size_type pos) const {
+    return pos < bucket_size_ ? buckets_[pos] : old_buckets_[pos - bucket_size_];
+  }
+
+  node_ptr& bucket_at_pos(size_type pos) {
+    return const_cast<node_ptr&>(static_cast<const _hashtable*>(this)->bucket_at_pos(pos));
+  }
+
+  const node_ptr& bucket_at(size_t code) const { return bucket_at_pos(bucket_pos(code)); }
+  node_ptr& bucket_at(size_t code) { return bucket_at_pos(bucket_pos(code)); }
+
+  static size_type bitmap_words(size_type buckets) { return (buckets + 63) / 64; }
+
+  // 桶头改变之后调用，让位图里对应的位和桶是否为空保持一致
+  void sync_occupied(size_type pos) {
+    bitmap_type& bits = pos < bucket_size_ ? occupied_ : old_occupied_;
+    size_type index = pos < bucket_size_ ? pos : pos - bucket_size_;
+    if (bucket_at_pos(pos))
+      bits[index / 64] |= 1ull << (index % 64);
+    else
+      bits[index / 64] &= ~(1ull << (index % 64));
+  }
+
+  // bits中[from, limit)范围内第一个置位的下标，没有时返回limit
+  static size_type find_set_bit(const bitmap_type& bits, size_type from, size_type limit) {
+    if (from >= limit)
+      return limit;
+    size_type word = from / 64;
+    uint64_t cur = bits[word] & (~0ull << (from % 64));
+    while (!cur) {
+      if (++word * 64 >= limit)
+        return limit;
+      cur = bits[word];
+    }
+    return std::min(word * 64 + __builtin_ctzll(cur), limit);
+  }
+
+  // 从位置pos开始（含）第一个非空桶的位置，没有时返回bucket_end()
+  size_type next_occupied(size_type pos) const {
+    if (pos < bucket_size_) {
+      pos = find_set_bit(occupied_, pos, bucket_size_);
+      if (pos < bucket_size_)
+        return pos;
+    }
+    // NOTE: 旧表中下标小于migrate_pos_的桶已经搬走了，位图里的位不再有意义
+    size_type from = std::max(pos - bucket_size_, migrate_pos_);
+    return bucket_size_ + find_set_bit(old_occupied_, from, old_buckets_.size());
+  }
+
+  node_ptr first_node() const {
+    size_type pos = next_occupied(0);
+    return pos < bucket_end() ? bucket_at_pos(pos) : nullptr;
+  }
+
+  // 迭代器的下一个结点：链表没走完就是next，否则是下一个非空桶的第一个结点
+  node_ptr next_node(node_ptr node) const {
+    if (node->next)
+      return node->next;
+    size_type pos = next_occupied(bucket_pos(node_hash(node)) + 1);
+    return pos < bucket_end() ? bucket_at_pos(pos) : nullptr;
+  }
+
+  // 插入的第一步：推进渐进式rehash，再在key所在的桶里查找，返回已有的结点或者nullptr
+  template <typename K>
+  node_ptr probe_for_insert(const K& key, size_t code) {
+    migrate_buckets(migrate_step_);
+    for (node_ptr cur = bucket_at(code); cur; cur = cur->next)
+      if (node_matches(cur, code, key))
+        return cur;
+    return nullptr;
+  }
+
+  // 插入的第二步：key确定不存在，必要时先扩容，再把结点挂到桶头（头插法）
+  iterator link_new_node(node_ptr node, size_t code) {
+    if constexpr (CacheHash)
+      node->hash = code;
+    grow_if_needed(size_ + 1);
+    size_type bucket = bucket_pos(code);
+    node_ptr& head = bucket_at_pos(bucket);
+    node->next = head;
+    head = node;
+    sync_occupied(bucket);
+    ++size_;
+    return iterator(node, this);
+  }
+
+  template <typename Fn>
+  void for_each_node(Fn fn) const {
+    for (node_ptr cur : buckets_)
+      for (; cur; cur = cur->next)
+        fn(cur);
+    for (size_type i = migrate_pos_; i < old_buckets_.size(); ++i)
+      for (node_ptr cur = old_buckets_[i]; cur; cur = cur->next)
+        fn(cur);
+  }
+
+  // 插入后元素个数为n时检查负载因子，超过时桶数翻倍
+  void grow_if_needed(size_type n) {
+    if ((float)n / bucket_size_ <= mlf_)
+      return;
+    size_type count = Policy::bucket_count(bucket_size_ * 2);
+    if (!incremental_) {
+      rehash(count);
+      return;
+    }
+    // NOTE: migrate_step_保证上一轮在这之前已经搬完，这里只是兜底，正常不会搬迁任何桶
+    finish_migration();
+    TINY_STL_TRACE_SCOPE("hashtable::rehash", count);
+    // 新表是calloc来的零页，这里不清零也不碰旧结点，整次扩容和桶数无关
+    table_type buckets(count);
+    bitmap_type occupied(bitmap_words(count));
+    old_buckets_.swap(buckets_);
+    old_occupied_.swap(occupied_);
+    buckets_.swap(buckets);
+    occupied_.swap(occupied);
+    bucket_size_ = count;
+    migrate_pos_ = 0;
+    // 到下一次扩容之前至少还有budget次插入，每次插入都会推进搬迁
+    size_type next_grow = (size_type)(count * mlf_);
+    size_type budget = next_grow > n ? next_grow - n : 1;
+    migrate_step_ = std::max(rehash_step, old_buckets_.size() / budget + 1);
+  }
+
+  // 把旧表中最多count个桶搬到新表，全部搬完后释放旧表
+  void migrate_buckets(size_type count) {
+    if (old_buckets_.empty())
+      return;
+    size_type last = std::min(migrate_pos_ + count, old_buckets_.size());
+    for (; migrate_pos_ < last; ++migrate_pos_) {
+      node_ptr cur = old_buckets_[migrate_pos_];
+      while (cur) {
+        node_ptr next = cur->next;
+        size_type index = bucket_index(node_hash(cur), bucket_size_);
+        cur->next = buckets_[index];
+        buckets_[index] = cur;
+        occupied_[index / 64] |= 1ull << (index % 64);
+        cur = next;
+      }
+    }
+    if (migrate_pos_ == old_buckets_.size()) {
+      table_type().swap(old_buckets_);
+      bitmap_type().swap(old_occupied_);
+      migrate_pos_ = 0;
+      return;
+    }
+    // NOTE: next_occupied还会读migrate_pos_所在的那个位图字
+    old_buckets_.release_before(migrate_pos_);
+    old_occupied_.release_before(migrate_pos_ / 64);
+  }
+
+  void finish_migration() { migrate_buckets(old_buckets_.size()); }
+
   template<typename... Args>
   node_ptr create_node(Args&&... args) { // 由参数构造节点，next指针为nullptr
+    TINY_STL_TRACE_SCOPE("hashtable::node_allocate", size_);
     node_ptr node = node_alloc_.allocate(1);
     data_alloc_.construct(std::addressof(node->val), std::forward<Args>(args)...);
     node->next = nullptr; // NOTE: 必须步骤，否则会出现未定义行为
@@ -232,37 +808,22 @@ private:
     data_alloc_.destroy(std::addressof(node->val));
     node_alloc_.deallocate(node, 1);
   }
-
-  std::pair<iterator, bool>
-  insert_node_unique(node_ptr node) { // 将结点插入到桶中，如果桶中已经有相同的结点，则不插入，返回false
-    size_type index = hash(value_traits::get_key(node->val));
-    node_ptr cur = buckets_[index];
-    if (cur == nullptr) {
-      buckets_[index] = node;
-      ++size_;
-      return std::make_pair(iterator(node, this), true);
-    }
-
-    for (; cur; cur = cur->next)
-      if (equal_(value_traits::get_key(cur->val), value_traits::get_key(node->val)))
-        return std::make_pair(iterator(cur, this), false);
-
-    node->next = buckets_[index]; // NOTE: 头插法
-    buckets_[index] = node;
-    ++size_;
-    return std::make_pair(iterator(node, this), true);
-  }
 };
 
 template <typename Key, typename Tp, typename Hash = std::hash<Key>,
           typename Pred = std::equal_to<Key>,
-          typename Alloc = std::allocator<std::pair<const Key, Tp>>>
+          typename Alloc = std::allocator<std::pair<const Key, Tp>>,
+          typename Policy = hashtable_fibonacci_policy,
+          bool CacheHash = hashtable_cache_hash<Key, Hash>::value>
 class unordered_map {
 
 private:
-  using hashtable = _hashtable<Key, std::pair<Key, Tp>, Hash, Pred, Alloc>;
+  using hashtable = _hashtable<Key, std::pair<Key, Tp>, Hash, Pred, Alloc, Policy, CacheHash>;
   hashtable ht_;
 
+  template <typename H>
+  using enable_if_transparent = typename hashtable::template enable_if_transparent<H>;
+
 public:
   using key_type = typename hashtable::key_type;
   using value_type = typename hashtable::value_type;
@@ -270,6 +831,8 @@ public:
   using hasher = typename hashtable::hasher;
   using key_equal = typename hashtable::key_equal;
   using allocator_type = typename hashtable::allocator_type;
+  using bucket_policy = typename hashtable::bucket_policy;
+  static constexpr bool cache_hash = hashtable::cache_hash;
 
   using pointer = typename hashtable::pointer;
   using const_pointer = typename hashtable::const_pointer;
@@ -284,21 +847,22 @@ public:
   unordered_map(): ht_(100) {}
 
   mapped_type& operator[](const key_type& key) {
-    iterator it = ht_.find(key);
-    if (it == ht_.end()) 
-      return ht_.emplace_unique(key, mapped_type()).first;
-    return it->second;
+    return ht_.try_emplace_unique(key).first->second;
   }
 
   mapped_type& operator[](key_type&& key) {
+    return ht_.try_emplace_unique(std::move(key)).first->second;
+  }
+
+  mapped_type& at(const key_type& key) {
     iterator it = ht_.find(key);
     if (it == ht_.end())
-      it = ht_.emplace_unique(std::move(key), mapped_type()).first;
+      throw std::out_of_range("unordered_map::at");
     return it->second;
   }
 
-  mapped_type& at(const key_type& key) {
-    iterator it = ht_.find(key);
+  const mapped_type& at(const key_type& key) const {
+    const_iterator it = ht_.find(key);
     if (it == ht_.end())
       throw std::out_of_range("unordered_map::at");
     return it->second;
@@ -311,19 +875,54 @@ public:
     return it->second;
   }
 
+  template <typename K, typename H = Hash, typename = enable_if_transparent<H>>
+  mapped_type& at(const K& key) {
+    iterator it = ht_.find(key);
+    if (it == ht_.end())
+      throw std::out_of_range("unordered_map::at");
+    return it->second;
+  }
+
   iterator find(const key_type& key) {
     return ht_.find(key);
   }
 
+  const_iterator find(const key_type& key) const {
+    return ht_.find(key);
+  }
+
+  template <typename K, typename H = Hash, typename = enable_if_transparent<H>>
+  iterator find(const K& key) {
+    return ht_.find(key);
+  }
+
+  template <typename K, typename H = Hash, typename = enable_if_transparent<H>>
+  const_iterator find(const K& key) const {
+    return ht_.find(key);
+  }
+
   bool empty() const { return ht_.empty(); }
   size_type size() const { return ht_.size(); }
 
   iterator begin() { return ht_.begin(); }
   iterator end() { return ht_.end(); }
-  // const_iterator begin() const { return ht_.begin(); }
-  // const_iterator end() const { return ht_.end(); }
+  const_iterator begin() const { return ht_.begin(); }
+  const_iterator end() const { return ht_.end(); }
+  const_iterator cbegin() const { return ht_.begin(); }
+  const_iterator cend() const { return ht_.end(); }
 
   void clear() { ht_.clear(); }
+
+  size_type bucket_count() const { return ht_.bucket_count(); }
+  float load_factor() const { return ht_.load_factor(); }
+  float max_load_factor() const { return ht_.max_load_factor(); }
+  void max_load_factor(float mlf) { ht_.max_load_factor(mlf); }
+  void rehash(size_type count) { ht_.rehash(count); }
+  void reserve(size_type count) { ht_.reserve(count); }
+
+  // 渐进式rehash：单次插入不会触发O(n)的搬迁，代价是rehash期间查找要先判断在哪张表
+  void set_incremental_rehash(bool on) { ht_.set_incremental_rehash(on); }
+  bool incremental_rehash() const { return ht_.incremental_rehash(); }
   
   template<typename... Args>
   std::pair<iterator, bool>
@@ -331,6 +930,37 @@ public:
     return ht_.emplace_unique(std::forward<Args>(args)...);
   }
 
+  // key已存在时不构造value，args也不会被移走
+  template<typename... Args>
+  std::pair<iterator, bool>
+  try_emplace(const key_type& key, Args&&... args) {
+    return ht_.try_emplace_unique(key, std::forward<Args>(args)...);
+  }
+
+  template<typename... Args>
+  std::pair<iterator, bool>
+  try_emplace(key_type&& key, Args&&... args) {
+    return ht_.try_emplace_unique(std::move(key), std::forward<Args>(args)...);
+  }
+
+  template<typename M>
+  std::pair<iterator, bool>
+  insert_or_assign(const key_type& key, M&& obj) {
+    auto result = ht_.try_emplace_unique(key, std::forward<M>(obj));
+    if (!result.second)
+      result.first->second = std::forward<M>(obj);
+    return result;
+  }
+
+  template<typename M>
+  std::pair<iterator, bool>
+  insert_or_assign(key_type&& key, M&& obj) {
+    auto result = ht_.try_emplace_unique(std::move(key), std::forward<M>(obj));
+    if (!result.second)
+      result.first->second = std::forward<M>(obj);
+    return result;
+  }
+
   std::pair<iterator, bool>
   insert(const std::pair<Key, Tp>& value) {
     return ht_.emplace_unique(value);
@@ -341,16 +971,37 @@ public:
     return ht_.emplace_unique(std::move(value));
   }
 
-  void erase(iterator pos) {
-    ht_.erase(pos);
+  iterator erase(iterator pos) {
+    return ht_.erase(pos);
   }
 
   size_type erase(const key_type& key) {
     return ht_.erase(key);
   }
 
+  template <typename K, typename H = Hash, typename = enable_if_transparent<H>>
+  size_type erase(const K& key) {
+    return ht_.erase(key);
+  }
+
   size_type count(const key_type& key) const {
     return ht_.count(key);
   }
+
+  template <typename K, typename H = Hash, typename = enable_if_transparent<H>>
+  size_type count(const K& key) const {
+    return ht_.count(key);
+  }
+
+  // 批量查找：keys是任意能遍历的key序列，结果按顺序写到out，适合一次查几十上百个key
+  template <typename Keys, typename OutputIt>
+  OutputIt find_many(const Keys& keys, OutputIt out) {
+    return ht_.find_many(keys, out);
+  }
+
+  template <typename Keys, typename OutputIt>
+  OutputIt contains_many(const Keys& keys, OutputIt out) const {
+    return ht_.contains_many(keys, out);
+  }
 };
 } // namespace tiny_stl
\ No newline at end of file
@@ -0,0 +1,421 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace tiny_stl {
+
+namespace impl {
+
+// NOTE: 默认让一个结点的数据部分大约占8个cache line
+template <typename T>
+constexpr size_t unrolled_default_capacity() {
+  return sizeof(T) * 4 >= 512 ? 4 : 512 / sizeof(T);
+}
+
+}  // namespace impl
+
+struct unrolled_list_node_base {
+  unrolled_list_node_base* prev;
+  unrolled_list_node_base* next;
+  size_t count;  // 哨兵结点的count始终为0
+};
+
+template <typename T, size_t N>
+struct unrolled_list_node : unrolled_list_node_base {
+  using storage_type = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+  storage_type storage[N];
+
+  T* data() { return reinterpret_cast<T*>(storage); }
+};
+
+template <typename T, size_t N, bool IsConst>
+struct unrolled_list_iterator {
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = T;
+  using reference = typename std::conditional<IsConst, const T&, T&>::type;
+  using pointer = typename std::conditional<IsConst, const T*, T*>::type;
+  using difference_type = std::ptrdiff_t;
+
+  using self = unrolled_list_iterator<T, N, IsConst>;
+  using base_ptr = unrolled_list_node_base*;
+  using node_ptr = unrolled_list_node<T, N>*;
+
+  base_ptr node_;
+  size_t index_;
+
+  unrolled_list_iterator() = delete;
+  unrolled_list_iterator(base_ptr node, size_t index) : node_(node), index_(index) {}
+
+  template <bool C = IsConst, typename = typename std::enable_if<C>::type>
+  unrolled_list_iterator(const unrolled_list_iterator<T, N, false>& other)
+      : node_(other.node_), index_(other.index_) {}
+
+  // NOTE: 同一个结点内只是下标加一，跨结点时才需要追指针
+  self& operator++() {
+    if (++index_ == node_->count) {
+      node_ = node_->next;
+      index_ = 0;
+    }
+    return *this;
+  }
+
+  self operator++(int) {
+    self tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  self& operator--() {
+    if (index_ == 0) {
+      node_ = node_->prev;
+      index_ = node_->count;
+    }
+    --index_;
+    return *this;
+  }
+
+  self operator--(int) {
+    self tmp = *this;
+    --(*this);
+    return tmp;
+  }
+
+  reference operator*() const { return static_cast<node_ptr>(node_)->data()[index_]; }
+
+  pointer operator->() const { return &(operator*()); }
+
+  bool operator==(const self& other) const {
+    return node_ == other.node_ && index_ == other.index_;
+  }
+
+  bool operator!=(const self& other) const { return !(*this == other); }
+};
+
+// 每个结点存放最多N个元素的双向链表
+// 顺序遍历时大部分步进只是结点内下标加一，cache miss约为list的1/N。
+// 插入满结点时把后一半搬到新结点（split）；删除后结点不足半满时尝试与相邻结点合并（merge）。
+// NOTE: 与list不同，插入和删除会使同一结点内的迭代器失效
+template <typename T, size_t N = impl::unrolled_default_capacity<T>(),
+          typename Alloc = std::allocator<T>>
+class unrolled_list {
+  static_assert(N >= 2, "unrolled_list needs at least two elements per node");
+
+ private:
+  using base = unrolled_list_node_base;
+  using base_ptr = base*;
+  using node = unrolled_list_node<T, N>;
+  using node_ptr = node*;
+  using node_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+  using base_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<base>;
+
+ public:
+  using value_type = T;
+  using iterator = unrolled_list_iterator<T, N, false>;
+  using const_iterator = unrolled_list_iterator<T, N, true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using allocator_type = Alloc;
+
+  static constexpr size_type node_capacity = N;
+
+ private:
+  base_ptr sentinel_;
+  size_type size_;
+  node_alloc_type allocator_;
+
+ public:
+  unrolled_list() { init_sentinel(); }
+
+  unrolled_list(std::initializer_list<value_type> value_list) {
+    init_sentinel();
+    for (const auto& value : value_list)
+      push_back(value);
+  }
+
+  unrolled_list(const unrolled_list& other) {
+    init_sentinel();
+    for (const auto& value : other)
+      push_back(value);
+  }
+
+  unrolled_list(unrolled_list&& other) {
+    init_sentinel();
+    swap(other);
+  }
+
+  ~unrolled_list() {
+    clear();
+    deinit_sentinel();
+  }
+
+  unrolled_list& operator=(const unrolled_list& other) {
+    if (this == &other)
+      return *this;
+    clear();
+    for (const auto& value : other)
+      push_back(value);
+    return *this;
+  }
+
+  unrolled_list& operator=(unrolled_list&& other) {
+    if (this == &other)
+      return *this;
+    swap(other);
+    other.clear();
+    return *this;
+  }
+
+  iterator begin() { return iterator(sentinel_->next, 0); }
+  iterator end() { return iterator(sentinel_, 0); }
+  const_iterator begin() const { return const_iterator(sentinel_->next, 0); }
+  const_iterator end() const { return const_iterator(sentinel_, 0); }
+
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+  const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+
+  reference front() { return *begin(); }
+  const_reference front() const { return *begin(); }
+  reference back() { return *(--end()); }
+  const_reference back() const { return *(--end()); }
+
+  void clear() {
+    base_ptr cur = sentinel_->next;
+    while (cur != sentinel_) {
+      base_ptr next = cur->next;
+      destroy_node(static_cast<node_ptr>(cur));
+      cur = next;
+    }
+    sentinel_->next = sentinel_;
+    sentinel_->prev = sentinel_;
+    size_ = 0;
+  }
+
+  void swap(unrolled_list& other) {
+    if (this == &other) return;
+    std::swap(sentinel_, other.sentinel_);
+    std::swap(size_, other.size_);
+    std::swap(allocator_, other.allocator_);
+  }
+
+  template <typename... Args>
+  iterator emplace(iterator pos, Args&&... args) {
+    base_ptr target = pos.node_;
+    size_type index = pos.index_;
+
+    // 在结点边界插入时优先追加到前一个结点的尾部，这样push_back不会移动任何元素
+    if (index == 0 && target->prev != sentinel_ && target->prev->count < N) {
+      target = target->prev;
+      index = target->count;
+    } else if (target == sentinel_) {
+      target = new_node_before(sentinel_);
+      index = 0;
+    } else if (target->count == N) {
+      base_ptr upper = split_node(target, N / 2);
+      if (index > N / 2) {
+        index -= N / 2;
+        target = upper;
+      }
+    }
+
+    insert_in_node(static_cast<node_ptr>(target), index, std::forward<Args>(args)...);
+    ++size_;
+    return iterator(target, index);
+  }
+
+  iterator insert(iterator pos, const_reference value) { return emplace(pos, value); }
+  iterator insert(iterator pos, value_type&& value) { return emplace(pos, std::move(value)); }
+
+  template <typename... Args>
+  void emplace_back(Args&&... args) { emplace(end(), std::forward<Args>(args)...); }
+
+  template <typename... Args>
+  void emplace_front(Args&&... args) {
+    // NOTE: 头结点满了就在前面开新结点，避免每次push_front都搬动一半元素
+    if (sentinel_->next == sentinel_ || sentinel_->next->count == N) {
+      base_ptr first = new_node_before(sentinel_->next);
+      insert_in_node(static_cast<node_ptr>(first), 0, std::forward<Args>(args)...);
+      ++size_;
+      return;
+    }
+    emplace(begin(), std::forward<Args>(args)...);
+  }
+
+  void push_back(const_reference value) { emplace_back(value); }
+  void push_back(value_type&& value) { emplace_back(std::move(value)); }
+  void push_front(const_reference value) { emplace_front(value); }
+  void push_front(value_type&& value) { emplace_front(std::move(value)); }
+
+  iterator erase(iterator pos) {
+    if (pos == end())
+      return pos;
+    base_ptr target = pos.node_;
+    size_type index = pos.index_;
+    erase_in_node(static_cast<node_ptr>(target), index);
+    --size_;
+
+    if (target->count == 0) {
+      base_ptr next = target->next;
+      unlink_node(target);
+      deallocate_node(static_cast<node_ptr>(target));
+      return iterator(next, 0);
+    }
+
+    // 不足半满时优先并入前驱，其次吸收后继
+    if (target->count <= N / 2) {
+      base_ptr prev = target->prev;
+      base_ptr next = target->next;
+      if (prev != sentinel_ && prev->count + target->count <= N) {
+        index += prev->count;
+        merge_next(prev);
+        target = prev;
+      } else if (next != sentinel_ && target->count + next->count <= N) {
+        merge_next(target);
+      }
+    }
+    if (index < target->count)
+      return iterator(target, index);
+    return iterator(target->next, 0);
+  }
+
+  void pop_front() {
+    if (!empty()) erase(begin());
+  }
+
+  void pop_back() {
+    if (!empty()) erase(--end());
+  }
+
+  // 把other整体接到pos之前：只需要重新链接结点，pos在结点中间时先把该结点拆成两个
+  void splice(iterator pos, unrolled_list& other) {
+    if (this == &other || other.empty())
+      return;
+    base_ptr target = pos.node_;
+    if (pos.index_ != 0)
+      target = split_node(target, pos.index_);
+
+    base_ptr first = other.sentinel_->next;
+    base_ptr last = other.sentinel_->prev;
+    other.sentinel_->next = other.sentinel_;
+    other.sentinel_->prev = other.sentinel_;
+
+    base_ptr target_prev = target->prev;
+    target_prev->next = first;
+    first->prev = target_prev;
+    last->next = target;
+    target->prev = last;
+
+    size_ += other.size_;
+    other.size_ = 0;
+  }
+
+  void splice(iterator pos, unrolled_list&& other) { splice(pos, other); }
+
+  // 结点数，主要用于测试和观察填充率
+  size_type node_count() const {
+    size_type res = 0;
+    for (base_ptr cur = sentinel_->next; cur != sentinel_; cur = cur->next)
+      ++res;
+    return res;
+  }
+
+ private:
+  void init_sentinel() {
+    base_alloc_type base_alloc(allocator_);
+    sentinel_ = base_alloc.allocate(1);
+    sentinel_->next = sentinel_;
+    sentinel_->prev = sentinel_;
+    sentinel_->count = 0;
+    size_ = 0;
+  }
+
+  void deinit_sentinel() {
+    base_alloc_type base_alloc(allocator_);
+    base_alloc.deallocate(sentinel_, 1);
+  }
+
+  base_ptr new_node_before(base_ptr pos) {
+    node_ptr n = allocator_.allocate(1);
+    n->count = 0;
+    base_ptr pos_prev = pos->prev;
+    pos_prev->next = n;
+    n->prev = pos_prev;
+    n->next = pos;
+    pos->prev = n;
+    return n;
+  }
+
+  void unlink_node(base_ptr n) {
+    n->prev->next = n->next;
+    n->next->prev = n->prev;
+  }
+
+  void deallocate_node(node_ptr n) { allocator_.deallocate(n, 1); }
+
+  void destroy_node(node_ptr n) {
+    std::destroy(n->data(), n->data() + n->count);
+    deallocate_node(n);
+  }
+
+  template <typename... Args>
+  void insert_in_node(node_ptr n, size_type index, Args&&... args) {
+    assert(n->count < N && index <= n->count);
+    T* data = n->data();
+    if (index == n->count) {
+      ::new (static_cast<void*>(data + index)) T(std::forward<Args>(args)...);
+    } else {
+      T value(std::forward<Args>(args)...);  // NOTE: 先构造，args可能引用本结点中的元素
+      ::new (static_cast<void*>(data + n->count)) T(std::move(data[n->count - 1]));
+      std::move_backward(data + index, data + n->count - 1, data + n->count);
+      data[index] = std::move(value);
+    }
+    ++n->count;
+  }
+
+  void erase_in_node(node_ptr n, size_type index) {
+    T* data = n->data();
+    std::move(data + index + 1, data + n->count, data + index);
+    --n->count;
+    data[n->count].~T();
+  }
+
+  // 把n中[index, count)的元素搬到紧跟在n后面的新结点中，返回新结点
+  base_ptr split_node(base_ptr b, size_type index) {
+    node_ptr n = static_cast<node_ptr>(b);
+    node_ptr upper = static_cast<node_ptr>(new_node_before(n->next));
+    std::uninitialized_move(n->data() + index, n->data() + n->count, upper->data());
+    std::destroy(n->data() + index, n->data() + n->count);
+    upper->count = n->count - index;
+    n->count = index;
+    return upper;
+  }
+
+  void merge_next(base_ptr b) {
+    node_ptr n = static_cast<node_ptr>(b);
+    node_ptr next = static_cast<node_ptr>(b->next);
+    std::uninitialized_move(next->data(), next->data() + next->count, n->data() + n->count);
+    std::destroy(next->data(), next->data() + next->count);
+    n->count += next->count;
+    next->count = 0;
+    unlink_node(next);
+    deallocate_node(next);
+  }
+};
+
+}  // namespace tiny_stl
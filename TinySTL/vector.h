@@ -5,7 +5,9 @@
 #include <iostream>
 
 #include "allocator.h"
+#include "bit_vector.h"
 #include "memory.h"
+#include "trace.h"
 
 namespace tiny_stl {
 
@@ -102,7 +104,6 @@ class vector {
       size_t dis = pos - begin();
       expand();
       pos = begin() + dis; // NOTE: 这里的pos需要变一下，因为扩容后，数据存放的位置变了
-      std::cout << "expand" << std::endl;
     }
     if (pos != end()) {
       alloc_traits::construct(allocator_,end()); // NOTE: 这里是end()，而不是end() + 1 😂
@@ -189,6 +190,7 @@ class vector {
  private:
 
   void reallocate(size_t new_capacity) {
+    TINY_STL_TRACE_SCOPE("vector::relocate", size_);
     iterator new_data = allocator_.allocate(new_capacity);
     std::uninitialized_move(begin(), end(), new_data);
     // alloc_traits::destroy(begin(), end()); // NOTE: 优化: uninitialized_copy + destroy -> uninitialized_move
@@ -198,6 +200,7 @@ class vector {
   }
 
   void expand() {
+    TINY_STL_TRACE_SCOPE("vector::grow", capacity_);
     if (capacity_ == 0) {
       capacity_ = 1;
       data_ = allocator_.allocate(capacity_);
@@ -208,4 +211,14 @@ class vector {
   }
 };
 
+// NOTE: 和std一样，vector<bool>按位存储，元素通过bit_reference代理访问
+template <typename Alloc>
+class vector<bool, Alloc>
+    : public bit_vector<typename Alloc::template rebind<impl::bit_word>::other> {
+  using base = bit_vector<typename Alloc::template rebind<impl::bit_word>::other>;
+
+ public:
+  using base::base;
+};
+
 }  // namespace tiny_stl
\ No newline at end of file